@@ -0,0 +1,490 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <stdatomic.h>
+#include "defs.h"
+#include "logseg.h"
+
+/*
+    analyzeLogs: summarize the log_<id>.csv files written by a run.
+
+    Every log segment is mapped read-only (compressed ones are decompressed into a buffer) and parsed
+    in place; fields are (pointer, length) slices of the segment, so no memory is allocated per row.
+    Worker threads take whole entity logs from a shared counter and keep their own room and entity
+    tables, which are merged once all logs are done.
+*/
+
+#define ANALYZE_MAX_THREADS 64
+#define LATENCY_BUCKETS 24   // bucket 0 is 0 ms, bucket b covers [2^(b-1), 2^b) ms
+#define ROOM_SLOTS 512       // open addressing table for room names, > 2 * MAX_ROOMS
+
+enum Action {
+    ACT_INIT = 0,
+    ACT_MOVE,
+    ACT_EVIDENCE,
+    ACT_SWAP,
+    ACT_EXIT,
+    ACT_RETURN_START,
+    ACT_RETURN_COMPLETE,
+    ACT_IDLE,
+    ACT_OTHER,
+    ACT_COUNT
+};
+
+static const char* actionNames[ACT_COUNT] = {
+    "INIT", "MOVE", "EVIDENCE", "SWAP", "EXIT", "RETURN_START", "RETURN_COMPLETE", "IDLE", "?"
+};
+
+// A slice of the mapped file
+struct Field {
+    const char* text;
+    int length;
+};
+
+struct RoomCounts {
+    char name[MAX_ROOM_NAME];
+    uint64_t hunterEnter;
+    uint64_t hunterEvidence;
+    uint64_t ghostEnter;
+    uint64_t ghostEvidence;
+    uint64_t ghostIdle;
+};
+
+struct RoomTable {
+    struct RoomCounts rooms[MAX_ROOMS];
+    int count;
+    int16_t slots[ROOM_SLOTS]; // index into rooms, -1 = empty
+};
+
+struct EntityStats {
+    bool ghost;
+    int id;
+    uint64_t actions[ACT_COUNT];
+    long long firstStamp;
+    long long firstEvidence;   // -1 until the first EVIDENCE row
+    long long lastMove;        // -1 until the first MOVE row
+    long long returnStart;     // -1 unless a return is in progress
+    long long returnMs;
+    int returns;
+};
+
+struct Worker {
+    pthread_t thread;
+    struct RoomTable rooms;
+    struct EntityStats* entities;
+    int entityCount;
+    int entityCapacity;
+    uint64_t latency[LATENCY_BUCKETS];
+    long long latencyMax;
+    uint64_t lines;
+    uint64_t bytes;
+    uint64_t badLines;
+};
+
+// Entity logs shared by all workers
+static const char* logDir;
+static int* logIds;
+static int logCount;
+static atomic_int nextLog;
+
+static void room_table_init(struct RoomTable* table) {
+    table->count = 0;
+    memset(table->slots, -1, sizeof(table->slots));
+}
+
+static uint32_t hash_field(struct Field field) {
+    uint32_t hash = 2166136261u; // FNV-1a
+    for (int i = 0; i < field.length; i++) {
+        hash = (hash ^ (uint8_t)field.text[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Find or add a room by name; NULL for an empty name or a full table
+static struct RoomCounts* room_lookup(struct RoomTable* table, struct Field name) {
+    if (name.length == 0) return NULL;
+    if (name.length >= MAX_ROOM_NAME) name.length = MAX_ROOM_NAME - 1;
+
+    uint32_t slot = hash_field(name) % ROOM_SLOTS;
+    while (table->slots[slot] >= 0) {
+        struct RoomCounts* room = &table->rooms[table->slots[slot]];
+        if (strncmp(room->name, name.text, (size_t)name.length) == 0 && room->name[name.length] == '\0') return room;
+        slot = (slot + 1) % ROOM_SLOTS;
+    }
+    if (table->count == MAX_ROOMS) return NULL;
+
+    struct RoomCounts* room = &table->rooms[table->count];
+    memset(room, 0, sizeof(*room));
+    memcpy(room->name, name.text, (size_t)name.length);
+    table->slots[slot] = (int16_t)table->count++;
+    return room;
+}
+
+static struct EntityStats* entity_lookup(struct Worker* worker, int first, bool ghost, int id) {
+    for (int i = first; i < worker->entityCount; i++) {
+        if (worker->entities[i].ghost == ghost && worker->entities[i].id == id) return &worker->entities[i];
+    }
+
+    if (worker->entityCount == worker->entityCapacity) {
+        int capacity = worker->entityCapacity ? worker->entityCapacity * 2 : 64;
+        struct EntityStats* grown = realloc(worker->entities, (size_t)capacity * sizeof(*grown));
+        if (grown == NULL) return NULL;
+        worker->entities = grown;
+        worker->entityCapacity = capacity;
+    }
+
+    struct EntityStats* entity = &worker->entities[worker->entityCount++];
+    memset(entity, 0, sizeof(*entity));
+    entity->ghost = ghost;
+    entity->id = id;
+    entity->firstStamp = -1;
+    entity->firstEvidence = -1;
+    entity->lastMove = -1;
+    entity->returnStart = -1;
+    return entity;
+}
+
+static bool field_equals(struct Field field, const char* text) {
+    size_t length = strlen(text);
+    return (size_t)field.length == length && memcmp(field.text, text, length) == 0;
+}
+
+static bool field_to_number(struct Field field, long long* value) {
+    if (field.length == 0) return false;
+    long long n = 0;
+    for (int i = 0; i < field.length; i++) {
+        if (field.text[i] < '0' || field.text[i] > '9') return false;
+        n = n * 10 + (field.text[i] - '0');
+    }
+    *value = n;
+    return true;
+}
+
+static enum Action action_from_field(struct Field field) {
+    for (int a = 0; a < ACT_OTHER; a++) {
+        if (field_equals(field, actionNames[a])) return (enum Action)a;
+    }
+    return ACT_OTHER;
+}
+
+static int latency_bucket(long long ms) {
+    int bucket = 0;
+    while (ms > 0 && bucket < LATENCY_BUCKETS - 1) {
+        ms >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+// timestamp,type,id,room,device,boredom,fear,action,extra - extra runs to the end of the line
+static void parse_line(struct Worker* worker, int firstEntity, const char* line, const char* end) {
+    struct Field fields[9];
+    int count = 0;
+    const char* start = line;
+    for (const char* p = line; p < end && count < 8; p++) {
+        if (*p == ',') {
+            fields[count++] = (struct Field){start, (int)(p - start)};
+            start = p + 1;
+        }
+    }
+    if (count < 8) {
+        worker->badLines++;
+        return;
+    }
+    fields[8] = (struct Field){start, (int)(end - start)};
+
+    long long stamp, id;
+    if (!field_to_number(fields[0], &stamp) || !field_to_number(fields[2], &id)) {
+        worker->badLines++;
+        return;
+    }
+
+    bool ghost = field_equals(fields[1], "ghost");
+    struct EntityStats* entity = entity_lookup(worker, firstEntity, ghost, (int)id);
+    if (entity == NULL) return;
+
+    enum Action action = action_from_field(fields[7]);
+    entity->actions[action]++;
+    if (entity->firstStamp < 0) entity->firstStamp = stamp;
+
+    switch (action) {
+        case ACT_MOVE: {
+            struct RoomCounts* room = room_lookup(&worker->rooms, fields[8]);
+            if (room) {
+                if (ghost) room->ghostEnter++;
+                else room->hunterEnter++;
+            }
+            if (entity->lastMove >= 0) {
+                long long latency = stamp - entity->lastMove;
+                if (latency < 0) latency = 0;
+                worker->latency[latency_bucket(latency)]++;
+                if (latency > worker->latencyMax) worker->latencyMax = latency;
+            }
+            entity->lastMove = stamp;
+            break;
+        }
+        case ACT_EVIDENCE: {
+            struct RoomCounts* room = room_lookup(&worker->rooms, fields[3]);
+            if (room) {
+                if (ghost) room->ghostEvidence++;
+                else room->hunterEvidence++;
+            }
+            if (!ghost && entity->firstEvidence < 0) entity->firstEvidence = stamp;
+            break;
+        }
+        case ACT_IDLE: {
+            struct RoomCounts* room = room_lookup(&worker->rooms, fields[3]);
+            if (room) room->ghostIdle++;
+            break;
+        }
+        case ACT_RETURN_START:
+            entity->returnStart = stamp;
+            break;
+        case ACT_RETURN_COMPLETE:
+            if (entity->returnStart >= 0) {
+                entity->returnMs += stamp - entity->returnStart;
+                entity->returns++;
+                entity->returnStart = -1;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+// One entity's log being parsed segment by segment
+struct LogParse {
+    struct Worker* worker;
+    int firstEntity;
+};
+
+static void parse_segment(void* context, const char* data, size_t length) {
+    struct LogParse* parse = context;
+    struct Worker* worker = parse->worker;
+    const char* end = data + length;
+    const char* line = data;
+    while (line < end) {
+        const char* newline = memchr(line, '\n', (size_t)(end - line));
+        const char* lineEnd = newline ? newline : end;
+        if (lineEnd > line) {
+            parse_line(worker, parse->firstEntity, line, lineEnd);
+            worker->lines++;
+        }
+        line = lineEnd + 1;
+    }
+    worker->bytes += (uint64_t)length;
+}
+
+static void parse_log(struct Worker* worker, int id) {
+    // a log normally holds one entity, so lookups only scan the entities it added
+    struct LogParse parse = { worker, worker->entityCount };
+    segmentForEach(logDir, id, parse_segment, &parse);
+}
+
+static void* workerFunction(void* arg) {
+    struct Worker* worker = arg;
+    int index;
+    while ((index = atomic_fetch_add(&nextLog, 1)) < logCount) {
+        parse_log(worker, logIds[index]);
+    }
+    return NULL;
+}
+
+static int compare_entities(const void* a, const void* b) {
+    const struct EntityStats* left = a;
+    const struct EntityStats* right = b;
+    if (left->ghost != right->ghost) return left->ghost ? 1 : -1;
+    return (left->id > right->id) - (left->id < right->id);
+}
+
+static int compare_long(const void* a, const void* b) {
+    long long left = *(const long long*)a;
+    long long right = *(const long long*)b;
+    return (left > right) - (left < right);
+}
+
+static int compare_rooms(const void* a, const void* b) {
+    const struct RoomCounts* left = a;
+    const struct RoomCounts* right = b;
+    uint64_t l = left->hunterEnter + left->ghostEnter;
+    uint64_t r = right->hunterEnter + right->ghostEnter;
+    return (l < r) - (l > r);
+}
+
+static void print_heatmap(struct RoomTable* rooms) {
+    qsort(rooms->rooms, (size_t)rooms->count, sizeof(rooms->rooms[0]), compare_rooms);
+
+    uint64_t peak = 1;
+    for (int i = 0; i < rooms->count; i++) {
+        uint64_t visits = rooms->rooms[i].hunterEnter + rooms->rooms[i].ghostEnter;
+        if (visits > peak) peak = visits;
+    }
+
+    printf("\nRoom heatmap (entries by hunters and ghost):\n");
+    printf("%-20s %10s %10s %10s %10s %10s  %s\n", "room", "hunter in", "evidence", "ghost in", "haunted", "idle", "");
+    for (int i = 0; i < rooms->count; i++) {
+        const struct RoomCounts* room = &rooms->rooms[i];
+        uint64_t visits = room->hunterEnter + room->ghostEnter;
+        char bar[41];
+        int width = (int)(40 * visits / peak);
+        memset(bar, '#', (size_t)width);
+        bar[width] = '\0';
+        printf("%-20s %10llu %10llu %10llu %10llu %10llu  %s\n", room->name,
+               (unsigned long long)room->hunterEnter, (unsigned long long)room->hunterEvidence,
+               (unsigned long long)room->ghostEnter, (unsigned long long)room->ghostEvidence,
+               (unsigned long long)room->ghostIdle, bar);
+    }
+}
+
+static void print_entities(struct EntityStats* entities, int count) {
+    qsort(entities, (size_t)count, sizeof(entities[0]), compare_entities);
+
+    printf("\nActions per entity:\n");
+    printf("%-7s %8s %8s %9s %6s %7s %6s %6s %13s %13s\n",
+           "entity", "id", "moves", "evidence", "swaps", "returns", "idle", "exit", "1st evid ms", "avg return ms");
+    for (int i = 0; i < count; i++) {
+        const struct EntityStats* e = &entities[i];
+        char firstEvidence[24] = "-";
+        char averageReturn[24] = "-";
+        if (e->firstEvidence >= 0) snprintf(firstEvidence, sizeof(firstEvidence), "%lld", e->firstEvidence - e->firstStamp);
+        if (e->returns > 0) snprintf(averageReturn, sizeof(averageReturn), "%.1f", (double)e->returnMs / e->returns);
+        printf("%-7s %8d %8llu %9llu %6llu %7llu %6llu %6llu %13s %13s\n",
+               e->ghost ? "ghost" : "hunter", e->id,
+               (unsigned long long)e->actions[ACT_MOVE], (unsigned long long)e->actions[ACT_EVIDENCE],
+               (unsigned long long)e->actions[ACT_SWAP], (unsigned long long)e->actions[ACT_RETURN_START],
+               (unsigned long long)e->actions[ACT_IDLE], (unsigned long long)e->actions[ACT_EXIT],
+               firstEvidence, averageReturn);
+    }
+}
+
+static void print_first_evidence(const struct EntityStats* entities, int count) {
+    long long* times = malloc((size_t)(count ? count : 1) * sizeof(*times));
+    int hunters = 0;
+    int found = 0;
+    for (int i = 0; i < count; i++) {
+        if (entities[i].ghost) continue;
+        hunters++;
+        if (entities[i].firstEvidence >= 0) times[found++] = entities[i].firstEvidence - entities[i].firstStamp;
+    }
+    qsort(times, (size_t)found, sizeof(*times), compare_long);
+
+    printf("\nTime to first evidence: %d of %d hunter(s) found evidence\n", found, hunters);
+    if (found > 0) {
+        printf("  min %lld ms, p50 %lld ms, p90 %lld ms, max %lld ms\n",
+               times[0], times[found / 2], times[(found * 9) / 10], times[found - 1]);
+    }
+    free(times);
+}
+
+static void print_latency(const uint64_t* latency, long long max) {
+    uint64_t total = 0;
+    for (int b = 0; b < LATENCY_BUCKETS; b++) total += latency[b];
+
+    printf("\nTime between consecutive moves of one entity (%llu intervals, max %lld ms):\n", (unsigned long long)total, max);
+    if (total == 0) return;
+    for (int b = 0; b < LATENCY_BUCKETS; b++) {
+        if (latency[b] == 0) continue;
+        long long low = b == 0 ? 0 : 1LL << (b - 1);
+        long long high = b == 0 ? 0 : (1LL << b) - 1;
+        char bar[41];
+        int width = (int)(40 * latency[b] / total);
+        memset(bar, '#', (size_t)width);
+        bar[width] = '\0';
+        printf("  %6lld-%-6lld ms %10llu %6.1f%%  %s\n", low, high,
+               (unsigned long long)latency[b], 100.0 * (double)latency[b] / (double)total, bar);
+    }
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [--threads N] [DIR]\n", prog);
+    fprintf(stderr, "Summarizes the log_<id> files and segments in DIR (default: current directory).\n");
+}
+
+int main(int argc, char* argv[]) {
+    const char* dir = ".";
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = strtol(argv[++i], NULL, 10);
+            if (threads <= 0) {
+                usage(argv[0]);
+                return 1;
+            }
+        }
+        else if (argv[i][0] != '-') dir = argv[i];
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    logDir = dir;
+    logCount = segmentListEntities(dir, &logIds);
+    if (logCount < 0) return 1;
+    if (logCount == 0) {
+        fprintf(stderr, "No log_*.csv files in %s\n", dir);
+        return 1;
+    }
+    if (threads > ANALYZE_MAX_THREADS) threads = ANALYZE_MAX_THREADS;
+    if (threads > logCount) threads = logCount;
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    struct Worker* workers = calloc((size_t)threads, sizeof(*workers));
+    for (int t = 0; t < threads; t++) {
+        room_table_init(&workers[t].rooms);
+        pthread_create(&workers[t].thread, NULL, workerFunction, &workers[t]);
+    }
+    for (int t = 0; t < threads; t++) {
+        pthread_join(workers[t].thread, NULL);
+    }
+
+    // merge into worker 0
+    struct Worker* total = &workers[0];
+    for (int t = 1; t < threads; t++) {
+        struct Worker* worker = &workers[t];
+        for (int i = 0; i < worker->rooms.count; i++) {
+            const struct RoomCounts* from = &worker->rooms.rooms[i];
+            struct RoomCounts* to = room_lookup(&total->rooms, (struct Field){from->name, (int)strlen(from->name)});
+            if (to == NULL) continue;
+            to->hunterEnter += from->hunterEnter;
+            to->hunterEvidence += from->hunterEvidence;
+            to->ghostEnter += from->ghostEnter;
+            to->ghostEvidence += from->ghostEvidence;
+            to->ghostIdle += from->ghostIdle;
+        }
+        for (int i = 0; i < worker->entityCount; i++) {
+            struct EntityStats* to = entity_lookup(total, 0, worker->entities[i].ghost, worker->entities[i].id);
+            if (to) *to = worker->entities[i];
+        }
+        for (int b = 0; b < LATENCY_BUCKETS; b++) total->latency[b] += worker->latency[b];
+        if (worker->latencyMax > total->latencyMax) total->latencyMax = worker->latencyMax;
+        total->lines += worker->lines;
+        total->bytes += worker->bytes;
+        total->badLines += worker->badLines;
+        free(worker->entities);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double ms = (double)(end.tv_sec - start.tv_sec) * 1000.0 + (double)(end.tv_nsec - start.tv_nsec) / 1e6;
+
+    printf("Parsed %llu line(s) from %d log(s), %.1f KiB in %.2f ms with %ld thread(s)",
+           (unsigned long long)total->lines, logCount, (double)total->bytes / 1024.0, ms, threads);
+    if (total->badLines) printf(", %llu malformed", (unsigned long long)total->badLines);
+    printf("\n");
+
+    print_heatmap(&total->rooms);
+    print_entities(total->entities, total->entityCount);
+    print_first_evidence(total->entities, total->entityCount);
+    print_latency(total->latency, total->latencyMax);
+
+    free(total->entities);
+    free(workers);
+    free(logIds);
+    return 0;
+}
@@ -5,6 +5,7 @@
 #include <semaphore.h>
 #include <pthread.h>
 #include <string.h>
+#include <stdint.h>
 
 /*
     You are free to rename all of the types and functions defined here.
@@ -14,12 +15,14 @@
 
 #define MAX_ROOM_NAME 64
 #define MAX_HUNTER_NAME 64
-#define MAX_ROOMS 24
-#define MAX_ROOM_OCCUPANCY 8
+#define MAX_ROOMS 250 // RoomId is a byte and ROOM_NONE takes the last value
+#define MAX_ROOM_OCCUPANCY 8 // default House.maxOccupancy
 #define MAX_CONNECTIONS 8
-#define ENTITY_BOREDOM_MAX 15
-#define HUNTER_FEAR_MAX 15
+#define ENTITY_BOREDOM_MAX 15 // default House.boredomMax
+#define HUNTER_FEAR_MAX 15 // default House.fearMax
 #define DEFAULT_GHOST_ID 68057
+#define DEFAULT_TICK_USEC (100 * 1000) // one entity action per 100 ms of real time
+#define TIME_SCALE_MIN 1e-6 // slowest allowed time scale; keeps the scaled pauses within range
 
 typedef unsigned char EvidenceByte; // Just giving a helpful name to unsigned char for evidence bitmasks
 
@@ -29,105 +32,264 @@ enum LogReason {
     LR_AFRAID = 2
 };
 
+/*
+    Ghost and evidence domain, declared once. Every enum, name and lookup table below and in helpers.c
+    is generated from these two lists, so a ghost is added by adding one line.
+
+    EVIDENCE_TABLE: X(NAME, bit, text)
+    GHOST_TABLE:    X(NAME, text, evidence, evidence, evidence)
+*/
+#define EVIDENCE_TABLE(X) \
+    X(EMF,          0, "emf")      \
+    X(ORBS,         1, "orbs")     \
+    X(RADIO,        2, "radio")    \
+    X(TEMPERATURE,  3, "temp")     \
+    X(FINGERPRINTS, 4, "prints")   \
+    X(WRITING,      5, "writing")  \
+    X(INFRARED,     6, "infrared")
+
+#define GHOST_TABLE(X) \
+    X(POLTERGEIST, "poltergeist", FINGERPRINTS, TEMPERATURE, WRITING)  \
+    X(THE_MIMIC,   "the_mimic",   FINGERPRINTS, TEMPERATURE, RADIO)    \
+    X(HANTU,       "hantu",       FINGERPRINTS, TEMPERATURE, ORBS)     \
+    X(JINN,        "jinn",        FINGERPRINTS, TEMPERATURE, EMF)      \
+    X(PHANTOM,     "phantom",     FINGERPRINTS, INFRARED,    RADIO)    \
+    X(BANSHEE,     "banshee",     FINGERPRINTS, INFRARED,    ORBS)     \
+    X(GORYO,       "goryo",       FINGERPRINTS, INFRARED,    EMF)      \
+    X(BULLIES,     "bullies",     FINGERPRINTS, WRITING,     RADIO)    \
+    X(MYLING,      "myling",      FINGERPRINTS, WRITING,     EMF)      \
+    X(OBAKE,       "obake",       FINGERPRINTS, ORBS,        EMF)      \
+    X(YUREI,       "yurei",       TEMPERATURE,  INFRARED,    ORBS)     \
+    X(ONI,         "oni",         TEMPERATURE,  INFRARED,    EMF)      \
+    X(MOROI,       "moroi",       TEMPERATURE,  WRITING,     RADIO)    \
+    X(REVENANT,    "revenant",    TEMPERATURE,  WRITING,     ORBS)     \
+    X(SHADE,       "shade",       TEMPERATURE,  WRITING,     EMF)      \
+    X(ONRYO,       "onryo",       TEMPERATURE,  RADIO,       ORBS)     \
+    X(THE_TWINS,   "the_twins",   TEMPERATURE,  RADIO,       EMF)      \
+    X(DEOGEN,      "deogen",      INFRARED,     WRITING,     RADIO)    \
+    X(THAYE,       "thaye",       INFRARED,     WRITING,     ORBS)     \
+    X(YOKAI,       "yokai",       INFRARED,     RADIO,       ORBS)     \
+    X(WRAITH,      "wraith",      INFRARED,     RADIO,       EMF)      \
+    X(RAIJU,       "raiju",       INFRARED,     ORBS,        EMF)      \
+    X(MARE,        "mare",        WRITING,      RADIO,       ORBS)     \
+    X(SPIRIT,      "spirit",      WRITING,      RADIO,       EMF)
+
+#define DOMAIN_COUNT_ONE(...) + 1
+#define EVIDENCE_COUNT (0 EVIDENCE_TABLE(DOMAIN_COUNT_ONE))
+#define GHOST_COUNT (0 GHOST_TABLE(DOMAIN_COUNT_ONE))
+#define EVIDENCE_MASKS (1 << EVIDENCE_COUNT) // every possible EvidenceByte value
+
 enum EvidenceType {
-    EV_EMF          = 1 << 0,
-    EV_ORBS         = 1 << 1,
-    EV_RADIO        = 1 << 2,
-    EV_TEMPERATURE  = 1 << 3,
-    EV_FINGERPRINTS = 1 << 4,
-    EV_WRITING      = 1 << 5,
-    EV_INFRARED     = 1 << 6,
+#define EVIDENCE_ENUM(name, bit, text) EV_##name = 1 << (bit),
+    EVIDENCE_TABLE(EVIDENCE_ENUM)
+#undef EVIDENCE_ENUM
 };
 
 enum GhostType {
-    GH_POLTERGEIST  = EV_FINGERPRINTS | EV_TEMPERATURE | EV_WRITING,
-    GH_THE_MIMIC    = EV_FINGERPRINTS | EV_TEMPERATURE | EV_RADIO,
-    GH_HANTU        = EV_FINGERPRINTS | EV_TEMPERATURE | EV_ORBS,
-    GH_JINN         = EV_FINGERPRINTS | EV_TEMPERATURE | EV_EMF,
-    GH_PHANTOM      = EV_FINGERPRINTS | EV_INFRARED    | EV_RADIO,
-    GH_BANSHEE      = EV_FINGERPRINTS | EV_INFRARED    | EV_ORBS,
-    GH_GORYO        = EV_FINGERPRINTS | EV_INFRARED    | EV_EMF,
-    GH_BULLIES      = EV_FINGERPRINTS | EV_WRITING     | EV_RADIO,
-    GH_MYLING       = EV_FINGERPRINTS | EV_WRITING     | EV_EMF,
-    GH_OBAKE        = EV_FINGERPRINTS | EV_ORBS        | EV_EMF,
-    GH_YUREI        = EV_TEMPERATURE  | EV_INFRARED    | EV_ORBS,
-    GH_ONI          = EV_TEMPERATURE  | EV_INFRARED    | EV_EMF,
-    GH_MOROI        = EV_TEMPERATURE  | EV_WRITING     | EV_RADIO,
-    GH_REVENANT     = EV_TEMPERATURE  | EV_WRITING     | EV_ORBS,
-    GH_SHADE        = EV_TEMPERATURE  | EV_WRITING     | EV_EMF,
-    GH_ONRYO        = EV_TEMPERATURE  | EV_RADIO       | EV_ORBS,
-    GH_THE_TWINS    = EV_TEMPERATURE  | EV_RADIO       | EV_EMF,
-    GH_DEOGEN       = EV_INFRARED     | EV_WRITING     | EV_RADIO,
-    GH_THAYE        = EV_INFRARED     | EV_WRITING     | EV_ORBS,
-    GH_YOKAI        = EV_INFRARED     | EV_RADIO       | EV_ORBS,
-    GH_WRAITH       = EV_INFRARED     | EV_RADIO       | EV_EMF,
-    GH_RAIJU        = EV_INFRARED     | EV_ORBS        | EV_EMF,
-    GH_MARE         = EV_WRITING      | EV_RADIO       | EV_ORBS,
-    GH_SPIRIT       = EV_WRITING      | EV_RADIO       | EV_EMF,
+#define GHOST_ENUM(name, text, a, b, c) GH_##name = EV_##a | EV_##b | EV_##c,
+    GHOST_TABLE(GHOST_ENUM)
+#undef GHOST_ENUM
+};
+
+// Which log_* call a deferred LogEvent expands to
+enum LogEventType {
+    LE_NONE = 0,
+    LE_MOVE,
+    LE_EVIDENCE,
+    LE_GHOST_MOVE
+};
+
+// Small descriptor recorded inside a room critical section; formatting and I/O happen after unlock
+struct LogEvent {
+    enum LogEventType type;
+    int id;
+    int boredom;
+    int fear;
+    const char* from; // room names never change during a run, so the pointers stay valid after unlock
+    const char* to;
+    enum EvidenceType device;
+};
+
+// Investigation phase shared by every entity loop; it only ever moves forward
+enum HousePhase {
+    PHASE_INVESTIGATING = 0, // normal play
+    PHASE_RETURNING = 1,     // hunters stop investigating and head back to the van
+    PHASE_ENDED = 2          // every entity leaves on its next tick
+};
+
+// When the House ends an investigation early
+enum EndPolicy {
+    END_NATURAL = 0,         // entities leave on their own boredom/fear limits (default)
+    END_WHEN_SOLVED = 1,     // everyone leaves once a hunter confirms the case in the van
+    END_WHEN_GHOST_EXITS = 2 // hunters head to the van once the ghost leaves
+};
+
+struct HouseControl {
+    enum HousePhase phase;
+    enum EndPolicy  policy;
+    long            tickUsec;  // real-time length of one entity tick
+    double          timeScale; // 1 = real time, N = N times faster, 0 = turbo (yield instead of sleeping)
+    pthread_mutex_t mutex;  // guards phase
+    pthread_cond_t  wake;   // broadcast on every phase change so sleeping entities react right away
+};
+
+#define CACHE_LINE 64
+#define ENTITY_STACK_SIZE (256 * 1024) // entity threads need little stack; keeps thousands of hunters affordable
+#define HOUSE_ARENA_SIZE (64 * 1024) // first arena block; enough for a few hundred hunters and their paths
+#define ROOM_NONE 0xFF // RoomId meaning "not in any room"
+#define ADMISSION_NONE 0xFFFF // hunter index meaning "no hunter" in a room's admission queue
+#define ADMISSION_MAX_WAIT_TICKS 5 // a queued hunter gives up its place after this many ticks
+
+typedef uint8_t RoomId; // index into House.rooms / RoomLayout; MAX_ROOMS fits in a byte
+
+// One chunk of arena memory; extra chunks are chained when the first one runs out
+struct ArenaBlock {
+    struct ArenaBlock* next;
+    size_t size;
+    size_t used;
+    _Alignas(CACHE_LINE) char data[];
+};
+
+// Bump allocator owning all of a House's dynamic memory; reset once per run instead of freeing piecemeal
+struct Arena {
+    struct ArenaBlock* head;
+    struct ArenaBlock* current;
+    pthread_mutex_t mutex; // entity threads grow their paths concurrently
 };
 
 struct CaseFile {
     EvidenceByte collected; // Union of all of the evidence bits collected between all hunters
     bool         solved;    // True when >=3 unique bits set
     sem_t        mutex;     // Used for synchronizing both fields when multithreading
+} __attribute__((aligned(CACHE_LINE)));
+
+// Cold room data: written once by house_populate_rooms, read-only while entities run
+struct RoomLayout {
+    int    roomCount;
+    RoomId start;                                   // the van
+    char   names[MAX_ROOMS][MAX_ROOM_NAME];         // only needed for logging
+    RoomId connected[MAX_ROOMS][MAX_CONNECTIONS];   // adjacency by room id
+    uint8_t numConnections[MAX_ROOMS];
+    bool   isExit[MAX_ROOMS];
 };
 
-// Implement here based on the requirements, should all be allocated to the House structure
+// Hot per-tick room state, one cache line per room so neighbouring rooms never share a line
 struct Room {
-    char name[MAX_ROOM_NAME]; // name string
-    struct Room* connectedRooms[MAX_CONNECTIONS]; // array of pointers to connected rooms
-    int numConnections;
-    struct Ghost* ghost; // pointer to the ghost (null if ghost isn't there)
-    struct Hunter* hunters[MAX_ROOM_OCCUPANCY]; // array of hunter pointers
-    int numHunters; // count of the number of hunters in the room
-    bool is_exit; // flag if the room is the exit
-    EvidenceByte evidence; // evidence currently in the room
     sem_t mutex; // semaphore;
-};
+    uint16_t* hunters; // indices into House.hunters; capacity is House.maxOccupancy (every hunter for the van)
+    uint16_t numHunters; // count of the number of hunters in the room
+    uint16_t reserved; // freed slots handed to queued hunters that haven't moved in yet
+    uint16_t waitHead; // FIFO of hunters waiting for a slot, linked through Hunter.waitNext
+    uint16_t waitTail;
+    EvidenceByte evidence; // evidence currently in the room
+    bool hasGhost; // true while the ghost is in the room
+    RoomId id;
+} __attribute__((aligned(CACHE_LINE)));
 
 struct RoomNode {
-    struct Room* room; // current room
+    RoomId room; // current room
     struct RoomNode* next;
 };
 
 struct RoomStack {
     struct RoomNode* head;
+    struct RoomNode* freeNodes; // popped nodes kept for reuse
+    struct Arena* arena; // where new nodes come from
 };
 
 // Implement here based on the requirements, should be allocated to the House structure
 struct Ghost {
     int id;
     enum GhostType type;
-    struct Room* room; // room the ghost is in
-    int boredom;
+    RoomId room; // room the ghost is in
     bool exited; // has the ghost exited the house
+    int boredom;
+    int ticks; // loop iterations before exiting
+    struct House* house; // rooms, case file and shared phase
     pthread_mutex_t boredom_mutex;
+} __attribute__((aligned(CACHE_LINE)));
+
+// Hot per-tick hunter state; each hunter owns whole cache lines so counters of different hunters never false-share
+struct Hunter {
+    int id;
+    int fear;
+    int boredom;
+    int roomSlot; // index of this hunter in room->hunters, -1 when not listed
+    RoomId room; // current room the hunter is in
+    bool exited; // if the hunter has left the simulation
+    bool returning; // if hunter is retuning to the van
+    enum EvidenceType device; // device the hunter is using
+    enum LogReason exitReason; // why/if the hunter exited
+    int moves; // rooms entered, including the way back
+    int pickups; // evidence collected
+    int ticks; // loop iterations before exiting
+    RoomId waitingFor; // room whose admission queue the hunter is in, ROOM_NONE if none
+    bool admitted; // a slot in waitingFor is reserved for this hunter
+    uint8_t waitTicks; // ticks spent queued so far
+    uint16_t waitNext; // next hunter in the same queue
+    bool admitSignal; // set under house->control.mutex when a slot is reserved, so the queued wait wakes
+    struct RoomStack path; // the path from the house's starting room
+    struct House* house; // rooms, case file and shared phase
+    pthread_mutex_t mutex;
+} __attribute__((aligned(CACHE_LINE)));
+
+// Cold hunter data kept out of the per-tick working set
+struct HunterInfo {
+    char name[MAX_HUNTER_NAME];
 };
 
 // Can be either stack or heap allocated
+// Room lock acquisitions of one or more threads; only contended waits are timed
+struct LockStats {
+    uint64_t acquires;
+    uint64_t contended;
+    uint64_t waitNs;
+    uint64_t roomWaitNs[MAX_ROOMS]; // wait time broken down by room
+};
+
+// Activity in one room as counted by one or more entity threads
+struct RoomCounters {
+    uint32_t hunterVisits;  // successful hunterMove into the room
+    uint32_t hunterDwell;   // hunter loop iterations started in the room
+    uint32_t pickups;       // evidence collected by hunters
+    uint32_t ghostVisits;   // successful ghostMove into the room
+    uint32_t ghostDwell;    // ghost loop iterations started in the room
+    uint32_t haunts;        // evidence left by ghostHaunt
+};
+
+// One block per entity thread; aligned so no two threads' blocks share a cache line
+struct RoomStats {
+    _Alignas(CACHE_LINE) struct RoomCounters rooms[MAX_ROOMS];
+};
+
 struct House {
-    struct Room* starting_room; // Needed by house_populate_rooms, but can be adjusted to suit your needs.
-    struct Room rooms[MAX_ROOMS]; // all rooms
-    int roomCount;
-    struct Hunter** hunters; //array of hunters
+    struct Arena arena; // hunters, names, thread handles and path nodes and room slots
+    const struct RoomLayout* layout; // names, adjacency and exit flags: ownLayout, or a HouseTemplate's shared by many Houses
+    struct RoomLayout ownLayout; // filled by house_populate_rooms / house_generate_rooms
+    struct Room rooms[MAX_ROOMS]; // hot room state, indexed by RoomId
+    struct Hunter* hunters; // dense, cache-line aligned array of hunters
+    struct HunterInfo* hunterInfo; // names, parallel to hunters
     int hunterCount;
+    int hunterCapacity;
+    int maxOccupancy; // hunters allowed in a room at once; the van is unlimited
+    int boredomMax; // an entity leaves once its boredom goes past this
+    int fearMax; // a hunter leaves once its fear goes past this
+    unsigned seed; // RNG seed for the entity threads, 0 = seeded from the clock
     struct CaseFile casefile; // collected evidence
+    struct HouseControl control; // phase and end policy observed by all entity loops
     struct Ghost ghost;
+    struct LockStats lockStats; // merged from every entity thread when it exits
+    struct RoomStats roomStats; // same
+    pthread_mutex_t statsMutex;
+    struct LiveStats* live; // counters published with --live, NULL otherwise
+    pthread_barrier_t startGate; // holds every entity thread until all of them have been created
+    struct timespec started; // CLOCK_MONOTONIC time the start gate opened
 };
 
-struct Hunter {
-    char name[MAX_HUNTER_NAME];
-    int id;
-    struct Room* room; // current room the hunter is in
-    struct CaseFile *casefile; // the shared case file
-    enum EvidenceType device; // device the hunter is using
-    struct RoomStack path; // the path from the house's starting room
-    int fear;
-    int boredom;
-    enum LogReason exitReason; // why/if the hunter exited
-    bool exited; // if the hunter has left the simulation
-    bool returning; // if hunter is retuning to the van
-    pthread_mutex_t mutex;
+// A prebuilt layout for batch runs: houseClone points a House at the layout and copies the starting room state
+struct HouseTemplate {
+    struct RoomLayout layout; // read-only once built, shared by every House cloned from it
+    struct Room rooms[MAX_ROOMS]; // room state at the start of a run; locks are initialized per clone
 };
 
 /* The provided `house_populate_rooms()` function requires the following functions.
@@ -135,8 +297,8 @@ struct Hunter {
    as needed as long as the house has the correct rooms and connections after calling it.
 */
 
-void room_init(struct Room* room, const char* name, bool is_exit);
+void room_init(struct RoomLayout* layout, RoomId id, const char* name, bool is_exit);
 
-void room_connect(struct Room* a, struct Room* b); // Bidirectional connection
+void room_connect(struct RoomLayout* layout, RoomId a, RoomId b); // Bidirectional connection
 
 #endif // DEFS_H
@@ -0,0 +1,573 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "helpers.h"
+#include "simulation.h"
+#include "results.h"
+
+/*
+    Discrete-event engine: the entity rules with a simulated duration per action instead of one sleep
+    per tick.
+
+    Every entity has exactly one pending event, the time of its next turn. The engine pops the earliest
+    event from a 4-ary min-heap, jumps the clock to it and runs that entity's turn, which follows
+    hunterLoop / ghostLoop. The turn adds up the durations of the actions it took (a van check, a scan
+    that picks up evidence, a move, ...) and the entity is scheduled again at now + that sum, scaled by
+    its pace. Entities that leave are not scheduled again, and the run ends when the heap is empty.
+    Ties are broken by insertion order, so a seed always gives the same run.
+
+    Boredom and fear count the entity's own turns, so a slow hunter tires in simulated time more slowly
+    than a fast one. Everything runs on one thread: no room locks, no sleeps and no logs. A hunter that
+    finds a room full keeps that room as its target and tries again after a wait, giving up after
+    ADMISSION_MAX_WAIT_TICKS tries.
+*/
+
+#define EVENTS_HEAP_ARITY 4
+
+// Action, option name and default duration in ms
+#define EVENT_ACTIONS(X)               \
+    X(EA_MOVE,  "move",  100)          \
+    X(EA_SCAN,  "scan",  300)          \
+    X(EA_VAN,   "van",   200)          \
+    X(EA_WAIT,  "wait",  100)          \
+    X(EA_IDLE,  "idle",  100)          \
+    X(EA_HAUNT, "haunt", 250)          \
+    X(EA_ROAM,  "roam",  150)
+
+enum EventAction {
+#define X(id, name, ms) id,
+    EVENT_ACTIONS(X)
+#undef X
+    EA_COUNT
+};
+
+static const char* const eventActionNames[EA_COUNT] = {
+#define X(id, name, ms) name,
+    EVENT_ACTIONS(X)
+#undef X
+};
+
+static const int eventActionDefaults[EA_COUNT] = {
+#define X(id, name, ms) ms,
+    EVENT_ACTIONS(X)
+#undef X
+};
+
+// One entity's next turn; hunters are entities 0..hunterCount-1 and the ghost is hunterCount
+struct Event {
+    uint64_t time;          // simulated microseconds
+    uint32_t seq;           // insertion order, breaks ties
+    uint32_t entity;
+};
+
+struct EventQueue {
+    struct Event* events;
+    int count;
+    int capacity;
+    uint32_t nextSeq;
+};
+
+struct EventHunter {
+    RoomId room;
+    RoomId waitingFor;      // full room the hunter keeps trying, ROOM_NONE if none
+    bool exited;
+    bool returning;
+    uint8_t exitReason;     // enum LogReason
+    EvidenceByte device;
+    int fear;
+    int boredom;
+    int waitTicks;
+    int moves;
+    int pickups;
+    int turns;
+    double pace;            // multiplies every duration of this hunter
+    RoomId* path;
+    int pathCount;
+    int pathCapacity;
+};
+
+struct EventGhost {
+    enum GhostType type;
+    RoomId room;
+    bool exited;
+    int boredom;
+    int turns;
+};
+
+struct EventRoom {
+    int numHunters;
+    EvidenceByte evidence;
+    bool hasGhost;
+};
+
+struct EventSim {
+    const struct RoomLayout* layout;
+    const struct SimConfig* config;
+    const uint64_t* durations; // per action, simulated microseconds
+
+    struct EventRoom rooms[MAX_ROOMS];
+    struct EventHunter* hunters;
+    int hunterCount;
+    struct EventGhost ghost;
+    EvidenceByte casefile;
+    bool solved;
+    enum HousePhase phase;
+
+    struct EventQueue queue;
+    uint64_t now;
+    uint64_t events;
+};
+
+// ---- Queue ----
+
+static bool event_before(const struct Event* a, const struct Event* b) {
+    return a->time < b->time || (a->time == b->time && a->seq < b->seq);
+}
+
+static void queue_push(struct EventQueue* queue, uint64_t time, uint32_t entity) {
+    if (queue->count == queue->capacity) {
+        queue->capacity = queue->capacity ? queue->capacity * 2 : 64;
+        queue->events = realloc(queue->events, (size_t)queue->capacity * sizeof(*queue->events));
+        if (queue->events == NULL) {
+            perror("event queue");
+            exit(1);
+        }
+    }
+
+    struct Event event = { time, queue->nextSeq++, entity };
+    int at = queue->count++;
+    while (at > 0) {
+        int parent = (at - 1) / EVENTS_HEAP_ARITY;
+        if (!event_before(&event, &queue->events[parent])) break;
+        queue->events[at] = queue->events[parent];
+        at = parent;
+    }
+    queue->events[at] = event;
+}
+
+// Caller checks the queue isn't empty
+static struct Event queue_pop(struct EventQueue* queue) {
+    struct Event top = queue->events[0];
+    struct Event last = queue->events[--queue->count];
+    int at = 0;
+    while (true) {
+        int first = at * EVENTS_HEAP_ARITY + 1;
+        if (first >= queue->count) break;
+        int best = first;
+        int end = first + EVENTS_HEAP_ARITY < queue->count ? first + EVENTS_HEAP_ARITY : queue->count;
+        for (int child = first + 1; child < end; child++) {
+            if (event_before(&queue->events[child], &queue->events[best])) best = child;
+        }
+        if (!event_before(&queue->events[best], &last)) break;
+        queue->events[at] = queue->events[best];
+        at = best;
+    }
+    if (queue->count > 0) queue->events[at] = last;
+    return top;
+}
+
+// ---- Turns ----
+
+static void hunter_exit(struct EventSim* sim, struct EventHunter* hunter, enum LogReason reason) {
+    hunter->exited = true;
+    hunter->exitReason = (uint8_t)reason;
+    hunter->pathCount = 0;
+    sim->rooms[hunter->room].numHunters--;
+}
+
+// Move into a room if it has space; a full room is kept as the target and retried on the next turn
+static bool hunter_enter(struct EventSim* sim, struct EventHunter* hunter, RoomId target) {
+    struct EventRoom* room = &sim->rooms[target];
+    if (!sim->layout->isExit[target] && room->numHunters >= sim->config->maxOccupancy) {
+        if (hunter->waitingFor != target) {
+            hunter->waitingFor = target;
+            hunter->waitTicks = 0;
+        }
+        if (++hunter->waitTicks > ADMISSION_MAX_WAIT_TICKS) hunter->waitingFor = ROOM_NONE;
+        return false;
+    }
+
+    sim->rooms[hunter->room].numHunters--;
+    room->numHunters++;
+    hunter->waitingFor = ROOM_NONE;
+    hunter->room = target;
+    hunter->moves++;
+    return true;
+}
+
+static void path_push(struct EventHunter* hunter, RoomId room) {
+    if (hunter->pathCount == hunter->pathCapacity) {
+        hunter->pathCapacity = hunter->pathCapacity ? hunter->pathCapacity * 2 : 16;
+        hunter->path = realloc(hunter->path, (size_t)hunter->pathCapacity);
+        if (hunter->path == NULL) {
+            perror("event engine");
+            exit(1);
+        }
+    }
+    hunter->path[hunter->pathCount++] = room;
+}
+
+// One turn of hunterLoop; returns its simulated length, 0 once the hunter has left
+static uint64_t hunter_turn(struct EventSim* sim, struct EventHunter* hunter) {
+    const struct RoomLayout* layout = sim->layout;
+    const struct SimConfig* config = sim->config;
+    const uint64_t* durations = sim->durations;
+    uint64_t spent = 0;
+
+    hunter->turns++;
+    if (sim->rooms[hunter->room].hasGhost) {
+        hunter->fear++;
+        hunter->boredom = 0;
+    } else {
+        hunter->boredom++;
+    }
+    if (hunter->boredom > config->boredomMax) {
+        hunter_exit(sim, hunter, LR_BORED);
+        return 0;
+    }
+    if (hunter->fear > config->fearMax) {
+        hunter_exit(sim, hunter, LR_AFRAID);
+        return 0;
+    }
+
+    if (sim->phase == PHASE_ENDED) {
+        hunter_exit(sim, hunter, sim->solved ? LR_EVIDENCE : LR_BORED);
+        return 0;
+    }
+    if (sim->phase == PHASE_RETURNING) hunter->returning = true;
+
+    if (hunter->returning && hunter->pathCount > 0) {
+        RoomId next = hunter->path[hunter->pathCount - 1];
+        if (hunter->waitingFor != ROOM_NONE && hunter->waitingFor != next) hunter->waitingFor = ROOM_NONE;
+        if (hunter_enter(sim, hunter, next)) {
+            hunter->pathCount--;
+            return (uint64_t)(durations[EA_MOVE] * hunter->pace);
+        }
+        return (uint64_t)(durations[EA_WAIT] * hunter->pace);
+    }
+
+    if (layout->isExit[hunter->room] && hunter->returning) {
+        spent += durations[EA_VAN];
+        hunter->returning = false;
+        hunter->pathCount = 0;
+
+        if (evidence_names_ghost(sim->casefile)) {
+            sim->solved = true;
+            hunter_exit(sim, hunter, LR_EVIDENCE);
+            if (config->policy == END_WHEN_SOLVED) sim->phase = PHASE_ENDED;
+            return 0;
+        }
+        if (sim->phase == PHASE_RETURNING) {
+            hunter_exit(sim, hunter, LR_BORED);
+            return 0;
+        }
+
+        const enum EvidenceType* devices;
+        int deviceCount = get_all_evidence_types(&devices);
+        EvidenceByte newDevice;
+        do {
+            newDevice = (EvidenceByte)devices[rand_int_threadsafe(0, deviceCount)];
+        } while (newDevice == hunter->device);
+        hunter->device = newDevice;
+    }
+
+    struct EventRoom* room = &sim->rooms[hunter->room];
+    if (room->evidence & hunter->device) {
+        spent += durations[EA_SCAN];
+        room->evidence &= (EvidenceByte)~hunter->device;
+        hunter->pickups++;
+        sim->casefile |= hunter->device;
+        if (!layout->isExit[hunter->room]) hunter->returning = true;
+    }
+
+    if (!hunter->returning) {
+        RoomId from = hunter->room;
+        RoomId target = hunter->waitingFor;
+        if (target == ROOM_NONE) {
+            target = layout->connected[from][rand_int_threadsafe(0, layout->numConnections[from])];
+        }
+        if (hunter_enter(sim, hunter, target)) {
+            path_push(hunter, from);
+            spent += durations[EA_MOVE];
+        } else {
+            spent += durations[EA_WAIT];
+        }
+    }
+
+    if (spent == 0) spent = durations[EA_WAIT];
+    return (uint64_t)(spent * hunter->pace);
+}
+
+static void ghost_leave(struct EventSim* sim) {
+    sim->ghost.exited = true;
+    sim->rooms[sim->ghost.room].hasGhost = false;
+}
+
+// One turn of ghostLoop; returns its simulated length, 0 once the ghost has left
+static uint64_t ghost_turn(struct EventSim* sim) {
+    struct EventGhost* ghost = &sim->ghost;
+    const struct RoomLayout* layout = sim->layout;
+
+    ghost->turns++;
+    if (sim->phase == PHASE_ENDED) {
+        ghost_leave(sim);
+        return 0;
+    }
+
+    int choice;
+    if (sim->rooms[ghost->room].numHunters > 0) {
+        ghost->boredom = 0;
+        choice = rand_int_threadsafe(1, 3);
+    } else {
+        ghost->boredom++;
+        choice = rand_int_threadsafe(1, 4);
+    }
+    if (ghost->boredom > sim->config->boredomMax) {
+        ghost_leave(sim);
+        if (sim->config->policy == END_WHEN_GHOST_EXITS && sim->phase == PHASE_INVESTIGATING) {
+            sim->phase = PHASE_RETURNING;
+        }
+        return 0;
+    }
+
+    switch (choice) {
+        case 1:
+            return sim->durations[EA_IDLE];
+        case 2:
+            sim->rooms[ghost->room].evidence |= (EvidenceByte)get_random_evidence(ghost->type);
+            return sim->durations[EA_HAUNT];
+        default:
+            if (layout->numConnections[ghost->room] > 0) {
+                RoomId next = layout->connected[ghost->room][rand_int_threadsafe(0, layout->numConnections[ghost->room])];
+                sim->rooms[ghost->room].hasGhost = false;
+                sim->rooms[next].hasGhost = true;
+                ghost->room = next;
+            }
+            return sim->durations[EA_ROAM];
+    }
+}
+
+// ---- Runs ----
+
+// One investigation from its seed; returns the simulated time of the last event
+static uint64_t events_run(struct EventSim* sim, const struct RoomLayout* layout, const struct SimConfig* config,
+                           const uint64_t* durations, double paceSpread, struct SimResult* result) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    rand_seed_threadsafe(config->seed);
+    sim->layout = layout;
+    sim->config = config;
+    sim->durations = durations;
+    memset(sim->rooms, 0, sizeof(sim->rooms));
+    sim->casefile = 0;
+    sim->solved = false;
+    sim->phase = PHASE_INVESTIGATING;
+    sim->now = 0;
+    sim->events = 0;
+    sim->queue.count = 0;
+    sim->queue.nextSeq = 0;
+
+    const enum GhostType* ghostTypes;
+    int ghostCount = get_all_ghost_types(&ghostTypes);
+    sim->ghost = (struct EventGhost){
+        .type = ghostTypes[rand_int_threadsafe(0, ghostCount)],
+        .room = (RoomId)rand_int_threadsafe(0, layout->roomCount),
+    };
+    sim->rooms[sim->ghost.room].hasGhost = true;
+
+    const enum EvidenceType* devices;
+    int deviceCount = get_all_evidence_types(&devices);
+    for (int i = 0; i < sim->hunterCount; i++) {
+        struct EventHunter* hunter = &sim->hunters[i];
+        RoomId* path = hunter->path;
+        int pathCapacity = hunter->pathCapacity;
+        *hunter = (struct EventHunter){
+            .room = layout->start,
+            .waitingFor = ROOM_NONE,
+            .device = (EvidenceByte)devices[rand_int_threadsafe(0, deviceCount)],
+            .pace = 1.0 + paceSpread * (2.0 * rand_int_threadsafe(0, 10001) / 10000.0 - 1.0),
+            .path = path,
+            .pathCapacity = pathCapacity,
+        };
+    }
+    sim->rooms[layout->start].numHunters = sim->hunterCount;
+
+    queue_push(&sim->queue, 0, (uint32_t)sim->hunterCount);
+    for (int i = 0; i < sim->hunterCount; i++) queue_push(&sim->queue, 0, (uint32_t)i);
+
+    while (sim->queue.count > 0) {
+        struct Event event = queue_pop(&sim->queue);
+        sim->now = event.time;
+        sim->events++;
+        uint64_t duration = event.entity == (uint32_t)sim->hunterCount
+                          ? ghost_turn(sim)
+                          : hunter_turn(sim, &sim->hunters[event.entity]);
+        if (duration > 0) queue_push(&sim->queue, sim->now + duration, event.entity);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    memset(result, 0, sizeof(*result));
+    result->seed = config->seed;
+    result->ghostType = sim->ghost.type;
+    result->collected = sim->casefile;
+    result->solved = sim->solved;
+    result->hunterCount = sim->hunterCount;
+    result->ticks = (uint32_t)sim->ghost.turns;
+    result->wallSeconds = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+    for (int i = 0; i < sim->hunterCount; i++) {
+        const struct EventHunter* hunter = &sim->hunters[i];
+        result->exitCounts[hunter->exitReason]++;
+        result->moves += (uint64_t)hunter->moves;
+        result->pickups += (uint64_t)hunter->pickups;
+        if ((uint32_t)hunter->turns > result->ticks) result->ticks = (uint32_t)hunter->turns;
+        if (i < SIM_MAX_OUTCOMES) {
+            result->hunters[i].exitReason = hunter->exitReason;
+            result->hunters[i].fear = (uint32_t)hunter->fear;
+            result->hunters[i].boredom = (uint32_t)hunter->boredom;
+        }
+    }
+    return sim->now;
+}
+
+// "move=150,scan=400": durations in ms by action name
+static bool durations_parse(const char* text, uint64_t* durations) {
+    char buffer[256];
+    if (strlen(text) >= sizeof(buffer)) return false;
+    strcpy(buffer, text);
+
+    for (char* item = strtok(buffer, ","); item; item = strtok(NULL, ",")) {
+        char* equals = strchr(item, '=');
+        if (!equals) return false;
+        *equals = '\0';
+        int ms;
+        if (!simulation_parse_positive(equals + 1, &ms)) return false;
+
+        int action = 0;
+        while (action < EA_COUNT && strcmp(item, eventActionNames[action]) != 0) action++;
+        if (action == EA_COUNT) return false;
+        durations[action] = (uint64_t)ms * 1000;
+    }
+    return true;
+}
+
+static void events_usage(void) {
+    fprintf(stderr,
+            "Usage: huntSimulation --events [options]\n"
+            "  --hunters N         hunters per run (default 4)\n"
+            "  --rooms N           generated house with N rooms (default: Willow House)\n"
+            "  --runs N            investigations to run (default 100)\n"
+            "  --duration A=MS,... simulated length of an action:");
+    for (int a = 0; a < EA_COUNT; a++) fprintf(stderr, " %s=%d", eventActionNames[a], eventActionDefaults[a]);
+    fprintf(stderr,
+            "\n"
+            "  --pace-spread F     hunters act from 1-F to 1+F times the listed durations (default 0.2)\n"
+            "  --occupancy N       hunters allowed per room (default %d; the van is unlimited)\n"
+            "  --boredom N         boredom limit (default %d)\n"
+            "  --fear N            fear limit (default %d)\n"
+            "  --end-policy P      natural|solved|ghost-exit (default natural)\n"
+            "  --seed S            base seed; run r uses S + r (default: clock)\n"
+            "  --results FILE      append every run to a columnar results file\n",
+            MAX_ROOM_OCCUPANCY, ENTITY_BOREDOM_MAX, HUNTER_FEAR_MAX);
+}
+
+int events_main(int argc, char* argv[]) {
+    struct SimConfig config;
+    simulation_config_default(&config);
+
+    uint64_t durations[EA_COUNT];
+    for (int a = 0; a < EA_COUNT; a++) durations[a] = (uint64_t)eventActionDefaults[a] * 1000;
+    int runs = 100;
+    double paceSpread = 0.2;
+    unsigned baseSeed = 0;
+    const char* resultsPath = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        bool ok = i + 1 < argc;
+        if (ok && strcmp(argv[i], "--hunters") == 0) ok = simulation_parse_positive(argv[++i], &config.hunterCount);
+        else if (ok && strcmp(argv[i], "--rooms") == 0) ok = simulation_parse_positive(argv[++i], &config.roomCount);
+        else if (ok && strcmp(argv[i], "--runs") == 0) ok = simulation_parse_positive(argv[++i], &runs);
+        else if (ok && strcmp(argv[i], "--duration") == 0) ok = durations_parse(argv[++i], durations);
+        else if (ok && strcmp(argv[i], "--pace-spread") == 0) {
+            char* end;
+            paceSpread = strtod(argv[++i], &end);
+            ok = *end == '\0' && paceSpread >= 0 && paceSpread < 1;
+        }
+        else if (ok && strcmp(argv[i], "--occupancy") == 0) ok = simulation_parse_positive(argv[++i], &config.maxOccupancy);
+        else if (ok && strcmp(argv[i], "--boredom") == 0) ok = simulation_parse_positive(argv[++i], &config.boredomMax);
+        else if (ok && strcmp(argv[i], "--fear") == 0) ok = simulation_parse_positive(argv[++i], &config.fearMax);
+        else if (ok && strcmp(argv[i], "--end-policy") == 0) ok = end_policy_from_string(argv[++i], &config.policy);
+        else if (ok && strcmp(argv[i], "--seed") == 0) baseSeed = (unsigned)strtoul(argv[++i], NULL, 10);
+        else if (ok && strcmp(argv[i], "--results") == 0) resultsPath = argv[++i];
+        else ok = false;
+
+        if (!ok || config.roomCount > MAX_ROOMS) {
+            events_usage();
+            return 1;
+        }
+    }
+    if (baseSeed == 0) baseSeed = (unsigned)time(NULL);
+
+    static struct HouseTemplate layout;
+    rand_seed_threadsafe(baseSeed);
+    house_template_init(&layout, config.roomCount);
+
+    struct ResultsWriter results;
+    if (resultsPath && resultsOpen(&results, resultsPath, SIM_MAX_OUTCOMES) != 0) return 1;
+
+    static struct EventSim sim;
+    sim.hunterCount = config.hunterCount;
+    sim.hunters = calloc((size_t)config.hunterCount, sizeof(*sim.hunters));
+    if (sim.hunters == NULL) {
+        perror("event engine");
+        return 1;
+    }
+
+    printf("Discrete-event engine: %s, %d hunters, occupancy %d, %d run(s), seed %u\n",
+           config.roomCount > 0 ? "generated house" : "Willow House",
+           config.hunterCount, config.maxOccupancy, runs, baseSeed);
+    printf("Durations (ms):");
+    for (int a = 0; a < EA_COUNT; a++) printf(" %s %llu", eventActionNames[a], (unsigned long long)(durations[a] / 1000));
+    printf(", hunter pace +/-%.0f%%\n", paceSpread * 100.0);
+
+    int wins = 0;
+    int exits[3] = {0};
+    double simulated = 0;
+    double longest = 0;
+    uint64_t events = 0;
+    double wall = 0;
+    int status = 0;
+    struct SimResult result;
+    for (int r = 0; r < runs; r++) {
+        config.seed = baseSeed + (unsigned)r;
+        double seconds = (double)events_run(&sim, &layout.layout, &config, durations, paceSpread, &result) / 1e6;
+        if (resultsPath && resultsAppend(&results, &result) != 0) {
+            status = 1;
+            break;
+        }
+
+        wins += result.collected == (EvidenceByte)result.ghostType; // same win as sweep, shard and the results summary
+        for (int e = 0; e < 3; e++) exits[e] += result.exitCounts[e];
+        simulated += seconds;
+        if (seconds > longest) longest = seconds;
+        events += sim.events;
+        wall += result.wallSeconds;
+    }
+
+    if (status == 0) {
+        printf("%8s %8s %10s %8s %8s %12s %12s %12s %10s %14s\n",
+               "runs", "win %", "evidence", "afraid", "bored", "mean sim s", "max sim s", "events", "wall ms", "events/s");
+        printf("%8d %7.1f%% %10d %8d %8d %12.1f %12.1f %12llu %10.1f %14.0f\n",
+               runs, 100.0 * wins / runs, exits[LR_EVIDENCE], exits[LR_AFRAID], exits[LR_BORED],
+               simulated / runs, longest, (unsigned long long)events, wall * 1000.0,
+               (double)events / (wall > 0 ? wall : 1e-9));
+    }
+
+    for (int i = 0; i < sim.hunterCount; i++) free(sim.hunters[i].path);
+    free(sim.hunters);
+    free(sim.queue.events);
+    if (resultsPath && resultsClose(&results) != 0) return 1;
+    return status;
+}
@@ -6,118 +6,180 @@
 #include <pthread.h>
 #include <stdint.h>
 #include "helpers.h"
+#include "live.h"
+#include "lockdebug.h"
+#include "profile.h"
+#include "logseg.h"
 #include <unistd.h>
+#include <errno.h>
+#include <sched.h>
 
 // ---- House layout ----
-void house_populate_rooms(struct House* house) {
+
+// Hot per-room state at the start of a run; slot arrays are allocated by housePlaceHunters once the roster is known
+static void room_state_init(struct Room* room, RoomId id) {
+    room->id = id;
+    room->hunters = NULL;
+    room->numHunters = 0;
+    room->reserved = 0;
+    room->waitHead = ADMISSION_NONE;
+    room->waitTail = ADMISSION_NONE;
+    room->evidence = 0;
+    room->hasGhost = false;
+}
+
+static void houseInitRooms(struct House* house) {
+    for (int i = 0; i < house->layout->roomCount; i++) {
+        room_state_init(&house->rooms[i], (RoomId)i);
+        sem_init(&house->rooms[i].mutex, 0, 1);
+    }
+}
+
+static void layout_populate(struct RoomLayout* layout) {
     // Willow House layout from Phasmaphobia, DO NOT MODIFY HOUSE LAYOUT
-    house->roomCount = 13;
-
-    room_init(house->rooms+0, "Van", true);
-    room_init(house->rooms+1, "Hallway", false);
-    room_init(house->rooms+2, "Master Bedroom", false);
-    room_init(house->rooms+3, "Boy's Bedroom", false);
-    room_init(house->rooms+4, "Bathroom", false);
-    room_init(house->rooms+5, "Basement", false);
-    room_init(house->rooms+6, "Basement Hallway", false);
-    room_init(house->rooms+7, "Right Storage Room", false);
-    room_init(house->rooms+8, "Left Storage Room", false);
-    room_init(house->rooms+9, "Kitchen", false);
-    room_init(house->rooms+10, "Living Room", false);
-    room_init(house->rooms+11, "Garage", false);
-    room_init(house->rooms+12, "Utility Room", false);
-
-    room_connect(house->rooms+0, house->rooms+1);    // Van - Hallway
-    room_connect(house->rooms+1, house->rooms+2);    // Hallway - Master Bedroom
-    room_connect(house->rooms+1, house->rooms+3);    // Hallway - Boy's Bedroom
-    room_connect(house->rooms+1, house->rooms+4);    // Hallway - Bathroom
-    room_connect(house->rooms+1, house->rooms+9);    // Hallway - Kitchen
-    room_connect(house->rooms+1, house->rooms+5);    // Hallway - Basement
-    room_connect(house->rooms+5, house->rooms+6);    // Basement - Basement Hallway
-    room_connect(house->rooms+6, house->rooms+7);    // Basement Hallway - Right Storage Room
-    room_connect(house->rooms+6, house->rooms+8);    // Basement Hallway - Left Storage Room
-    room_connect(house->rooms+9, house->rooms+10);   // Kitchen - Living Room
-    room_connect(house->rooms+9, house->rooms+11);   // Kitchen - Garage
-    room_connect(house->rooms+11, house->rooms+12);  // Garage - Utility Room
-
-    house->starting_room = house->rooms; // Van is at index 0
+    layout->roomCount = 13;
+
+    room_init(layout, 0, "Van", true);
+    room_init(layout, 1, "Hallway", false);
+    room_init(layout, 2, "Master Bedroom", false);
+    room_init(layout, 3, "Boy's Bedroom", false);
+    room_init(layout, 4, "Bathroom", false);
+    room_init(layout, 5, "Basement", false);
+    room_init(layout, 6, "Basement Hallway", false);
+    room_init(layout, 7, "Right Storage Room", false);
+    room_init(layout, 8, "Left Storage Room", false);
+    room_init(layout, 9, "Kitchen", false);
+    room_init(layout, 10, "Living Room", false);
+    room_init(layout, 11, "Garage", false);
+    room_init(layout, 12, "Utility Room", false);
+
+    room_connect(layout, 0, 1);    // Van - Hallway
+    room_connect(layout, 1, 2);    // Hallway - Master Bedroom
+    room_connect(layout, 1, 3);    // Hallway - Boy's Bedroom
+    room_connect(layout, 1, 4);    // Hallway - Bathroom
+    room_connect(layout, 1, 9);    // Hallway - Kitchen
+    room_connect(layout, 1, 5);    // Hallway - Basement
+    room_connect(layout, 5, 6);    // Basement - Basement Hallway
+    room_connect(layout, 6, 7);    // Basement Hallway - Right Storage Room
+    room_connect(layout, 6, 8);    // Basement Hallway - Left Storage Room
+    room_connect(layout, 9, 10);   // Kitchen - Living Room
+    room_connect(layout, 9, 11);   // Kitchen - Garage
+    room_connect(layout, 11, 12);  // Garage - Utility Room
+
+    layout->start = 0; // Van is at index 0
+}
+
+static void layout_generate(struct RoomLayout* layout, int roomCount) {
+    if (roomCount < 2) roomCount = 2;
+    if (roomCount > MAX_ROOMS) roomCount = MAX_ROOMS;
+    layout->roomCount = roomCount;
+
+    char name[MAX_ROOM_NAME];
+    room_init(layout, 0, "Van", true);
+    for (int i = 1; i < roomCount; i++) {
+        snprintf(name, sizeof(name), "Room %d", i);
+        room_init(layout, (RoomId)i, name, false);
+    }
+
+    // random spanning tree so every room is reachable; the van only opens onto the first room, like Willow House
+    room_connect(layout, 0, 1);
+    for (int i = 2; i < roomCount; i++) {
+        RoomId parent;
+        do {
+            parent = (RoomId)rand_int_threadsafe(1, i);
+        } while (layout->numConnections[parent] >= MAX_CONNECTIONS);
+        room_connect(layout, parent, (RoomId)i);
+    }
+
+    // a few extra doors to create loops (room_connect ignores duplicates and full rooms)
+    for (int i = 0; i < roomCount / 4; i++) {
+        room_connect(layout, (RoomId)rand_int_threadsafe(1, roomCount), (RoomId)rand_int_threadsafe(1, roomCount));
+    }
+
+    layout->start = 0;
+}
+
+void house_populate_rooms(struct House* house) {
+    layout_populate(&house->ownLayout);
+    house->layout = &house->ownLayout;
+    houseInitRooms(house);
+}
+
+void house_generate_rooms(struct House* house, int roomCount) {
+    layout_generate(&house->ownLayout, roomCount);
+    house->layout = &house->ownLayout;
+    houseInitRooms(house);
 }
 
+void house_template_init(struct HouseTemplate* template, int roomCount) {
+    if (roomCount > 0) {
+        layout_generate(&template->layout, roomCount);
+    } else {
+        layout_populate(&template->layout);
+    }
+    memset(template->rooms, 0, sizeof(template->rooms));
+    for (int i = 0; i < template->layout.roomCount; i++) {
+        room_state_init(&template->rooms[i], (RoomId)i);
+    }
+}
+
+void houseClone(struct House* house, const struct HouseTemplate* template) {
+    house->layout = &template->layout;
+    memcpy(house->rooms, template->rooms, (size_t)template->layout.roomCount * sizeof(struct Room));
+    for (int i = 0; i < template->layout.roomCount; i++) {
+        sem_init(&house->rooms[i].mutex, 0, 1);
+    }
+}
+
+const char* room_name(const struct House* house, RoomId id) {
+    if (id == ROOM_NONE) return "";
+    return house->layout->names[id];
+}
+
+// ---- Ghost and evidence tables, generated from EVIDENCE_TABLE and GHOST_TABLE ----
+
+// Indexed by evidence bit
+static const char* const evidenceNames[EVIDENCE_COUNT] = {
+#define EVIDENCE_NAME(name, bit, text) [bit] = text,
+    EVIDENCE_TABLE(EVIDENCE_NAME)
+#undef EVIDENCE_NAME
+};
+
+// Indexed by evidence mask; NULL where the mask is not a ghost
+static const char* const ghostNames[EVIDENCE_MASKS] = {
+#define GHOST_NAME(name, text, a, b, c) [GH_##name] = text,
+    GHOST_TABLE(GHOST_NAME)
+#undef GHOST_NAME
+};
+
+// Indexed by evidence mask; the three evidence types a ghost leaves behind
+static const enum EvidenceType ghostEvidence[EVIDENCE_MASKS][3] = {
+#define GHOST_EVIDENCE(name, text, a, b, c) [GH_##name] = {EV_##a, EV_##b, EV_##c},
+    GHOST_TABLE(GHOST_EVIDENCE)
+#undef GHOST_EVIDENCE
+};
+
+static const enum EvidenceType evidenceTypes[EVIDENCE_COUNT] = {
+#define EVIDENCE_VALUE(name, bit, text) EV_##name,
+    EVIDENCE_TABLE(EVIDENCE_VALUE)
+#undef EVIDENCE_VALUE
+};
+
+static const enum GhostType ghostTypes[GHOST_COUNT] = {
+#define GHOST_VALUE(name, text, a, b, c) GH_##name,
+    GHOST_TABLE(GHOST_VALUE)
+#undef GHOST_VALUE
+};
+
 // ---- to_string functions ----
 const char* evidence_to_string(enum EvidenceType evidence) {
-    switch (evidence) {
-        case EV_EMF:
-            return "emf";
-        case EV_ORBS:
-            return "orbs";
-        case EV_RADIO:
-            return "radio";
-        case EV_TEMPERATURE:
-            return "temp";
-        case EV_FINGERPRINTS:
-            return "prints";
-        case EV_WRITING:
-            return "writing";
-        case EV_INFRARED:
-            return "infrared";
-        default:
-            return "unknown";
-    }
+    if (evidence <= 0 || evidence >= EVIDENCE_MASKS || (evidence & (evidence - 1)) != 0) return "unknown";
+    return evidenceNames[__builtin_ctz((unsigned)evidence)];
 }
 
 const char* ghost_to_string(enum GhostType ghost) {
-    switch (ghost) {
-        case GH_POLTERGEIST:
-            return "poltergeist";
-        case GH_THE_MIMIC:
-            return "the_mimic";
-        case GH_HANTU:
-            return "hantu";
-        case GH_JINN:
-            return "jinn";
-        case GH_PHANTOM:
-            return "phantom";
-        case GH_BANSHEE:
-            return "banshee";
-        case GH_GORYO:
-            return "goryo";
-        case GH_BULLIES:
-            return "bullies";
-        case GH_MYLING:
-            return "myling";
-        case GH_OBAKE:
-            return "obake";
-        case GH_YUREI:
-            return "yurei";
-        case GH_ONI:
-            return "oni";
-        case GH_MOROI:
-            return "moroi";
-        case GH_REVENANT:
-            return "revenant";
-        case GH_SHADE:
-            return "shade";
-        case GH_ONRYO:
-            return "onryo";
-        case GH_THE_TWINS:
-            return "the_twins";
-        case GH_DEOGEN:
-            return "deogen";
-        case GH_THAYE:
-            return "thaye";
-        case GH_YOKAI:
-            return "yokai";
-        case GH_WRAITH:
-            return "wraith";
-        case GH_RAIJU:
-            return "raiju";
-        case GH_MARE:
-            return "mare";
-        case GH_SPIRIT:
-            return "spirit";
-        default:
-            return "unknown";
-    }
+    if (ghost <= 0 || ghost >= EVIDENCE_MASKS || ghostNames[ghost] == NULL) return "unknown";
+    return ghostNames[ghost];
 }
 
 const char* exit_reason_to_string(enum LogReason reason) {
@@ -135,62 +197,27 @@ const char* exit_reason_to_string(enum LogReason reason) {
 
 // ---- enum retrieval functions ----
 int get_all_evidence_types(const enum EvidenceType** list) {
-    // Stored in the data segment so that we can point to it safely
-    static const enum EvidenceType evidence_types[] = {
-        EV_EMF,
-        EV_ORBS,
-        EV_RADIO,
-        EV_TEMPERATURE,
-        EV_FINGERPRINTS,
-        EV_WRITING,
-        EV_INFRARED
-    };
-
     if (list) {
-        *list = evidence_types;
+        *list = evidenceTypes;
     }
-    return (int)(sizeof(evidence_types) / sizeof(evidence_types[0]));
+    return EVIDENCE_COUNT;
 }
 
 int get_all_ghost_types(const enum GhostType** list) {
-    // Stored in the data segment so that we can point to it safely
-    static const enum GhostType ghost_types[] = {
-        GH_POLTERGEIST,
-        GH_THE_MIMIC,
-        GH_HANTU,
-        GH_JINN,
-        GH_PHANTOM,
-        GH_BANSHEE,
-        GH_GORYO,
-        GH_BULLIES,
-        GH_MYLING,
-        GH_OBAKE,
-        GH_YUREI,
-        GH_ONI,
-        GH_MOROI,
-        GH_REVENANT,
-        GH_SHADE,
-        GH_ONRYO,
-        GH_THE_TWINS,
-        GH_DEOGEN,
-        GH_THAYE,
-        GH_YOKAI,
-        GH_WRAITH,
-        GH_RAIJU,
-        GH_MARE,
-        GH_SPIRIT
-    };
-
     if (list) {
-        *list = ghost_types;
+        *list = ghostTypes;
     }
-    return (int)(sizeof(ghost_types) / sizeof(ghost_types[0]));
+    return GHOST_COUNT;
 }
 
 // ---- Thread-safe random number generation ----
-int rand_int_threadsafe(int lower_inclusive, int upper_exclusive) {
-    static _Thread_local unsigned seed = 0;
+static _Thread_local unsigned seed = 0;
 
+void rand_seed_threadsafe(unsigned value) {
+    seed = value ? value : 0xA5A5A5A5u;
+}
+
+int rand_int_threadsafe(int lower_inclusive, int upper_exclusive) {
     if (upper_exclusive <= lower_inclusive) {
         return lower_inclusive;
     }
@@ -209,20 +236,23 @@ int rand_int_threadsafe(int lower_inclusive, int upper_exclusive) {
 
 // ---- Evidence helpers ----
 bool evidence_is_valid_ghost(EvidenceByte mask) {
-    const enum GhostType* ghost_types = NULL;
-    int ghost_count = get_all_ghost_types(&ghost_types);
+    return mask < EVIDENCE_MASKS && ghostNames[mask] != NULL;
+}
 
-    for (int index = 0; index < ghost_count; index++) {
-        if (mask == (EvidenceByte)ghost_types[index]) {
-            return true;
-        }
-    }
+bool evidence_has_three_unique(EvidenceByte mask) {
+    return __builtin_popcount(mask) >= 3;
+}
 
+bool evidence_names_ghost(EvidenceByte mask) {
+    for (int i = 0; i < GHOST_COUNT; i++) {
+        if ((mask & ghostTypes[i]) == ghostTypes[i]) return true;
+    }
     return false;
 }
 
 // ---- Logging (Writes CSV logs, DO NOT MODIFY the file outputs: timestamp,type,id,room,device,boredom,fear,action,extra) ----
 
+#if LOG_LEVEL > LOG_LEVEL_NONE
 // These enums are just for logging purposes, not needed elsewhere
 enum LogEntityType {
     LOG_ENTITY_HUNTER = 0,
@@ -251,14 +281,60 @@ static const char* log_entity_type_to_string(enum LogEntityType type) {
     }
 }
 
-static void write_log_record(const struct LogRecord* record) {
-    static _Thread_local unsigned line_count = 0;
+#endif // LOG_LEVEL > LOG_LEVEL_NONE
 
-    if (line_count >= 100000) {
-        fprintf(stderr, "Log capped for entity %d; stopping to prevent infinite growth.\n", record->entity_id);
-        exit(1);
+// Scales the per-line pause below; shares HouseControl.timeScale's meaning
+static double log_time_scale = 1.0;
+
+void log_set_time_scale(double scale) {
+    log_time_scale = scale;
+}
+
+// What the compiled-in log_* calls write at run time; batch and stress runs turn every sink off
+static unsigned log_sinks = LOG_SINKS;
+static int log_level = LOG_LEVEL;
+
+void log_set_sinks(unsigned sinks) {
+    log_sinks = sinks & LOG_SINKS;
+}
+
+void log_set_level(int level) {
+    log_level = level;
+}
+
+bool log_level_from_string(const char* text, int* level) {
+    static const char* const names[] = { "none", "lifecycle", "evidence", "all" };
+    for (int i = 0; i <= LOG_LEVEL_ALL; i++) {
+        if (strcmp(text, names[i]) == 0) {
+            *level = i;
+            return true;
+        }
     }
+    return false;
+}
 
+bool log_sinks_from_string(const char* text, unsigned* sinks) {
+    if (strcmp(text, "none") == 0) *sinks = 0;
+    else if (strcmp(text, "csv") == 0) *sinks = LOG_SINK_CSV;
+    else if (strcmp(text, "stdout") == 0) *sinks = LOG_SINK_STDOUT;
+    else if (strcmp(text, "csv,stdout") == 0 || strcmp(text, "stdout,csv") == 0) *sinks = LOG_SINK_CSV | LOG_SINK_STDOUT;
+    else return false;
+    return true;
+}
+
+void log_close(void) {
+    segmentCompressorStop();
+}
+
+#if LOG_LEVEL > LOG_LEVEL_NONE
+// A sink is written when it is compiled in and turned on
+#define LOG_TO(sink) ((LOG_SINKS & (sink)) && (log_sinks & (sink)))
+
+static bool log_wanted(int level) {
+    return log_sinks != 0 && level <= log_level;
+}
+
+static void write_log_record(const struct LogRecord* record) {
     char filename[64];
     snprintf(filename, sizeof(filename), "log_%d.csv", record->entity_id);
 
@@ -290,15 +366,26 @@ static void write_log_record(const struct LogRecord* record) {
             action,
             extra);
 
+    // a full file becomes a sealed segment and the next record starts a new one
+    long size = ftell(log_file);
     fclose(log_file);
-    line_count++;
+    if (size >= LOG_SEGMENT_BYTES) segmentSeal(filename);
 
     // Short pause helps ensure successive logs receive distinct timestamps.
-    struct timespec pause = {0, 2 * 1000 * 1000}; // 2 ms
-    nanosleep(&pause, NULL);
+    // Skipped entirely in turbo mode.
+    if (log_time_scale > 0) {
+        // 2 ms at real time; slow-motion scales stretch it past a second
+        long long nsec = (long long)(2e6 / log_time_scale);
+        struct timespec pause = { (time_t)(nsec / 1000000000LL), (long)(nsec % 1000000000LL) };
+        nanosleep(&pause, NULL);
+    }
 }
 
+#if LOG_LEVEL >= LOG_LEVEL_ALL
 void log_move(int hunter_id, int boredom, int fear, const char* from_room, const char* to_room, enum EvidenceType device) {
+    if (!log_wanted(LOG_LEVEL_ALL)) return;
+    PROFILE_BEGIN(profileStart);
+
     struct LogRecord record = {
         .entity_type = LOG_ENTITY_HUNTER,
         .entity_id = hunter_id,
@@ -310,18 +397,27 @@ void log_move(int hunter_id, int boredom, int fear, const char* from_room, const
         .extra = to_room
     };
 
-    write_log_record(&record);
+    if (LOG_TO(LOG_SINK_CSV)) write_log_record(&record);
 
-    printf("Hunter %d using %s moved from %s to %s (bored=%d fear=%d)\n",
-           hunter_id,
-           evidence_to_string(device),
-           from_room ? from_room : "",
-           to_room ? to_room : "",
-           boredom,
-           fear);
+    if (LOG_TO(LOG_SINK_STDOUT)) {
+        printf("Hunter %d using %s moved from %s to %s (bored=%d fear=%d)\n",
+               hunter_id,
+               evidence_to_string(device),
+               from_room ? from_room : "",
+               to_room ? to_room : "",
+               boredom,
+               fear);
+    }
+
+    PROFILE_END(profileStart, PA_LOG_MOVE);
 }
+#endif
 
+#if LOG_LEVEL >= LOG_LEVEL_EVIDENCE
 void log_evidence(int hunter_id, int boredom, int fear, const char* room_name, enum EvidenceType device) {
+    if (!log_wanted(LOG_LEVEL_EVIDENCE)) return;
+    PROFILE_BEGIN(profileStart);
+
     const char* evidence = evidence_to_string(device);
     struct LogRecord record = {
         .entity_type = LOG_ENTITY_HUNTER,
@@ -334,17 +430,26 @@ void log_evidence(int hunter_id, int boredom, int fear, const char* room_name, e
         .extra = evidence
     };
 
-    write_log_record(&record);
+    if (LOG_TO(LOG_SINK_CSV)) write_log_record(&record);
+
+    if (LOG_TO(LOG_SINK_STDOUT)) {
+        printf("Hunter %d using %s gathered evidence in %s (bored=%d fear=%d)\n",
+               hunter_id,
+               evidence,
+               room_name ? room_name : "",
+               boredom,
+               fear);
+    }
 
-    printf("Hunter %d using %s gathered evidence in %s (bored=%d fear=%d)\n",
-           hunter_id,
-           evidence,
-           room_name ? room_name : "",
-           boredom,
-           fear);
+    PROFILE_END(profileStart, PA_LOG_EVIDENCE);
 }
+#endif
 
+#if LOG_LEVEL >= LOG_LEVEL_EVIDENCE
 void log_swap(int hunter_id, int boredom, int fear, enum EvidenceType from_device, enum EvidenceType to_device) {
+    if (!log_wanted(LOG_LEVEL_EVIDENCE)) return;
+    PROFILE_BEGIN(profileStart);
+
     char extra[64];
     const char* from_text = evidence_to_string(from_device);
     const char* to_text = evidence_to_string(to_device);
@@ -361,17 +466,26 @@ void log_swap(int hunter_id, int boredom, int fear, enum EvidenceType from_devic
         .extra = extra
     };
 
-    write_log_record(&record);
+    if (LOG_TO(LOG_SINK_CSV)) write_log_record(&record);
 
-    printf("Hunter %d swapped devices: %s -> %s (bored=%d fear=%d)\n",
-           hunter_id,
-           from_text,
-           to_text,
-           boredom,
-           fear);
+    if (LOG_TO(LOG_SINK_STDOUT)) {
+        printf("Hunter %d swapped devices: %s -> %s (bored=%d fear=%d)\n",
+               hunter_id,
+               from_text,
+               to_text,
+               boredom,
+               fear);
+    }
+
+    PROFILE_END(profileStart, PA_LOG_SWAP);
 }
+#endif
 
+#if LOG_LEVEL >= LOG_LEVEL_LIFECYCLE
 void log_exit(int hunter_id, int boredom, int fear, const char* room_name, enum EvidenceType device, enum LogReason reason) {
+    if (!log_wanted(LOG_LEVEL_LIFECYCLE)) return;
+    PROFILE_BEGIN(profileStart);
+
     const char* device_text = evidence_to_string(device);
     const char* reason_text = exit_reason_to_string(reason);
 
@@ -386,18 +500,27 @@ void log_exit(int hunter_id, int boredom, int fear, const char* room_name, enum
         .extra = reason_text
     };
 
-    write_log_record(&record);
+    if (LOG_TO(LOG_SINK_CSV)) write_log_record(&record);
 
-    printf("Hunter %d using %s exited at %s (reason=%s, bored=%d fear=%d)\n",
-           hunter_id,
-           device_text,
-           room_name ? room_name : "",
-           reason_text,
-           boredom,
-           fear);
+    if (LOG_TO(LOG_SINK_STDOUT)) {
+        printf("Hunter %d using %s exited at %s (reason=%s, bored=%d fear=%d)\n",
+               hunter_id,
+               device_text,
+               room_name ? room_name : "",
+               reason_text,
+               boredom,
+               fear);
+    }
+
+    PROFILE_END(profileStart, PA_LOG_EXIT);
 }
+#endif
 
+#if LOG_LEVEL >= LOG_LEVEL_EVIDENCE
 void log_return_to_van(int hunter_id, int boredom, int fear, const char* room_name, enum EvidenceType device, bool heading_home) {
+    if (!log_wanted(LOG_LEVEL_EVIDENCE)) return;
+    PROFILE_BEGIN(profileStart);
+
     const char* device_text = evidence_to_string(device);
     const char* extra = heading_home ? "start" : "complete";
     const char* action = heading_home ? "RETURN_START" : "RETURN_COMPLETE";
@@ -413,26 +536,35 @@ void log_return_to_van(int hunter_id, int boredom, int fear, const char* room_na
         .extra = extra
     };
 
-    write_log_record(&record);
+    if (LOG_TO(LOG_SINK_CSV)) write_log_record(&record);
 
-    if (heading_home) {
-        printf("Hunter %d using %s heading to van from %s (bored=%d fear=%d)\n",
-               hunter_id,
-               device_text,
-               room_name ? room_name : "",
-               boredom,
-               fear);
-    } else {
-        printf("Hunter %d using %s finished return at %s (bored=%d fear=%d)\n",
-               hunter_id,
-               device_text,
-               room_name ? room_name : "",
-               boredom,
-               fear);
+    if (LOG_TO(LOG_SINK_STDOUT)) {
+        if (heading_home) {
+            printf("Hunter %d using %s heading to van from %s (bored=%d fear=%d)\n",
+                   hunter_id,
+                   device_text,
+                   room_name ? room_name : "",
+                   boredom,
+                   fear);
+        } else {
+            printf("Hunter %d using %s finished return at %s (bored=%d fear=%d)\n",
+                   hunter_id,
+                   device_text,
+                   room_name ? room_name : "",
+                   boredom,
+                   fear);
+        }
     }
+
+    PROFILE_END(profileStart, PA_LOG_RETURN_TO_VAN);
 }
+#endif
 
+#if LOG_LEVEL >= LOG_LEVEL_LIFECYCLE
 void log_hunter_init(int hunter_id, const char* room_name, const char* hunter_name, enum EvidenceType device) {
+    if (!log_wanted(LOG_LEVEL_LIFECYCLE)) return;
+    PROFILE_BEGIN(profileStart);
+
     const char* device_text = evidence_to_string(device);
     struct LogRecord record = {
         .entity_type = LOG_ENTITY_HUNTER,
@@ -445,15 +577,24 @@ void log_hunter_init(int hunter_id, const char* room_name, const char* hunter_na
         .extra = hunter_name ? hunter_name : ""
     };
 
-    write_log_record(&record);
-    printf("Hunter %d (%s) initialized in %s with %s\n",
-           hunter_id,
-           hunter_name ? hunter_name : "unknown",
-           room_name ? room_name : "",
-           device_text);
+    if (LOG_TO(LOG_SINK_CSV)) write_log_record(&record);
+    if (LOG_TO(LOG_SINK_STDOUT)) {
+        printf("Hunter %d (%s) initialized in %s with %s\n",
+               hunter_id,
+               hunter_name ? hunter_name : "unknown",
+               room_name ? room_name : "",
+               device_text);
+    }
+
+    PROFILE_END(profileStart, PA_LOG_HUNTER_INIT);
 }
+#endif
 
+#if LOG_LEVEL >= LOG_LEVEL_LIFECYCLE
 void log_ghost_init(int ghost_id, const char* room_name, enum GhostType type) {
+    if (!log_wanted(LOG_LEVEL_LIFECYCLE)) return;
+    PROFILE_BEGIN(profileStart);
+
     const char* type_text = ghost_to_string(type);
     struct LogRecord record = {
         .entity_type = LOG_ENTITY_GHOST,
@@ -466,14 +607,23 @@ void log_ghost_init(int ghost_id, const char* room_name, enum GhostType type) {
         .extra = type_text
     };
 
-    write_log_record(&record);
-    printf("Ghost %d (%s) initialized in %s\n",
-           ghost_id,
-           type_text,
-           room_name ? room_name : "");
+    if (LOG_TO(LOG_SINK_CSV)) write_log_record(&record);
+    if (LOG_TO(LOG_SINK_STDOUT)) {
+        printf("Ghost %d (%s) initialized in %s\n",
+               ghost_id,
+               type_text,
+               room_name ? room_name : "");
+    }
+
+    PROFILE_END(profileStart, PA_LOG_GHOST_INIT);
 }
+#endif
 
+#if LOG_LEVEL >= LOG_LEVEL_ALL
 void log_ghost_move(int ghost_id, int boredom, const char* from_room, const char* to_room) {
+    if (!log_wanted(LOG_LEVEL_ALL)) return;
+    PROFILE_BEGIN(profileStart);
+
     struct LogRecord record = {
         .entity_type = LOG_ENTITY_GHOST,
         .entity_id = ghost_id,
@@ -485,16 +635,25 @@ void log_ghost_move(int ghost_id, int boredom, const char* from_room, const char
         .extra = to_room
     };
 
-    write_log_record(&record);
+    if (LOG_TO(LOG_SINK_CSV)) write_log_record(&record);
 
-    printf("Ghost %d [bored=%d] MOVE %s -> %s\n",
-           ghost_id,
-           boredom,
-           from_room ? from_room : "",
-           to_room ? to_room : "");
+    if (LOG_TO(LOG_SINK_STDOUT)) {
+        printf("Ghost %d [bored=%d] MOVE %s -> %s\n",
+               ghost_id,
+               boredom,
+               from_room ? from_room : "",
+               to_room ? to_room : "");
+    }
+
+    PROFILE_END(profileStart, PA_LOG_GHOST_MOVE);
 }
+#endif
 
+#if LOG_LEVEL >= LOG_LEVEL_EVIDENCE
 void log_ghost_evidence(int ghost_id, int boredom, const char* room_name, enum EvidenceType evidence) {
+    if (!log_wanted(LOG_LEVEL_EVIDENCE)) return;
+    PROFILE_BEGIN(profileStart);
+
     const char* evidence_text = evidence_to_string(evidence);
 
     struct LogRecord record = {
@@ -508,16 +667,25 @@ void log_ghost_evidence(int ghost_id, int boredom, const char* room_name, enum E
         .extra = evidence_text
     };
 
-    write_log_record(&record);
+    if (LOG_TO(LOG_SINK_CSV)) write_log_record(&record);
+
+    if (LOG_TO(LOG_SINK_STDOUT)) {
+        printf("Ghost %d [bored=%d] EVIDENCE %s in %s\n",
+               ghost_id,
+               boredom,
+               evidence_text,
+               room_name ? room_name : "");
+    }
 
-    printf("Ghost %d [bored=%d] EVIDENCE %s in %s\n",
-           ghost_id,
-           boredom,
-           evidence_text,
-           room_name ? room_name : "");
+    PROFILE_END(profileStart, PA_LOG_GHOST_EVIDENCE);
 }
+#endif
 
+#if LOG_LEVEL >= LOG_LEVEL_LIFECYCLE
 void log_ghost_exit(int ghost_id, int boredom, const char* room_name) {
+    if (!log_wanted(LOG_LEVEL_LIFECYCLE)) return;
+    PROFILE_BEGIN(profileStart);
+
     struct LogRecord record = {
         .entity_type = LOG_ENTITY_GHOST,
         .entity_id = ghost_id,
@@ -529,15 +697,24 @@ void log_ghost_exit(int ghost_id, int boredom, const char* room_name) {
         .extra = ""
     };
 
-    write_log_record(&record);
+    if (LOG_TO(LOG_SINK_CSV)) write_log_record(&record);
+
+    if (LOG_TO(LOG_SINK_STDOUT)) {
+        printf("Ghost %d [bored=%d] EXIT %s\n",
+               ghost_id,
+               boredom,
+               room_name ? room_name : "");
+    }
 
-    printf("Ghost %d [bored=%d] EXIT %s\n",
-           ghost_id,
-           boredom,
-           room_name ? room_name : "");
+    PROFILE_END(profileStart, PA_LOG_GHOST_EXIT);
 }
+#endif
 
+#if LOG_LEVEL >= LOG_LEVEL_ALL
 void log_ghost_idle(int ghost_id, int boredom, const char* room_name) {
+    if (!log_wanted(LOG_LEVEL_ALL)) return;
+    PROFILE_BEGIN(profileStart);
+
     struct LogRecord record = {
         .entity_type = LOG_ENTITY_GHOST,
         .entity_id = ghost_id,
@@ -549,314 +726,798 @@ void log_ghost_idle(int ghost_id, int boredom, const char* room_name) {
         .extra = ""
     };
 
-    write_log_record(&record);
+    if (LOG_TO(LOG_SINK_CSV)) write_log_record(&record);
 
-    printf("Ghost %d [bored=%d] IDLE in %s\n",
-           ghost_id,
-           boredom,
-           room_name ? room_name : "");
+    if (LOG_TO(LOG_SINK_STDOUT)) {
+        printf("Ghost %d [bored=%d] IDLE in %s\n",
+               ghost_id,
+               boredom,
+               room_name ? room_name : "");
+    }
+
+    PROFILE_END(profileStart, PA_LOG_GHOST_IDLE);
 }
+#endif
 
-void room_init(struct Room* room, const char* name, bool is_exit) {
-    strcpy(room->name, name); // copies name
-    room->is_exit = is_exit; // copies exit status
-    
-    room->numConnections = 0;
-    room->ghost = NULL;
-    room->numHunters = 0;
-    room->evidence = 0;
+#endif // LOG_LEVEL > LOG_LEVEL_NONE
+
+void log_event_flush(const struct LogEvent* event) {
+    switch (event->type) {
+        case LE_MOVE:
+            log_move(event->id, event->boredom, event->fear, event->from, event->to, event->device);
+            break;
+        case LE_EVIDENCE:
+            log_evidence(event->id, event->boredom, event->fear, event->from, event->device);
+            break;
+        case LE_GHOST_MOVE:
+            log_ghost_move(event->id, event->boredom, event->from, event->to);
+            break;
+        case LE_NONE:
+        default:
+            break;
+    }
+}
+
+void room_init(struct RoomLayout* layout, RoomId id, const char* name, bool is_exit) {
+    strcpy(layout->names[id], name); // copies name
+    layout->isExit[id] = is_exit; // copies exit status
+    layout->numConnections[id] = 0;
 
     // create space for connected rooms
     for (int i = 0; i < MAX_CONNECTIONS; i++) {
-        room->connectedRooms[i] = NULL;
+        layout->connected[id][i] = ROOM_NONE;
     }
+}
+
+void room_connect(struct RoomLayout* layout, RoomId a, RoomId b) { // Bidirectional connection
+    if (layout->numConnections[a] == MAX_CONNECTIONS || layout->numConnections[b] == MAX_CONNECTIONS) return; // check connections capacity
 
-    // create space for hunters
-    for (int i = 0; i < MAX_ROOM_OCCUPANCY; i++) {
-        room->hunters[i] = NULL;
+    // check for duplicate rooms
+    for (int i = 0; i < layout->numConnections[a]; i++) {
+        if (layout->connected[a][i] == b) return;
     }
 
-    sem_init(&room->mutex, 0, 1);
+    layout->connected[a][layout->numConnections[a]++] = b;
+    layout->connected[b][layout->numConnections[b]++] = a;
 }
 
-void room_connect(struct Room* a, struct Room* b) { // Bidirectional connection
-    if (a->numConnections == MAX_CONNECTIONS || b->numConnections == MAX_CONNECTIONS) return; // check connections capacity
+// ---- Room locks ----
 
-    // check for duplicate rooms
-    for (int i = 0; i < a->numConnections; i++) {
-        if (a->connectedRooms[i] == b) return;
+// Per-thread counters, merged into the House when the entity thread exits
+static _Thread_local struct LockStats threadLockStats;
+static bool lock_timing_enabled = false;
+
+void lock_timing_set_enabled(bool enabled) {
+    lock_timing_enabled = enabled;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// the name is parenthesized so the LOCK_DEBUG call-site macro in helpers.h doesn't expand here
+void (roomLock)(struct Room *room) {
+    LOCK_TRACE_WAIT_CALLER(&room->mutex, LC_ROOM, room->id);
+    PROFILE_BEGIN(profileStart);
+    threadLockStats.acquires++;
+
+    // uncontended fast path costs nothing extra
+    if (sem_trywait(&room->mutex) != 0) {
+        threadLockStats.contended++;
+        if (!lock_timing_enabled) {
+            sem_wait(&room->mutex);
+        }
+        else {
+            uint64_t start = now_ns();
+            sem_wait(&room->mutex);
+            uint64_t waited = now_ns() - start;
+            threadLockStats.waitNs += waited;
+            threadLockStats.roomWaitNs[room->id] += waited;
+        }
     }
+    LOCK_TRACE_ACQUIRED(&room->mutex);
+    PROFILE_END(profileStart, PA_ROOM_LOCK);
+}
 
-    a->connectedRooms[a->numConnections] = b;
-    b->connectedRooms[b->numConnections] = a;
-    a->numConnections++;
-    b->numConnections++;
+void roomUnlock(struct Room *room) {
+    SEM_UNLOCK(&room->mutex);
 }
 
-void lockRooms(struct Room *r1, struct Room *r2) {
+void lockStatsFlush(struct House *house) {
+    MUTEX_LOCK(&house->statsMutex, LC_STATS, -1);
+    house->lockStats.acquires += threadLockStats.acquires;
+    house->lockStats.contended += threadLockStats.contended;
+    house->lockStats.waitNs += threadLockStats.waitNs;
+    for (int i = 0; i < house->layout->roomCount; i++) {
+        house->lockStats.roomWaitNs[i] += threadLockStats.roomWaitNs[i];
+    }
+    MUTEX_UNLOCK(&house->statsMutex);
+    memset(&threadLockStats, 0, sizeof(threadLockStats));
+}
+
+// ---- Room activity ----
+
+// Per-thread counters, merged like threadLockStats; never touched by another thread
+static _Thread_local struct RoomStats threadRoomStats;
+
+void room_stats_add(struct RoomStats *to, const struct RoomStats *from, int roomCount) {
+    for (int i = 0; i < roomCount; i++) {
+        to->rooms[i].hunterVisits += from->rooms[i].hunterVisits;
+        to->rooms[i].hunterDwell += from->rooms[i].hunterDwell;
+        to->rooms[i].pickups += from->rooms[i].pickups;
+        to->rooms[i].ghostVisits += from->rooms[i].ghostVisits;
+        to->rooms[i].ghostDwell += from->rooms[i].ghostDwell;
+        to->rooms[i].haunts += from->rooms[i].haunts;
+    }
+}
+
+void roomStatsFlush(struct House *house) {
+    MUTEX_LOCK(&house->statsMutex, LC_STATS, -1);
+    room_stats_add(&house->roomStats, &threadRoomStats, house->layout->roomCount);
+    MUTEX_UNLOCK(&house->statsMutex);
+    memset(threadRoomStats.rooms, 0, (size_t)house->layout->roomCount * sizeof(threadRoomStats.rooms[0]));
+}
+
+void room_stats_print(const struct House *house, const struct RoomStats *stats) {
+    uint32_t peak = 1;
+    for (int i = 0; i < house->layout->roomCount; i++) {
+        uint32_t dwell = stats->rooms[i].hunterDwell + stats->rooms[i].ghostDwell;
+        if (dwell > peak) peak = dwell;
+    }
+
+    printf("%-20s %8s %8s %8s %8s %8s %8s  %s\n",
+           "room", "h.visits", "h.ticks", "pickups", "g.visits", "g.ticks", "haunts", "activity");
+    for (int i = 0; i < house->layout->roomCount; i++) {
+        const struct RoomCounters *room = &stats->rooms[i];
+        char bar[31];
+        int width = (int)(30ull * (room->hunterDwell + room->ghostDwell) / peak);
+        memset(bar, '#', (size_t)width);
+        bar[width] = '\0';
+        printf("%-20s %8u %8u %8u %8u %8u %8u  %s\n", room_name(house, (RoomId)i),
+               room->hunterVisits, room->hunterDwell, room->pickups,
+               room->ghostVisits, room->ghostDwell, room->haunts, bar);
+    }
+}
+
+void (lockRooms)(struct Room *r1, struct Room *r2) {
+    PROFILE_BEGIN(profileStart);
     if (r1 == r2) {
-        sem_wait(&r1->mutex);
-        return;
+        roomLock(r1);
     }
 
-    if ((uintptr_t)r1 < (uintptr_t)r2) {
-        sem_wait(&r1->mutex);
-        sem_wait(&r2->mutex);
+    else if ((uintptr_t)r1 < (uintptr_t)r2) {
+        roomLock(r1);
+        roomLock(r2);
     }
 
     else {
-        sem_wait(&r2->mutex);
-        sem_wait(&r1->mutex);
+        roomLock(r2);
+        roomLock(r1);
     }
+    PROFILE_END(profileStart, PA_LOCK_ROOMS);
 }
 
 void unlockRooms(struct Room *r1, struct Room *r2) {
     if (r1 == r2) {
-        sem_post(&r1->mutex);
+        roomUnlock(r1);
         return;
     }
 
     if ((uintptr_t)r1 < (uintptr_t)r2) {
-        sem_post(&r2->mutex);
-        sem_post(&r1->mutex);
+        roomUnlock(r2);
+        roomUnlock(r1);
     }
 
     else {
-        sem_post(&r1->mutex);
-        sem_post(&r2->mutex);
+        roomUnlock(r1);
+        roomUnlock(r2);
     }
 }
 
 void huntersResize(struct House* house, int* capacity) {
     *capacity *= 2;
-    struct Hunter** newArr = realloc(house->hunters, sizeof(struct Hunter*) * (*capacity));
+
+    // the old arrays stay in the arena until the end-of-run reset
+    struct Hunter* newArr = arenaAlloc(&house->arena, sizeof(struct Hunter) * (*capacity), CACHE_LINE);
+    memcpy(newArr, house->hunters, sizeof(struct Hunter) * house->hunterCount);
     house->hunters = newArr;
+
+    struct HunterInfo* newInfo = arenaAlloc(&house->arena, sizeof(struct HunterInfo) * (*capacity), _Alignof(struct HunterInfo));
+    memcpy(newInfo, house->hunterInfo, sizeof(struct HunterInfo) * house->hunterCount);
+    house->hunterInfo = newInfo;
+}
+
+// ---- House phase ----
+void houseControlInit(struct HouseControl* control, enum EndPolicy policy) {
+    control->phase = PHASE_INVESTIGATING;
+    control->policy = policy;
+    control->tickUsec = DEFAULT_TICK_USEC;
+    control->timeScale = 1.0;
+    pthread_mutex_init(&control->mutex, NULL);
+    pthread_cond_init(&control->wake, NULL);
+}
+
+enum HousePhase houseGetPhase(struct HouseControl* control) {
+    MUTEX_LOCK(&control->mutex, LC_CONTROL, -1);
+    enum HousePhase phase = control->phase;
+    MUTEX_UNLOCK(&control->mutex);
+    return phase;
+}
+
+void houseSetPhase(struct HouseControl* control, enum HousePhase phase) {
+    MUTEX_LOCK(&control->mutex, LC_CONTROL, -1);
+    if (phase > control->phase) {
+        control->phase = phase;
+        pthread_cond_broadcast(&control->wake);
+    }
+    MUTEX_UNLOCK(&control->mutex);
+}
+
+// One scaled tick from now, as an absolute CLOCK_REALTIME deadline for pthread_cond_timedwait
+static void houseTickDeadline(const struct HouseControl* control, struct timespec* deadline) {
+    long usec = (long)(control->tickUsec / control->timeScale);
+    clock_gettime(CLOCK_REALTIME, deadline);
+    deadline->tv_sec += usec / 1000000;
+    deadline->tv_nsec += (usec % 1000000) * 1000;
+    if (deadline->tv_nsec >= 1000000000L) {
+        deadline->tv_sec++;
+        deadline->tv_nsec -= 1000000000L;
+    }
+}
+
+// Sleep one tick, returning early on a phase change or once *signal is set (NULL for none).
+// The signal is read and cleared under control->mutex; returns whether it was set.
+static bool houseTickWait(struct HouseControl* control, bool* signal) {
+    struct timespec deadline;
+    bool paced = control->timeScale > 0;
+    if (paced) {
+        houseTickDeadline(control, &deadline);
+    } else {
+        // turbo: no pacing, just give the other entities a chance to run
+        sched_yield();
+        if (signal == NULL) return false;
+    }
+
+    MUTEX_LOCK(&control->mutex, LC_CONTROL, -1);
+    enum HousePhase start = control->phase;
+    while (paced && control->phase == start && !(signal && *signal)) {
+        // the wait drops and retakes the mutex
+        LOCK_TRACE_RELEASE(&control->mutex);
+        int rc = pthread_cond_timedwait(&control->wake, &control->mutex, &deadline);
+        LOCK_TRACE_WAIT(&control->mutex, LC_CONTROL, -1);
+        LOCK_TRACE_ACQUIRED(&control->mutex);
+        if (rc == ETIMEDOUT) break;
+    }
+    bool signalled = signal && *signal;
+    if (signalled) *signal = false;
+    MUTEX_UNLOCK(&control->mutex);
+    return signalled;
+}
+
+// Set or clear a flag a houseTickWait may be waiting on; setting it wakes the sleepers
+static void houseSignal(struct HouseControl* control, bool* signal, bool value) {
+    MUTEX_LOCK(&control->mutex, LC_CONTROL, -1);
+    *signal = value;
+    if (value) pthread_cond_broadcast(&control->wake);
+    MUTEX_UNLOCK(&control->mutex);
+}
+
+void houseTickSleep(struct HouseControl* control) {
+    houseTickWait(control, NULL);
+}
+
+bool time_scale_from_string(const char* text, double* scale) {
+    if (strcmp(text, "turbo") == 0) {
+        *scale = 0;
+        return true;
+    }
+
+    char* end;
+    double value = strtod(text, &end);
+    if (end == text || *end != '\0' || !(value >= TIME_SCALE_MIN)) return false;
+    *scale = value;
+    return true;
+}
+
+bool end_policy_from_string(const char* text, enum EndPolicy* policy) {
+    if (strcmp(text, "natural") == 0) *policy = END_NATURAL;
+    else if (strcmp(text, "solved") == 0) *policy = END_WHEN_SOLVED;
+    else if (strcmp(text, "ghost-exit") == 0) *policy = END_WHEN_GHOST_EXITS;
+    else return false;
+    return true;
 }
 
 void ghostIdle(struct Ghost *ghost) {
-    pthread_mutex_lock(&ghost->boredom_mutex);
+    MUTEX_LOCK(&ghost->boredom_mutex, LC_GHOST, -1);
     int current_boredom = ghost->boredom;
-    pthread_mutex_unlock(&ghost->boredom_mutex);
-    log_ghost_idle(ghost->id, current_boredom, ghost->room->name);
+    MUTEX_UNLOCK(&ghost->boredom_mutex);
+    log_ghost_idle(ghost->id, current_boredom, room_name(ghost->house, ghost->room));
 }
 
 void ghostHaunt(struct Ghost *ghost) {
     enum EvidenceType ev = get_random_evidence(ghost->type);
+    struct Room *room = &ghost->house->rooms[ghost->room];
 
-    sem_wait(&ghost->room->mutex);
+    roomLock(room);
 
     // Only add if the evidence isn't already there
-    if (!(ghost->room->evidence & ev)) {
-        ghost->room->evidence |= ev;
-        sem_post(&ghost->room->mutex);
+    if (!(room->evidence & ev)) {
+        room->evidence |= ev;
+        roomUnlock(room);
+        threadRoomStats.rooms[ghost->room].haunts++;
+        LIVE_ADD(ghost->house->live, evidenceDropped, 1);
 
-        pthread_mutex_lock(&ghost->boredom_mutex);
+        MUTEX_LOCK(&ghost->boredom_mutex, LC_GHOST, -1);
         int current_boredom = ghost->boredom;
-        pthread_mutex_unlock(&ghost->boredom_mutex);
+        MUTEX_UNLOCK(&ghost->boredom_mutex);
 
-        log_ghost_evidence(ghost->id, current_boredom, ghost->room->name, ev);
+        log_ghost_evidence(ghost->id, current_boredom, room_name(ghost->house, ghost->room), ev);
     } else {
-        sem_post(&ghost->room->mutex);
+        roomUnlock(room);
     }
 }
 
 void ghostMove(struct Ghost *ghost) {
-    sem_wait(&ghost->room->mutex);
-    struct Room *oldRoom = ghost->room;
-    int count = oldRoom->numConnections;
+    struct House *house = ghost->house;
+    RoomId oldId = ghost->room;
+    int count = house->layout->numConnections[oldId]; // adjacency is read-only, no lock needed
 
-    if (count == 0) {
-        sem_post(&oldRoom->mutex);
-        return;
-    }
+    if (count == 0) return;
 
     int index = rand_int_threadsafe(0, count);
-    struct Room *newRoom = oldRoom->connectedRooms[index];
-    sem_post(&oldRoom->mutex);
-    lockRooms(oldRoom, newRoom);
+    RoomId newId = house->layout->connected[oldId][index];
+    struct Room *oldRoom = &house->rooms[oldId];
+    struct Room *newRoom = &house->rooms[newId];
 
-    if (ghost->room == oldRoom) {
-        newRoom->ghost = ghost;
-        oldRoom->ghost = NULL;
-        ghost->room = newRoom;
+    struct LogEvent event = { .type = LE_NONE };
+    lockRooms(oldRoom, newRoom);
 
-        pthread_mutex_lock(&ghost->boredom_mutex);
-        int current_boredom = ghost->boredom;
-        pthread_mutex_unlock(&ghost->boredom_mutex);
-        log_ghost_move(ghost->id, current_boredom, oldRoom->name, newRoom->name);
+    if (ghost->room == oldId) {
+        newRoom->hasGhost = true;
+        oldRoom->hasGhost = false;
+        ghost->room = newId;
+        threadRoomStats.rooms[newId].ghostVisits++;
+        LIVE_SET(house->live, ghostRoom, newId);
+        LOG_EVENT(LOG_LEVEL_ALL, event, .type = LE_GHOST_MOVE, .id = ghost->id, .from = room_name(house, oldId), .to = room_name(house, newId));
     }
     unlockRooms(oldRoom, newRoom);
+
+    if (event.type != LE_NONE) {
+        MUTEX_LOCK(&ghost->boredom_mutex, LC_GHOST, -1);
+        event.boredom = ghost->boredom;
+        MUTEX_UNLOCK(&ghost->boredom_mutex);
+    }
+    log_event_flush(&event);
 }
 
 enum EvidenceType get_random_evidence(enum GhostType ghostType) {
-    const enum EvidenceType* all;
-    int total = get_all_evidence_types(&all);  // gives pointer + count
-
-    enum EvidenceType possible[3];
-    int count = 0;
-
-    // collect only the evidence bits that match this ghost type
-    for (int i = 0; i < total; i++) {
-        if (ghostType & all[i]) {
-            possible[count++] = all[i];
-        }
-    }
+    // one of the ghost's 3 evidence types
+    if (!evidence_is_valid_ghost((EvidenceByte)ghostType)) return EV_EMF;
+    return ghostEvidence[ghostType][rand_int_threadsafe(0, 3)];
+}
 
-    // randomly choose one of the 3 allowed evidence types
-    if (count == 0) return EV_EMF;
-    int idx = rand_int_threadsafe(0, count);
-    return possible[idx];
+// Clear the ghost from its room so hunters there stop gaining fear
+static void ghostLeave(struct Ghost *ghost) {
+    struct Room *room = &ghost->house->rooms[ghost->room];
+    roomLock(room);
+    room->hasGhost = false;
+    roomUnlock(room);
+    LIVE_SET(ghost->house->live, ghostRoom, ROOM_NONE);
 }
 
-void *ghostFunction(void *arg) {
-    struct Ghost *ghost = (struct Ghost *)arg;
+static void ghostLoop(struct Ghost *ghost) {
+    struct HouseControl *control = &ghost->house->control;
     int choice;
     while (!ghost->exited) {
+        ghost->ticks++;
+        threadRoomStats.rooms[ghost->room].ghostDwell++;
+        LIVE_ADD(ghost->house->live, ghostTicks, 1);
+
+        // the investigation was ended for everyone
+        if (houseGetPhase(control) == PHASE_ENDED) {
+            MUTEX_LOCK(&ghost->boredom_mutex, LC_GHOST, -1);
+            ghost->exited = true;
+            int final_boredom = ghost->boredom;
+            MUTEX_UNLOCK(&ghost->boredom_mutex);
+            ghostLeave(ghost);
+            log_ghost_exit(ghost->id, final_boredom, room_name(ghost->house, ghost->room));
+            break;
+        }
+
         // protect access to numHunters
-        sem_wait(&ghost->room->mutex);
-        int huntersInRoom = ghost->room->numHunters;
-        sem_post(&ghost->room->mutex);
+        struct Room *room = &ghost->house->rooms[ghost->room];
+        roomLock(room);
+        int huntersInRoom = room->numHunters;
+        roomUnlock(room);
         
         // at least 1 hunter in the room
         if (huntersInRoom > 0) {
-            pthread_mutex_lock(&ghost->boredom_mutex);
+            MUTEX_LOCK(&ghost->boredom_mutex, LC_GHOST, -1);
             ghost->boredom = 0;
-            pthread_mutex_unlock(&ghost->boredom_mutex);
+            MUTEX_UNLOCK(&ghost->boredom_mutex);
             choice = rand_int_threadsafe(1, 3); // range 1-2 because ghost cannot move
         }
         
         // no hunters in the room
         else {
-            pthread_mutex_lock(&ghost->boredom_mutex);
+            MUTEX_LOCK(&ghost->boredom_mutex, LC_GHOST, -1);
             ghost->boredom++;
-            int current_boredom = ghost->boredom;
-            pthread_mutex_unlock(&ghost->boredom_mutex);
+            MUTEX_UNLOCK(&ghost->boredom_mutex);
             choice = rand_int_threadsafe(1, 4); // range 1-3
         }
         
-        pthread_mutex_lock(&ghost->boredom_mutex);
-        bool shouldExit = (ghost->boredom > ENTITY_BOREDOM_MAX);
+        MUTEX_LOCK(&ghost->boredom_mutex, LC_GHOST, -1);
+        LIVE_SET(ghost->house->live, ghostBoredom, ghost->boredom);
+        bool shouldExit = (ghost->boredom > ghost->house->boredomMax);
         if (shouldExit) {
             ghost->exited = true;
             int final_boredom = ghost->boredom;
-            pthread_mutex_unlock(&ghost->boredom_mutex);
-            log_ghost_exit(ghost->id, final_boredom, ghost->room->name);
+            MUTEX_UNLOCK(&ghost->boredom_mutex);
+            ghostLeave(ghost);
+            log_ghost_exit(ghost->id, final_boredom, room_name(ghost->house, ghost->room));
+
+            // nothing left to investigate, send the hunters home
+            if (control->policy == END_WHEN_GHOST_EXITS) {
+                houseSetPhase(control, PHASE_RETURNING);
+            }
             break;
         }
-        pthread_mutex_unlock(&ghost->boredom_mutex);
+        MUTEX_UNLOCK(&ghost->boredom_mutex);
 
         // otherwise continue
+        PROFILE_BEGIN(profileStart);
         switch (choice)
         {
             case 1: // ghost idles
                 ghostIdle(ghost);
+                PROFILE_END(profileStart, PA_GHOST_IDLE);
                 break;
             case 2: // ghost haunts
                 ghostHaunt(ghost);
+                PROFILE_END(profileStart, PA_GHOST_HAUNT);
                 break;
             case 3: // ghost moves
                 ghostMove(ghost);
+                PROFILE_END(profileStart, PA_GHOST_MOVE);
                 break;
         }
-        usleep(100 * 1000);
+        houseTickSleep(control);
     }
+}
+
+// Seed this entity thread's RNG from the House seed so a run can be reproduced
+static void entitySeed(struct House *house, int index) {
+    if (house->seed != 0) {
+        rand_seed_threadsafe(house->seed ^ (unsigned)(index + 1) * 0x9E3779B9u);
+    }
+}
+
+void *ghostFunction(void *arg) {
+    struct Ghost *ghost = (struct Ghost *)arg;
+    LOCK_TRACE_THREAD("ghost %d", ghost->id);
+    entitySeed(ghost->house, -1);
+    pthread_barrier_wait(&ghost->house->startGate);
+    ghostLoop(ghost);
+    lockStatsFlush(ghost->house);
+    roomStatsFlush(ghost->house);
+    profileFlush();
     return NULL;
 }
 
+bool roomHasSpace(const struct House *house, const struct Room *room) {
+    if (house->layout->isExit[room->id]) return true;
+    // reserved slots and queued hunters come before newcomers
+    return room->waitHead == ADMISSION_NONE && room->numHunters + room->reserved < house->maxOccupancy;
+}
+
+// ---- Room admission ----
+
+// Caller holds the room lock. Reserve free slots for the front of the queue and wake those hunters.
+static void admissionGrant(struct House *house, struct Room *room) {
+    while (room->waitHead != ADMISSION_NONE && room->numHunters + room->reserved < house->maxOccupancy) {
+        struct Hunter *next = &house->hunters[room->waitHead];
+        room->waitHead = next->waitNext;
+        if (room->waitHead == ADMISSION_NONE) room->waitTail = ADMISSION_NONE;
+        next->waitNext = ADMISSION_NONE;
+        next->admitted = true;
+        room->reserved++;
+        houseSignal(&house->control, &next->admitSignal, true);
+    }
+}
+
+// Caller holds the room lock
+static void admissionEnqueue(struct Hunter *hunter, struct Room *room) {
+    struct Hunter *hunters = hunter->house->hunters;
+    uint16_t index = (uint16_t)(hunter - hunters);
+
+    hunter->waitingFor = room->id;
+    hunter->admitted = false;
+    hunter->waitTicks = 0;
+    hunter->waitNext = ADMISSION_NONE;
+    if (room->waitTail == ADMISSION_NONE) room->waitHead = index;
+    else hunters[room->waitTail].waitNext = index;
+    room->waitTail = index;
+}
+
+// Caller holds the room lock
+static bool hunterCanEnter(const struct Hunter *hunter, const struct Room *room) {
+    return (hunter->waitingFor == room->id && hunter->admitted) || roomHasSpace(hunter->house, room);
+}
+
+void hunterCancelAdmission(struct Hunter *hunter) {
+    if (hunter->waitingFor == ROOM_NONE) return;
+    struct House *house = hunter->house;
+    struct Room *room = &house->rooms[hunter->waitingFor];
+
+    roomLock(room);
+    if (hunter->admitted) {
+        // the slot goes to whoever is next
+        room->reserved--;
+        hunter->admitted = false;
+        houseSignal(&house->control, &hunter->admitSignal, false);
+        admissionGrant(house, room);
+    } else {
+        uint16_t index = (uint16_t)(hunter - house->hunters);
+        uint16_t prev = ADMISSION_NONE;
+        for (uint16_t at = room->waitHead; at != ADMISSION_NONE; prev = at, at = house->hunters[at].waitNext) {
+            if (at != index) continue;
+            if (prev == ADMISSION_NONE) room->waitHead = hunter->waitNext;
+            else house->hunters[prev].waitNext = hunter->waitNext;
+            if (room->waitTail == index) room->waitTail = prev;
+            break;
+        }
+        hunter->waitNext = ADMISSION_NONE;
+    }
+    hunter->waitingFor = ROOM_NONE;
+    roomUnlock(room);
+}
+
+// Spend a tick waiting on a queued admission instead of sleeping; gives up the place after ADMISSION_MAX_WAIT_TICKS.
+// Waits on the control cond var, so a phase change wakes a queued hunter as it wakes a sleeping one.
+static void hunterWaitAdmission(struct Hunter *hunter) {
+    bool woken = houseTickWait(&hunter->house->control, &hunter->admitSignal);
+
+    if (!woken && ++hunter->waitTicks > ADMISSION_MAX_WAIT_TICKS) {
+        hunterCancelAdmission(hunter);
+    }
+}
+
+static void hunterTickSleep(struct Hunter *hunter) {
+    if (hunter->waitingFor != ROOM_NONE) hunterWaitAdmission(hunter);
+    else houseTickSleep(&hunter->house->control);
+}
+
 void hunterRemove(struct Hunter *hunter, struct Room *room) {
     if (!room) return;
-    
+
     // Room mutex should already be locked by caller (lockRooms)
-    for (int i = 0; i < room->numHunters; i++) {
-        if (hunter == room->hunters[i]) {
-            // Shift array to remove the hunter
-            for (int j = i; j < room->numHunters - 1; j++) {
-                room->hunters[j] = room->hunters[j + 1];
-            }
-            room->hunters[room->numHunters - 1] = NULL;
-            room->numHunters--;
-            hunter->room = NULL;
-            return;
-        }
+    struct Hunter *hunters = hunter->house->hunters;
+    int slot = hunter->roomSlot;
+    if (slot < 0 || slot >= room->numHunters || &hunters[room->hunters[slot]] != hunter) return;
+
+    // Swap the last hunter into the freed slot instead of shifting the array
+    int last = room->numHunters - 1;
+    if (slot != last) {
+        room->hunters[slot] = room->hunters[last];
+        hunters[room->hunters[slot]].roomSlot = slot;
     }
+    room->numHunters--;
+    hunter->roomSlot = -1;
+    hunter->room = ROOM_NONE;
+
+    admissionGrant(hunter->house, room);
 }
 
 void hunterAdd(struct Hunter *hunter, struct Room *room) {
     if (!room) return;
     
     // Room mutex should already be locked by caller (lockRooms)
-    if (room->numHunters < MAX_ROOM_OCCUPANCY) {
-        room->hunters[room->numHunters] = hunter;
-        room->numHunters++;
-        hunter->room = room;
+    if (hunter->waitingFor == room->id && hunter->admitted) {
+        // take the slot reserved by admissionGrant
+        room->reserved--;
+        hunter->admitted = false;
+        hunter->waitingFor = ROOM_NONE;
+        houseSignal(&hunter->house->control, &hunter->admitSignal, false);
     }
+    else if (!roomHasSpace(hunter->house, room)) return;
+
+    hunter->roomSlot = room->numHunters;
+    room->hunters[room->numHunters] = (uint16_t)(hunter - hunter->house->hunters);
+    room->numHunters++;
+    hunter->room = room->id;
 }
 
-void hunterMove(struct Hunter *hunter) {
-    struct Room *oldRoom = hunter->room;
+void hunterLeave(struct Hunter *hunter) {
+    hunterCancelAdmission(hunter);
+    if (hunter->room == ROOM_NONE) return;
+    struct Room *room = &hunter->house->rooms[hunter->room];
 
-    sem_wait(&oldRoom->mutex);
-    int connections = oldRoom->numConnections;
-    sem_post(&oldRoom->mutex);
+    roomLock(room);
+    hunterRemove(hunter, room);
+    roomUnlock(room);
+}
 
-    int index = rand_int_threadsafe(0, connections);
-    struct Room *newRoom = oldRoom->connectedRooms[index];
+void hunterMove(struct Hunter *hunter) {
+    struct House *house = hunter->house;
+    RoomId oldId = hunter->room;
+    int connections = house->layout->numConnections[oldId]; // adjacency is read-only, no lock needed
+
+    // a queued hunter keeps its target so it doesn't lose its place
+    RoomId newId = hunter->waitingFor;
+    if (newId == ROOM_NONE) {
+        newId = house->layout->connected[oldId][rand_int_threadsafe(0, connections)];
+    }
+    struct Room *oldRoom = &house->rooms[oldId];
+    struct Room *newRoom = &house->rooms[newId];
 
+    bool moved = false;
+    struct LogEvent event = { .type = LE_NONE };
     lockRooms(oldRoom, newRoom);
 
-    if (newRoom->numHunters < MAX_ROOM_OCCUPANCY) {
-        stackPush(&hunter->path, oldRoom);
-        log_move(hunter->id, hunter->boredom, hunter->fear, oldRoom->name, newRoom->name, hunter->device);
+    if (hunterCanEnter(hunter, newRoom)) {
         hunterRemove(hunter, oldRoom);
         hunterAdd(hunter, newRoom);
-        
+        hunter->moves++;
+        threadRoomStats.rooms[newId].hunterVisits++;
+        LIVE_ADD(house->live, moves, 1);
+        moved = true;
+        LOG_EVENT(LOG_LEVEL_ALL, event, .type = LE_MOVE, .id = hunter->id, .boredom = hunter->boredom, .fear = hunter->fear,
+                  .from = room_name(house, oldId), .to = room_name(house, newId), .device = hunter->device);
+    }
+    else if (hunter->waitingFor == ROOM_NONE) {
+        admissionEnqueue(hunter, newRoom);
     }
 
     unlockRooms(oldRoom, newRoom);
+
+    // the path is only touched by this hunter, so it doesn't need the room locks
+    if (moved) {
+        stackPush(&hunter->path, oldId);
+    }
+    log_event_flush(&event);
+}
+
+// ---- Arena ----
+static struct ArenaBlock* arenaBlockNew(size_t size) {
+    struct ArenaBlock* block = aligned_alloc(CACHE_LINE, (sizeof(struct ArenaBlock) + size + CACHE_LINE - 1) & ~(size_t)(CACHE_LINE - 1));
+    if (block == NULL) {
+        // every house allocation comes through here; nothing can run without it
+        fprintf(stderr, "arena: out of memory allocating a %zu-byte block\n", size);
+        exit(1);
+    }
+    block->next = NULL;
+    block->size = size;
+    block->used = 0;
+    return block;
+}
+
+void arenaInit(struct Arena* arena, size_t capacity) {
+    arena->head = arenaBlockNew(capacity);
+    arena->current = arena->head;
+    pthread_mutex_init(&arena->mutex, NULL);
+}
+
+void* arenaAlloc(struct Arena* arena, size_t size, size_t align) {
+    MUTEX_LOCK(&arena->mutex, LC_ARENA, -1);
+
+    struct ArenaBlock* block = arena->current;
+    size_t offset = (block->used + align - 1) & ~(align - 1);
+
+    while (offset + size > block->size) {
+        // reuse a block kept from an earlier run, otherwise chain a new one
+        if (block->next == NULL) {
+            size_t next_size = block->size > size ? block->size : size;
+            block->next = arenaBlockNew(next_size);
+        }
+        block = block->next;
+        block->used = 0;
+        offset = 0;
+    }
+
+    block->used = offset + size;
+    arena->current = block;
+    MUTEX_UNLOCK(&arena->mutex);
+    return block->data + offset;
+}
+
+void arenaReset(struct Arena* arena) {
+    MUTEX_LOCK(&arena->mutex, LC_ARENA, -1);
+    arena->head->used = 0;
+    arena->current = arena->head;
+    MUTEX_UNLOCK(&arena->mutex);
 }
 
-void stackInit(struct RoomStack *stack) {
+void arenaDestroy(struct Arena* arena) {
+    struct ArenaBlock* block = arena->head;
+    while (block != NULL) {
+        struct ArenaBlock* next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->head = NULL;
+    arena->current = NULL;
+    pthread_mutex_destroy(&arena->mutex);
+}
+
+void stackInit(struct RoomStack *stack, struct Arena *arena) {
     stack->head = NULL;
+    stack->freeNodes = NULL;
+    stack->arena = arena;
 }
 
-void stackPush(struct RoomStack *stack, struct Room *room) {
-    struct RoomNode *node = malloc(sizeof(struct RoomNode));
+void stackPush(struct RoomStack *stack, RoomId room) {
+    struct RoomNode *node = stack->freeNodes;
+    if (node != NULL) {
+        stack->freeNodes = node->next;
+    } else {
+        node = arenaAlloc(stack->arena, sizeof(struct RoomNode), _Alignof(struct RoomNode));
+    }
     node->room = room;
     node->next = stack->head;
     stack->head = node;
 }
 
-struct Room* stackPop(struct RoomStack *stack) {
-    if (stack->head == NULL) return NULL;
+RoomId stackPop(struct RoomStack *stack) {
+    if (stack->head == NULL) return ROOM_NONE;
 
     struct RoomNode *node = stack->head;
     stack->head = node->next;
 
-    struct Room *room = node->room;
-    free(node);
+    RoomId room = node->room;
+    node->next = stack->freeNodes;
+    stack->freeNodes = node;
     return room;
 }
 
-struct Room* stackPeek(struct RoomStack *stack) {
-    if (stack->head == NULL) return NULL;
+RoomId stackPeek(struct RoomStack *stack) {
+    if (stack->head == NULL) return ROOM_NONE;
     return stack->head->room;
 }
 
 void stackClear(struct RoomStack *stack) {
-    while (stackPop(stack) != NULL);
+    while (stackPop(stack) != ROOM_NONE);
 }
 
-void *hunterFunction(void *arg) {
-    struct Hunter *hunter = arg;
+static bool casefileSolved(struct CaseFile *casefile) {
+    SEM_LOCK(&casefile->mutex, LC_CASEFILE, -1);
+    bool solved = casefile->solved;
+    SEM_UNLOCK(&casefile->mutex);
+    return solved;
+}
+
+static void hunterExit(struct Hunter *hunter, enum LogReason reason, int boredom, int fear) {
+    log_exit(hunter->id, boredom, fear, room_name(hunter->house, hunter->room), hunter->device, reason);
+    MUTEX_LOCK(&hunter->mutex, LC_HUNTER, hunter->id);
+    hunter->exitReason = reason;
+    hunter->exited = true;
+    MUTEX_UNLOCK(&hunter->mutex);
+    LIVE_SUB(hunter->house->live, huntersActive, 1);
+    LIVE_ADD(hunter->house->live, huntersExited[reason], 1);
+    hunterLeave(hunter);
+    stackClear(&hunter->path);
+}
+
+static void hunterLoop(struct Hunter *hunter) {
+    struct House *house = hunter->house;
+    struct CaseFile *casefile = &house->casefile;
+    struct HouseControl *control = &house->control;
 
     while (!hunter->exited) {
+        hunter->ticks++;
+        threadRoomStats.rooms[hunter->room].hunterDwell++;
+        LIVE_ADD(house->live, hunterTicks, 1);
+        struct Room *room = &house->rooms[hunter->room];
+        const char *roomName = LOG_LEVEL > LOG_LEVEL_NONE ? room_name(house, hunter->room) : ""; // only ever logged
+
         // ATOMIC OPERATION: Check ghost and update stats in one critical section
-        pthread_mutex_lock(&hunter->mutex);
+        MUTEX_LOCK(&hunter->mutex, LC_HUNTER, hunter->id);
         
         // Check ghost presence
-        sem_wait(&hunter->room->mutex);
-        int ghostHere = (hunter->room->ghost != NULL);
-        sem_post(&hunter->room->mutex);
+        roomLock(room);
+        int ghostHere = room->hasGhost;
+        roomUnlock(room);
         
         // Update stats based on ghost presence
         if (ghostHere) {
@@ -869,99 +1530,113 @@ void *hunterFunction(void *arg) {
         // Get current values for exit checks
         int current_boredom = hunter->boredom;
         int current_fear = hunter->fear;
-        bool shouldExitBored = (current_boredom > ENTITY_BOREDOM_MAX);
-        bool shouldExitFear = (current_fear > HUNTER_FEAR_MAX);
+        bool shouldExitBored = (current_boredom > house->boredomMax);
+        bool shouldExitFear = (current_fear > house->fearMax);
         
-        pthread_mutex_unlock(&hunter->mutex);
+        MUTEX_UNLOCK(&hunter->mutex);
 
         // Check exit conditions
         if (shouldExitBored) {
-            log_exit(hunter->id, current_boredom, current_fear, hunter->room->name, hunter->device, LR_BORED);
-            pthread_mutex_lock(&hunter->mutex);
-            hunter->exitReason = LR_BORED;
-            hunter->exited = true;
-            pthread_mutex_unlock(&hunter->mutex);
-            hunterRemove(hunter, hunter->room);
-            stackClear(&hunter->path);
-            return NULL;
+            hunterExit(hunter, LR_BORED, current_boredom, current_fear);
+            return;
         }
         if (shouldExitFear) {
-            log_exit(hunter->id, current_boredom, current_fear, hunter->room->name, hunter->device, LR_AFRAID);
-            pthread_mutex_lock(&hunter->mutex);
-            hunter->exitReason = LR_AFRAID;
-            hunter->exited = true;
-            pthread_mutex_unlock(&hunter->mutex);
-            hunterRemove(hunter, hunter->room);
-            stackClear(&hunter->path);
-            return NULL;
+            hunterExit(hunter, LR_AFRAID, current_boredom, current_fear);
+            return;
+        }
+
+        // House-wide phase changes
+        enum HousePhase phase = houseGetPhase(control);
+        if (phase == PHASE_ENDED) {
+            hunterExit(hunter, casefileSolved(casefile) ? LR_EVIDENCE : LR_BORED, current_boredom, current_fear);
+            return;
+        }
+        if (phase == PHASE_RETURNING && !hunter->returning) {
+            hunter->returning = true;
+            if (!house->layout->isExit[hunter->room]) {
+                log_return_to_van(hunter->id, current_boredom, current_fear, roomName, hunter->device, true);
+            }
         }
 
         // RETURNING HUNTER MOVEMENT
-        if (hunter->returning) {
-            struct Room* next = stackPop(&hunter->path);
-            if (next != NULL) {
-                struct Room* oldRoom = hunter->room;
-                lockRooms(oldRoom, next);
-
-                if (next->numHunters < MAX_ROOM_OCCUPANCY) {
-                    hunterRemove(hunter, oldRoom);
-                    hunterAdd(hunter, next);
-
-                    // Get updated stats for logging
-                    pthread_mutex_lock(&hunter->mutex);
-                    current_boredom = hunter->boredom;
-                    current_fear = hunter->fear;
-                    pthread_mutex_unlock(&hunter->mutex);
-                    
-                    log_move(hunter->id, current_boredom, current_fear, oldRoom->name, next->name, hunter->device);
-                } else {
-                    // If target room is full, push the room back onto stack
-                    stackPush(&hunter->path, next);
-                }
-                unlockRooms(oldRoom, next);
+        if (hunter->returning && stackPeek(&hunter->path) != ROOM_NONE) {
+            RoomId nextId = stackPeek(&hunter->path);
+            struct Room* next = &house->rooms[nextId];
+            bool moved = false;
+
+            // a place queued for during the random walk is no longer wanted
+            if (hunter->waitingFor != ROOM_NONE && hunter->waitingFor != nextId) {
+                hunterCancelAdmission(hunter);
+            }
+
+            lockRooms(room, next);
+            if (hunterCanEnter(hunter, next)) {
+                hunterRemove(hunter, room);
+                hunterAdd(hunter, next);
+                moved = true;
+                hunter->moves++;
+                threadRoomStats.rooms[nextId].hunterVisits++;
+                LIVE_ADD(house->live, moves, 1);
+            }
+            else if (hunter->waitingFor == ROOM_NONE) {
+                admissionEnqueue(hunter, next);
+            }
+            unlockRooms(room, next);
+
+            if (moved) {
+                stackPop(&hunter->path);
+
+                // Get updated stats for logging
+                MUTEX_LOCK(&hunter->mutex, LC_HUNTER, hunter->id);
+                current_boredom = hunter->boredom;
+                current_fear = hunter->fear;
+                MUTEX_UNLOCK(&hunter->mutex);
+
+                log_move(hunter->id, current_boredom, current_fear, roomName, room_name(house, nextId), hunter->device);
             }
-            // Skip regular movement if returning
-            usleep(100 * 1000);
+            // Skip regular movement if returning; an empty path means the hunter is in the van.
+            // A full room was queued for above, and the tick is spent waiting for its slot.
+            hunterTickSleep(hunter);
             continue;
         }
 
         // VAN ARRIVAL CHECK
-        if (hunter->room->is_exit && hunter->returning) {
-            log_return_to_van(hunter->id, current_boredom, current_fear, hunter->room->name, hunter->device, false);
+        if (house->layout->isExit[hunter->room] && hunter->returning) {
+            log_return_to_van(hunter->id, current_boredom, current_fear, roomName, hunter->device, false);
             hunter->returning = false;
             stackClear(&hunter->path);
 
             // Check victory
-            const enum GhostType* ghostTypes;
-            int count = get_all_ghost_types(&ghostTypes);
-
-            sem_wait(&hunter->casefile->mutex);
-            bool solved = false;
-            for (int i = 0; i < count; i++) {
-                if ((hunter->casefile->collected & ghostTypes[i]) == ghostTypes[i]) {
-                    hunter->casefile->solved = true;
-                    solved = true;
-                    break;
-                }
+            PROFILE_BEGIN(vanStart);
+            SEM_LOCK(&casefile->mutex, LC_CASEFILE, -1);
+            bool solved = evidence_names_ghost(casefile->collected);
+            if (solved) {
+                casefile->solved = true;
+                LIVE_SET(house->live, solved, 1);
             }
-            sem_post(&hunter->casefile->mutex);
+            SEM_UNLOCK(&casefile->mutex);
+            PROFILE_END(vanStart, PA_VAN_CHECK);
             
             if (solved) {
-                log_exit(hunter->id, current_boredom, current_fear, hunter->room->name, hunter->device, LR_EVIDENCE);
-                pthread_mutex_lock(&hunter->mutex);
-                hunter->exitReason = LR_EVIDENCE;
-                hunter->exited = true;
-                pthread_mutex_unlock(&hunter->mutex);
-                hunterRemove(hunter, hunter->room);
-                stackClear(&hunter->path);
-                return NULL;
+                hunterExit(hunter, LR_EVIDENCE, current_boredom, current_fear);
+                if (control->policy == END_WHEN_SOLVED) {
+                    houseSetPhase(control, PHASE_ENDED);
+                }
+                return;
+            }
+
+            // called back to the van with nothing conclusive
+            if (phase == PHASE_RETURNING) {
+                hunterExit(hunter, LR_BORED, current_boredom, current_fear);
+                return;
             }
 
             // Swap device
             enum EvidenceType oldDevice = hunter->device;
-            enum EvidenceType devices[] = {EV_EMF, EV_ORBS, EV_RADIO, EV_TEMPERATURE, EV_FINGERPRINTS, EV_WRITING, EV_INFRARED};
+            const enum EvidenceType* devices;
+            int deviceCount = get_all_evidence_types(&devices);
             while (true) {
-                enum EvidenceType newDevice = devices[rand_int_threadsafe(0, 7)];
+                enum EvidenceType newDevice = devices[rand_int_threadsafe(0, deviceCount)];
                 if (newDevice != hunter->device) {
                     log_swap(hunter->id, current_boredom, current_fear, oldDevice, newDevice);
                     hunter->device = newDevice;
@@ -971,54 +1646,192 @@ void *hunterFunction(void *arg) {
         }
 
         // Evidence gathering
+        PROFILE_BEGIN(pickupStart);
         bool matched = false;
-        sem_wait(&hunter->room->mutex);
-        EvidenceByte ev = hunter->room->evidence;
+        struct LogEvent event = { .type = LE_NONE };
+        roomLock(room);
+        EvidenceByte ev = room->evidence;
 
         if (ev & hunter->device) {
-            log_evidence(hunter->id, current_boredom, current_fear, hunter->room->name, hunter->device);
-            hunter->room->evidence &= ~hunter->device;
+            room->evidence &= ~hunter->device;
+            hunter->pickups++;
+            threadRoomStats.rooms[hunter->room].pickups++;
+            LOG_EVENT(LOG_LEVEL_EVIDENCE, event, .type = LE_EVIDENCE, .id = hunter->id, .boredom = current_boredom, .fear = current_fear,
+                      .from = roomName, .device = hunter->device);
             matched = true;
         }
-        sem_post(&hunter->room->mutex);
+        roomUnlock(room);
+        log_event_flush(&event);
 
         if (matched) {
-            sem_wait(&hunter->casefile->mutex);
-            hunter->casefile->collected |= hunter->device;
-            sem_post(&hunter->casefile->mutex);
+            SEM_LOCK(&casefile->mutex, LC_CASEFILE, -1);
+            casefile->collected |= hunter->device;
+            SEM_UNLOCK(&casefile->mutex);
+            LIVE_ADD(house->live, pickups, 1);
+            LIVE_OR(house->live, casefile, (uint8_t)hunter->device);
+            PROFILE_END(pickupStart, PA_PICKUP);
 
             // Only start returning if not already at van
-            if (!hunter->room->is_exit) {
+            if (!house->layout->isExit[hunter->room]) {
                 hunter->returning = true;
-                log_return_to_van(hunter->id, current_boredom, current_fear, hunter->room->name, hunter->device, true);
+                log_return_to_van(hunter->id, current_boredom, current_fear, roomName, hunter->device, true);
             }
         }
                 
         // Regular movement (only for non-returning hunters)
         if (!hunter->returning) {
+            PROFILE_BEGIN(moveStart);
             hunterMove(hunter);
+            PROFILE_END(moveStart, PA_HUNTER_MOVE);
         }
         
-        usleep(100 * 1000);
+        hunterTickSleep(hunter);
     }
+}
+
+void *hunterFunction(void *arg) {
+    struct Hunter *hunter = arg;
+    LOCK_TRACE_THREAD("hunter %d", hunter->id);
+    entitySeed(hunter->house, (int)(hunter - hunter->house->hunters));
+    pthread_barrier_wait(&hunter->house->startGate);
+    hunterLoop(hunter);
+    lockStatsFlush(hunter->house);
+    roomStatsFlush(hunter->house);
+    profileFlush();
     return NULL;
 }
 
+// ---- House setup ----
+void houseInit(struct House* house, enum EndPolicy policy) {
+    house->casefile.collected = 0;
+    house->casefile.solved = false;
+    sem_init(&house->casefile.mutex, 0, 1);
+    houseControlInit(&house->control, policy);
+
+    house->hunterCount = 0;
+    house->hunterCapacity = 8;
+    house->hunters = arenaAlloc(&house->arena, house->hunterCapacity * sizeof(struct Hunter), CACHE_LINE);
+    house->hunterInfo = arenaAlloc(&house->arena, house->hunterCapacity * sizeof(struct HunterInfo), _Alignof(struct HunterInfo));
+    house->maxOccupancy = MAX_ROOM_OCCUPANCY;
+    house->boredomMax = ENTITY_BOREDOM_MAX;
+    house->fearMax = HUNTER_FEAR_MAX;
+    house->seed = 0;
+
+    memset(&house->lockStats, 0, sizeof(house->lockStats));
+    memset(&house->roomStats, 0, sizeof(house->roomStats));
+    pthread_mutex_init(&house->statsMutex, NULL);
+    house->live = NULL;
+}
+
+void ghostInit(struct House* house, enum GhostType type, RoomId room) {
+    struct Ghost* ghost = &house->ghost;
+    ghost->id = DEFAULT_GHOST_ID;
+    ghost->type = type;
+    ghost->room = room;
+    ghost->boredom = 0;
+    ghost->exited = false;
+    ghost->ticks = 0;
+    ghost->house = house;
+    pthread_mutex_init(&ghost->boredom_mutex, NULL);
+    house->rooms[room].hasGhost = true;
+
+    log_ghost_init(ghost->id, room_name(house, room), type);
+}
+
+struct Hunter* hunterInit(struct House* house, const char* name, int id, enum EvidenceType device) {
+    // if hunter array is full, resize
+    if (house->hunterCount == house->hunterCapacity) {
+        huntersResize(house, &house->hunterCapacity);
+    }
+
+    struct Hunter* hunter = &house->hunters[house->hunterCount];
+    snprintf(house->hunterInfo[house->hunterCount].name, MAX_HUNTER_NAME, "%s", name);
+    house->hunterCount++;
+
+    hunter->id = id;
+    hunter->room = house->layout->start;
+    hunter->roomSlot = -1; // set by housePlaceHunters
+    hunter->house = house;
+    hunter->device = device;
+    hunter->fear = 0;
+    hunter->boredom = 0;
+    hunter->exited = false;
+    hunter->returning = false;
+    hunter->moves = 0;
+    hunter->pickups = 0;
+    hunter->ticks = 0;
+    hunter->waitingFor = ROOM_NONE;
+    hunter->admitted = false;
+    hunter->admitSignal = false;
+    hunter->waitTicks = 0;
+    hunter->waitNext = ADMISSION_NONE;
+    stackInit(&hunter->path, &house->arena);
+
+    log_hunter_init(id, room_name(house, house->layout->start), name, device);
+    return hunter;
+}
+
+void housePlaceHunters(struct House* house) {
+    // the roster is final, so every room's slot array can be sized exactly
+    for (int i = 0; i < house->layout->roomCount; i++) {
+        int capacity = house->layout->isExit[i] ? house->hunterCount : house->maxOccupancy;
+        house->rooms[i].hunters = arenaAlloc(&house->arena, (capacity > 0 ? capacity : 1) * sizeof(uint16_t), _Alignof(uint16_t));
+    }
+
+    struct Room* start = &house->rooms[house->layout->start];
+    for (int i = 0; i < house->hunterCount; i++) {
+        hunterAdd(&house->hunters[i], start);
+    }
+}
+
+void houseRun(struct House* house) {
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, ENTITY_STACK_SIZE);
+    LOCK_WATCHDOG_START();
+    if (house->live) liveBeginRun(house->live, house);
+
+    // the ghost, every hunter and this thread; nobody starts until thread creation is done
+    pthread_barrier_init(&house->startGate, NULL, (unsigned)house->hunterCount + 2);
+
+    // create ghost thread
+    pthread_t ghostThread;
+    pthread_create(&ghostThread, &attr, ghostFunction, &house->ghost);
+
+    // create one thread for each hunter; the array no longer moves, so the mutexes can be initialized in place
+    pthread_t *hunterThreads = arenaAlloc(&house->arena, house->hunterCount * sizeof(pthread_t), _Alignof(pthread_t));
+    for (int i = 0; i < house->hunterCount; i++) {
+        pthread_mutex_init(&house->hunters[i].mutex, NULL);
+        pthread_create(&hunterThreads[i], &attr, hunterFunction, &house->hunters[i]);
+    }
+    pthread_attr_destroy(&attr);
+
+    pthread_barrier_wait(&house->startGate);
+    clock_gettime(CLOCK_MONOTONIC, &house->started);
+
+    // join threads
+    pthread_join(ghostThread, NULL);
+    for (int i = 0; i < house->hunterCount; i++) {
+        pthread_join(hunterThreads[i], NULL);
+    }
+    pthread_barrier_destroy(&house->startGate);
+    if (house->live) liveEndRun(house->live);
+    LOCK_WATCHDOG_STOP();
+}
+
 void houseCleanup(struct House* house) {
     // Destroy room semaphores
-    for (int i = 0; i < house->roomCount; i++) {
+    for (int i = 0; i < house->layout->roomCount; i++) {
         sem_destroy(&house->rooms[i].mutex);
     }
 
-    // Destroy hunter mutexes and cleanup hunters
+    // Destroy hunter mutexes; their memory goes with the arena
     if (house->hunters) {
         for (int i = 0; i < house->hunterCount; i++) {
-            pthread_mutex_destroy(&house->hunters[i]->mutex); 
-            stackClear(&house->hunters[i]->path);
-            free(house->hunters[i]);
+            pthread_mutex_destroy(&house->hunters[i].mutex); 
         }
-        free(house->hunters);
         house->hunters = NULL;
+        house->hunterInfo = NULL;
     }
 
     // Destroy casefile semaphore
@@ -1026,37 +1839,21 @@ void houseCleanup(struct House* house) {
 
     // destroy ghost mutex
     pthread_mutex_destroy(&house->ghost.boredom_mutex); 
+
+    // destroy phase state
+    pthread_mutex_destroy(&house->control.mutex);
+    pthread_cond_destroy(&house->control.wake);
+
+    pthread_mutex_destroy(&house->statsMutex);
+
+    // hunters, names, thread handles, room slots and path nodes all in one go
+    arenaReset(&house->arena);
 }
 
 
 
 
 enum GhostType mask_to_ghost(EvidenceByte mask) {
-    switch (mask) {
-        case EV_FINGERPRINTS | EV_TEMPERATURE | EV_WRITING:   return GH_POLTERGEIST;
-        case EV_FINGERPRINTS | EV_TEMPERATURE | EV_RADIO:     return GH_THE_MIMIC;
-        case EV_FINGERPRINTS | EV_TEMPERATURE | EV_ORBS:      return GH_HANTU;
-        case EV_FINGERPRINTS | EV_TEMPERATURE | EV_EMF:       return GH_JINN;
-        case EV_FINGERPRINTS | EV_INFRARED | EV_RADIO:        return GH_PHANTOM;
-        case EV_FINGERPRINTS | EV_INFRARED | EV_ORBS:         return GH_BANSHEE;
-        case EV_FINGERPRINTS | EV_INFRARED | EV_EMF:          return GH_GORYO;
-        case EV_FINGERPRINTS | EV_WRITING | EV_RADIO:         return GH_BULLIES;
-        case EV_FINGERPRINTS | EV_WRITING | EV_EMF:           return GH_MYLING;
-        case EV_FINGERPRINTS | EV_ORBS | EV_EMF:              return GH_OBAKE;
-        case EV_TEMPERATURE | EV_INFRARED | EV_ORBS:          return GH_YUREI;
-        case EV_TEMPERATURE | EV_INFRARED | EV_EMF:           return GH_ONI;
-        case EV_TEMPERATURE | EV_WRITING | EV_RADIO:          return GH_MOROI;
-        case EV_TEMPERATURE | EV_WRITING | EV_ORBS:           return GH_REVENANT;
-        case EV_TEMPERATURE | EV_WRITING | EV_EMF:            return GH_SHADE;
-        case EV_TEMPERATURE | EV_RADIO | EV_ORBS:             return GH_ONRYO;
-        case EV_TEMPERATURE | EV_RADIO | EV_EMF:              return GH_THE_TWINS;
-        case EV_INFRARED | EV_WRITING | EV_RADIO:             return GH_DEOGEN;
-        case EV_INFRARED | EV_WRITING | EV_ORBS:              return GH_THAYE;
-        case EV_INFRARED | EV_RADIO | EV_ORBS:                return GH_YOKAI;
-        case EV_INFRARED | EV_RADIO | EV_EMF:                 return GH_WRAITH;
-        case EV_INFRARED | EV_ORBS | EV_EMF:                  return GH_RAIJU;
-        case EV_WRITING | EV_RADIO | EV_ORBS:                 return GH_MARE;
-        case EV_WRITING | EV_RADIO | EV_EMF:                  return GH_SPIRIT;
-        default:                                             return 0;
-    }
+    // a ghost's type is its evidence mask
+    return evidence_is_valid_ghost(mask) ? (enum GhostType)mask : 0;
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define HELPERS_H
 
 #include "defs.h"
+#include "lockdebug.h"
 
 /**
  * @brief Return the lowercase token for a device.
@@ -38,6 +39,12 @@ int get_all_evidence_types(const enum EvidenceType** list);
  */
 int get_all_ghost_types(const enum GhostType** list);
 
+/**
+ * @brief Seed the calling thread's random generator, making its sequence reproducible.
+ * @param[in] value Seed; 0 is replaced by a fixed non-zero value.
+ */
+void rand_seed_threadsafe(unsigned value);
+
 /**
  * @brief Thread-safe random integer helper.
  * @param[in] lower_inclusive Minimum value (inclusive).
@@ -60,12 +67,85 @@ bool evidence_is_valid_ghost(EvidenceByte mask);
  */
 bool evidence_has_three_unique(EvidenceByte mask);
 
+/**
+ * @brief Check whether a case file holds all the evidence of at least one ghost type (the van-arrival check).
+ * @param[in] mask Collected evidence.
+ * @return true when some ghost's three evidence bits are all set.
+ */
+bool evidence_names_ghost(EvidenceByte mask);
+
 /**
  * @brief Populate the house structure with the Willow layout.
- * @param[in,out] house House to populate; starting_room is set to the van.
+ * @param[in,out] house House to populate; layout->start is set to the van and room locks are initialized.
  */
 void house_populate_rooms(struct House* house);
 
+/**
+ * @brief Populate the house with a random connected layout for stress runs.
+ *        Room 0 is the van; the rest form a random tree plus a few extra doors.
+ * @param[in,out] house House to populate.
+ * @param[in] roomCount Number of rooms, clamped to [2, MAX_ROOMS].
+ */
+void house_generate_rooms(struct House* house, int roomCount);
+
+/**
+ * @brief Build a layout template once for many runs: Willow House, or a generated house drawn from this thread's RNG.
+ * @param[out] template Template to fill; it must outlive every House cloned from it.
+ * @param[in] roomCount 0 for Willow House, otherwise the number of rooms to generate.
+ */
+void house_template_init(struct HouseTemplate* template, int roomCount);
+
+/**
+ * @brief Give a House the template's layout and starting room state, and initialize the room locks.
+ *        Replaces house_populate_rooms / house_generate_rooms for a run.
+ * @param[out] house House to set up; its layout points into the template.
+ * @param[in] template Prebuilt template.
+ */
+void houseClone(struct House* house, const struct HouseTemplate* template);
+
+/**
+ * @brief Look up a room's name in the cold layout table.
+ * @param[in] house House the room belongs to.
+ * @param[in] id Room id.
+ * @return Room name, or "" for ROOM_NONE.
+ */
+const char* room_name(const struct House* house, RoomId id);
+
+/*
+    Log verbosity and sinks.
+
+    Each level adds to the one below it. LOG_LEVEL is fixed at build time (`make LOG_LEVEL=n`): log_*
+    calls above it are macros that expand to nothing, arguments included. LOG_LEVEL=0 is the
+    results-only build, with no per-event formatting or log files at all. LOG_SINKS likewise picks
+    which outputs are compiled in; log_set_level and log_set_sinks narrow both further at run time.
+    The log analyzer and replayer need the CSV sink at LOG_LEVEL_ALL.
+*/
+#define LOG_LEVEL_NONE      0
+#define LOG_LEVEL_LIFECYCLE 1  // INIT and EXIT
+#define LOG_LEVEL_EVIDENCE  2  // + evidence found and left, device swaps, trips to the van
+#define LOG_LEVEL_ALL       3  // + every move and ghost idle
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_ALL
+#endif
+
+#define LOG_SINK_CSV    1u  // log_<id>.csv
+#define LOG_SINK_STDOUT 2u  // narrative lines
+
+#ifndef LOG_SINKS
+#define LOG_SINKS (LOG_SINK_CSV | LOG_SINK_STDOUT)
+#endif
+
+// A compiled-out call: its arguments sit inside sizeof, so they count as used but never run.
+// log_discard is declared only for that and has no definition.
+void log_discard(int id, ...);
+#define LOG_DISCARD(...) ((void)sizeof(log_discard(__VA_ARGS__), 0))
+
+// Fill in a deferred LogEvent for log_event_flush. Below its level the constant condition drops
+// the assignment at compile time, so a critical section does no logging work at all.
+#define LOG_EVENT(level, event, ...) \
+    (LOG_LEVEL >= (level) ? (void)((event) = (struct LogEvent){ __VA_ARGS__ }) : (void)0)
+
 /**
  * @brief Append a MOVE entry for a hunter.
  * @param[in] id Hunter identifier.
@@ -75,7 +155,11 @@ void house_populate_rooms(struct House* house);
  * @param[in] to Destination room name.
  * @param[in] device Device the hunter is holding.
  */
+#if LOG_LEVEL >= LOG_LEVEL_ALL
 void log_move(int id, int boredom, int fear, const char* from, const char* to, enum EvidenceType device);
+#else
+#define log_move(...) LOG_DISCARD(__VA_ARGS__)
+#endif
 
 /**
  * @brief Append an EVIDENCE entry for a hunter.
@@ -85,7 +169,11 @@ void log_move(int id, int boredom, int fear, const char* from, const char* to, e
  * @param[in] room Room where evidence was collected.
  * @param[in] device Device used to collect evidence.
  */
+#if LOG_LEVEL >= LOG_LEVEL_EVIDENCE
 void log_evidence(int id, int boredom, int fear, const char* room, enum EvidenceType device);
+#else
+#define log_evidence(...) LOG_DISCARD(__VA_ARGS__)
+#endif
 
 /**
  * @brief Append a SWAP entry for a hunter.
@@ -95,7 +183,11 @@ void log_evidence(int id, int boredom, int fear, const char* room, enum Evidence
  * @param[in] from Device swapped from.
  * @param[in] to Device swapped to.
  */
+#if LOG_LEVEL >= LOG_LEVEL_EVIDENCE
 void log_swap(int id, int boredom, int fear, enum EvidenceType from, enum EvidenceType to);
+#else
+#define log_swap(...) LOG_DISCARD(__VA_ARGS__)
+#endif
 
 /**
  * @brief Append an EXIT entry for a hunter.
@@ -106,7 +198,11 @@ void log_swap(int id, int boredom, int fear, enum EvidenceType from, enum Eviden
  * @param[in] device Device carried.
  * @param[in] reason Exit reason.
  */
+#if LOG_LEVEL >= LOG_LEVEL_LIFECYCLE
 void log_exit(int id, int boredom, int fear, const char* room, enum EvidenceType device, enum LogReason reason);
+#else
+#define log_exit(...) LOG_DISCARD(__VA_ARGS__)
+#endif
 
 /**
  * @brief Append a MOVE entry for the ghost.
@@ -115,7 +211,11 @@ void log_exit(int id, int boredom, int fear, const char* room, enum EvidenceType
  * @param[in] from Source room.
  * @param[in] to Destination room.
  */
+#if LOG_LEVEL >= LOG_LEVEL_ALL
 void log_ghost_move(int id, int boredom, const char* from, const char* to);
+#else
+#define log_ghost_move(...) LOG_DISCARD(__VA_ARGS__)
+#endif
 
 /**
  * @brief Append an EVIDENCE entry for the ghost.
@@ -124,7 +224,11 @@ void log_ghost_move(int id, int boredom, const char* from, const char* to);
  * @param[in] room Room where evidence was dropped.
  * @param[in] evidence Evidence type left behind.
  */
+#if LOG_LEVEL >= LOG_LEVEL_EVIDENCE
 void log_ghost_evidence(int id, int boredom, const char* room, enum EvidenceType evidence);
+#else
+#define log_ghost_evidence(...) LOG_DISCARD(__VA_ARGS__)
+#endif
 
 /**
  * @brief Append an EXIT entry for the ghost.
@@ -132,7 +236,11 @@ void log_ghost_evidence(int id, int boredom, const char* room, enum EvidenceType
  * @param[in] boredom Current boredom level.
  * @param[in] room Room the ghost leaves from.
  */
+#if LOG_LEVEL >= LOG_LEVEL_LIFECYCLE
 void log_ghost_exit(int id, int boredom, const char* room);
+#else
+#define log_ghost_exit(...) LOG_DISCARD(__VA_ARGS__)
+#endif
 
 /**
  * @brief Append an IDLE entry for the ghost.
@@ -140,7 +248,11 @@ void log_ghost_exit(int id, int boredom, const char* room);
  * @param[in] boredom Current boredom level.
  * @param[in] room Room the ghost stays in.
  */
+#if LOG_LEVEL >= LOG_LEVEL_ALL
 void log_ghost_idle(int id, int boredom, const char* room);
+#else
+#define log_ghost_idle(...) LOG_DISCARD(__VA_ARGS__)
+#endif
 
 /**
  * @brief Append a RETURN entry for the hunter.
@@ -151,7 +263,11 @@ void log_ghost_idle(int id, int boredom, const char* room);
  * @param[in] device Device being carried.
  * @param[in] heading_home true if beginning the return path.
  */
+#if LOG_LEVEL >= LOG_LEVEL_EVIDENCE
 void log_return_to_van(int id, int boredom, int fear, const char* room, enum EvidenceType device, bool heading_home);
+#else
+#define log_return_to_van(...) LOG_DISCARD(__VA_ARGS__)
+#endif
 
 /**
  * @brief Append an INIT entry for a hunter.
@@ -160,7 +276,11 @@ void log_return_to_van(int id, int boredom, int fear, const char* room, enum Evi
  * @param[in] name Hunter name.
  * @param[in] device Initial device.
  */
+#if LOG_LEVEL >= LOG_LEVEL_LIFECYCLE
 void log_hunter_init(int id, const char* room, const char* name, enum EvidenceType device);
+#else
+#define log_hunter_init(...) LOG_DISCARD(__VA_ARGS__)
+#endif
 
 /**
  * @brief Append an INIT entry for the ghost.
@@ -168,7 +288,50 @@ void log_hunter_init(int id, const char* room, const char* name, enum EvidenceTy
  * @param[in] room Starting room.
  * @param[in] type Ghost type.
  */
+#if LOG_LEVEL >= LOG_LEVEL_LIFECYCLE
 void log_ghost_init(int id, const char* room, enum GhostType type);
+#else
+#define log_ghost_init(...) LOG_DISCARD(__VA_ARGS__)
+#endif
+
+/**
+ * @brief Choose which compiled-in sinks the log_* calls write to.
+ * @param[in] sinks LOG_SINK_* bits; 0 turns logging off for batch and stress runs.
+ */
+void log_set_sinks(unsigned sinks);
+
+/**
+ * @brief Lower the log level at run time; levels above LOG_LEVEL stay compiled out.
+ * @param[in] level LOG_LEVEL_* value.
+ */
+void log_set_level(int level);
+
+/**
+ * @brief Parse a log level name: none, lifecycle, evidence or all.
+ * @param[in] text Level name.
+ * @param[out] level Parsed LOG_LEVEL_* value.
+ * @return false if the name is unknown.
+ */
+bool log_level_from_string(const char* text, int* level);
+
+/**
+ * @brief Parse a sink list: none, csv, stdout or csv,stdout.
+ * @param[in] text Sink list.
+ * @param[out] sinks Parsed LOG_SINK_* bits.
+ * @return false if the list is unknown.
+ */
+bool log_sinks_from_string(const char* text, unsigned* sinks);
+
+/**
+ * @brief Wait for sealed log segments still being compressed. Call once the run's threads are done.
+ */
+void log_close(void);
+
+/**
+ * @brief Write a deferred log event recorded inside a critical section.
+ * @param[in] event Event descriptor; LE_NONE entries are ignored.
+ */
+void log_event_flush(const struct LogEvent* event);
 
 /**
  * @brief Resize the hunter array.
@@ -177,6 +340,56 @@ void log_ghost_init(int id, const char* room, enum GhostType type);
  */
 void huntersResize(struct House* house, int* capacity);
 
+/**
+ * @brief Initialize the shared phase state.
+ * @param[out] control Control block to initialize.
+ * @param[in] policy When to end the investigation early.
+ */
+void houseControlInit(struct HouseControl* control, enum EndPolicy policy);
+
+/**
+ * @brief Read the current phase.
+ * @param[in] control Control block.
+ * @return Current phase.
+ */
+enum HousePhase houseGetPhase(struct HouseControl* control);
+
+/**
+ * @brief Advance the phase and wake every sleeping entity. Never moves backwards.
+ * @param[in] control Control block.
+ * @param[in] phase New phase.
+ */
+void houseSetPhase(struct HouseControl* control, enum HousePhase phase);
+
+/**
+ * @brief Sleep for one tick scaled by control->timeScale, returning early if the phase changes.
+ *        In turbo mode (timeScale 0) the thread only yields.
+ * @param[in] control Control block.
+ */
+void houseTickSleep(struct HouseControl* control);
+
+/**
+ * @brief Parse a time scale argument: a speed-up factor of at least TIME_SCALE_MIN, or "turbo".
+ * @param[in] text Argument text.
+ * @param[out] scale Parsed scale (0 for turbo).
+ * @return true when the text was valid.
+ */
+bool time_scale_from_string(const char* text, double* scale);
+
+/**
+ * @brief Scale the pause write_log_record takes after each line.
+ * @param[in] scale Same meaning as HouseControl.timeScale.
+ */
+void log_set_time_scale(double scale);
+
+/**
+ * @brief Parse an end policy name ("natural", "solved", "ghost-exit").
+ * @param[in] text Policy name.
+ * @param[out] policy Parsed policy.
+ * @return true when the name was recognised.
+ */
+bool end_policy_from_string(const char* text, enum EndPolicy* policy);
+
 /**
  * @brief Ghost behaviour.
  * @param[in] arg Ghost pointer
@@ -209,6 +422,12 @@ void hunterRemove(struct Hunter *hunter, struct Room *room);
  */
 void hunterAdd(struct Hunter *hunter, struct Room *room);
 
+/**
+ * @brief Remove a hunter from its current room while holding that room's lock.
+ * @param[in] hunter Hunter pointer.
+ */
+void hunterLeave(struct Hunter *hunter);
+
 /**
  * @brief Move a hunter to a random room.
  * @param[in] hunter Hunter pointer.
@@ -221,6 +440,65 @@ void hunterMove(struct Hunter *hunter);
  */
 void *hunterFunction(void *arg);
 
+/**
+ * @brief Leave the admission queue the hunter is in, passing on a slot already reserved for it.
+ * @param[in] hunter Hunter pointer; takes the lock of the room it queued for.
+ */
+void hunterCancelAdmission(struct Hunter *hunter);
+
+/**
+ * @brief Check whether a room can take one more hunter without jumping its admission queue. The van is never full.
+ * @param[in] house House the room belongs to.
+ * @param[in] room Room pointer; its lock should be held.
+ * @return true when a hunter may enter.
+ */
+bool roomHasSpace(const struct House *house, const struct Room *room);
+
+/**
+ * @brief Lock one room, counting the acquisition in this thread's LockStats.
+ * @param[in] room Room pointer.
+ */
+void roomLock(struct Room *room);
+
+/**
+ * @brief Unlock one room.
+ * @param[in] room Room pointer.
+ */
+void roomUnlock(struct Room *room);
+
+/**
+ * @brief Time contended room-lock waits (off by default since it costs two clock reads per wait).
+ * @param[in] enabled true to measure wait time.
+ */
+void lock_timing_set_enabled(bool enabled);
+
+/**
+ * @brief Add the calling thread's lock counters to house->lockStats and reset them.
+ * @param[in] house House pointer.
+ */
+void lockStatsFlush(struct House *house);
+
+/**
+ * @brief Add one set of room counters to another.
+ * @param[in,out] to Counters to add to.
+ * @param[in] from Counters to add.
+ * @param[in] roomCount Rooms to merge.
+ */
+void room_stats_add(struct RoomStats *to, const struct RoomStats *from, int roomCount);
+
+/**
+ * @brief Add the calling thread's room counters to house->roomStats and reset them.
+ * @param[in] house House pointer.
+ */
+void roomStatsFlush(struct House *house);
+
+/**
+ * @brief Print a per-room activity table with a bar for the busiest rooms.
+ * @param[in] house House providing the room names.
+ * @param[in] stats Merged room counters.
+ */
+void room_stats_print(const struct House *house, const struct RoomStats *stats);
+
 /**
  * @brief Lock two rooms to avoid deadlocks.
  * @param[in] r1 Room 1 pointer.
@@ -235,36 +513,111 @@ void lockRooms(struct Room *r1, struct Room *r2);
  */
 void unlockRooms(struct Room *r1, struct Room *r2);
 
+#ifdef LOCK_DEBUG
+// report the caller, not roomLock itself, as the site of room-lock acquisitions
+#define roomLock(room) (LOCK_TRACE_SITE(), roomLock(room))
+#define lockRooms(r1, r2) (LOCK_TRACE_SITE(), lockRooms(r1, r2))
+#endif
+
+/**
+ * @brief Initialize case file, phase, hunter arrays, counters and the default behaviour limits. The arena must already be initialized.
+ * @param[in,out] house House pointer.
+ * @param[in] policy When to end the investigation early.
+ */
+void houseInit(struct House* house, enum EndPolicy policy);
+
+/**
+ * @brief Place the ghost and log its INIT entry.
+ * @param[in,out] house House pointer.
+ * @param[in] type Ghost type.
+ * @param[in] room Starting room.
+ */
+void ghostInit(struct House* house, enum GhostType type, RoomId room);
+
+/**
+ * @brief Append a hunter to the roster (growing the array if needed) and log its INIT entry.
+ * @param[in,out] house House pointer.
+ * @param[in] name Hunter name.
+ * @param[in] id Hunter identifier.
+ * @param[in] device Starting device.
+ * @return The new hunter; valid until the roster grows again.
+ */
+struct Hunter* hunterInit(struct House* house, const char* name, int id, enum EvidenceType device);
+
+/**
+ * @brief Allocate each room's slot array and put every hunter in the van. Call once the roster is final.
+ * @param[in,out] house House pointer.
+ */
+void housePlaceHunters(struct House* house);
+
+/**
+ * @brief Start the ghost and hunter threads and wait for all of them to finish.
+ *        The threads are released together once all exist; house->started records when.
+ * @param[in,out] house House pointer.
+ */
+void houseRun(struct House* house);
+
 /**
- * @brief Removes room semaphores.
+ * @brief Destroys all locks and releases the House's arena in one reset.
  * @param[in] house House pointer.
  */
 void houseCleanup(struct House* house);
 
+/**
+ * @brief Initialize an arena with one block of the given size.
+ * @param[out] arena Arena to initialize.
+ * @param[in] capacity Size of the first block in bytes.
+ */
+void arenaInit(struct Arena* arena, size_t capacity);
+
+/**
+ * @brief Allocate from the arena. Thread-safe; grows by chaining a new block when full.
+ * @param[in] arena Arena pointer.
+ * @param[in] size Bytes to allocate.
+ * @param[in] align Alignment, a power of two no larger than CACHE_LINE.
+ * @return Uninitialized memory that lives until the next arenaReset. Exits the process if a new block can't be allocated.
+ */
+void* arenaAlloc(struct Arena* arena, size_t size, size_t align);
+
+/**
+ * @brief Release every allocation at once; the blocks are kept for the next run.
+ * @param[in] arena Arena pointer.
+ */
+void arenaReset(struct Arena* arena);
+
+/**
+ * @brief Return all blocks to the system.
+ * @param[in] arena Arena pointer.
+ */
+void arenaDestroy(struct Arena* arena);
+
 /**
  * @brief Creates a RoomStack.
  * @param[in] stack RoomStack pointer.
+ * @param[in] arena Arena new nodes are taken from.
  */
-void stackInit(struct RoomStack *stack);
+void stackInit(struct RoomStack *stack, struct Arena *arena);
 
 /**
  * @brief Adds a room to the RoomStack.
  * @param[in] stack RoomStack pointer.
  * @param[in] room Room pointer.
  */
-void stackPush(struct RoomStack *stack, struct Room *room);
+void stackPush(struct RoomStack *stack, RoomId room);
 
 /**
  * @brief Removes a room from the RoomStack.
  * @param[in] stack RoomStack pointer.
+ * @return Room id, or ROOM_NONE when the stack is empty.
  */
-struct Room* stackPop(struct RoomStack *stack);
+RoomId stackPop(struct RoomStack *stack);
 
 /**
  * @brief Returns the next room from the RoomStack.
  * @param[in] stack RoomStack pointer.
+ * @return Room id, or ROOM_NONE when the stack is empty.
  */
-struct Room* stackPeek(struct RoomStack *stack);
+RoomId stackPeek(struct RoomStack *stack);
 
 /**
  * @brief Removes all rooms from the RoomStack.
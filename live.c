@@ -0,0 +1,340 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sched.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "helpers.h"
+#include "simulation.h"
+#include "live.h"
+
+#define LIVE_POLL_MS 200 // how quickly the socket thread notices liveClose
+
+// The one segment and socket of this process
+static struct {
+    struct LiveStats* stats;
+    char shmName[64];
+    char socketPath[sizeof(((struct sockaddr_un*)0)->sun_path)];
+    int listenFd;
+    pthread_t thread;
+    atomic_bool stop;
+} liveServer = { .listenFd = -1 };
+
+static long long realtime_ms(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return (long long)now.tv_sec * 1000LL + now.tv_nsec / 1000000;
+}
+
+void liveSnapshot(const struct LiveStats* live, struct LiveSnapshot* snapshot) {
+    while (true) {
+        uint32_t before = atomic_load_explicit(&live->generation, memory_order_acquire);
+        if (before & 1) {
+            sched_yield();
+            continue;
+        }
+
+        snapshot->pid = live->pid;
+        snapshot->runs = atomic_load_explicit(&live->runs, memory_order_relaxed);
+        snapshot->hunters = atomic_load_explicit(&live->hunters, memory_order_relaxed);
+        snapshot->running = atomic_load_explicit(&live->running, memory_order_relaxed);
+        long long started = atomic_load_explicit(&live->startedMs, memory_order_relaxed);
+        snapshot->elapsedMs = started ? realtime_ms() - started : 0;
+        snapshot->hunterTicks = atomic_load_explicit(&live->hunterTicks, memory_order_relaxed);
+        snapshot->moves = atomic_load_explicit(&live->moves, memory_order_relaxed);
+        snapshot->pickups = atomic_load_explicit(&live->pickups, memory_order_relaxed);
+        snapshot->huntersActive = atomic_load_explicit(&live->huntersActive, memory_order_relaxed);
+        for (int r = 0; r < 3; r++) {
+            snapshot->huntersExited[r] = atomic_load_explicit(&live->huntersExited[r], memory_order_relaxed);
+        }
+        snapshot->casefile = atomic_load_explicit(&live->casefile, memory_order_relaxed);
+        snapshot->solved = atomic_load_explicit(&live->solved, memory_order_relaxed);
+        snapshot->ghostTicks = atomic_load_explicit(&live->ghostTicks, memory_order_relaxed);
+        snapshot->evidenceDropped = atomic_load_explicit(&live->evidenceDropped, memory_order_relaxed);
+        snapshot->ghostBoredom = atomic_load_explicit(&live->ghostBoredom, memory_order_relaxed);
+
+        RoomId room = atomic_load_explicit(&live->ghostRoom, memory_order_relaxed);
+        snapshot->ghostRoom[0] = '\0';
+        if (room < live->roomCount && room < MAX_ROOMS) {
+            memcpy(snapshot->ghostRoom, live->roomNames[room], MAX_ROOM_NAME);
+            snapshot->ghostRoom[MAX_ROOM_NAME - 1] = '\0';
+        }
+
+        if (atomic_load_explicit(&live->generation, memory_order_acquire) == before) return;
+    }
+}
+
+// "emf+orbs" or "-"
+static void casefile_text(EvidenceByte casefile, char* buffer, size_t size) {
+    const enum EvidenceType* types;
+    int count = get_all_evidence_types(&types);
+    size_t used = 0;
+    buffer[0] = '\0';
+    for (int i = 0; i < count; i++) {
+        if (!(casefile & types[i])) continue;
+        int written = snprintf(buffer + used, size - used, "%s%s", used ? "+" : "", evidence_to_string(types[i]));
+        if (written < 0 || (size_t)written >= size - used) break;
+        used += (size_t)written;
+    }
+    if (used == 0) snprintf(buffer, size, "-");
+}
+
+// One "key value" line per counter
+static int snapshot_format(const struct LiveSnapshot* s, char* buffer, size_t size) {
+    char casefile[96];
+    casefile_text(s->casefile, casefile, sizeof(casefile));
+    return snprintf(buffer, size,
+                    "pid %d\nruns %u\nrunning %d\nelapsed_ms %lld\nhunters %u\nhunters_active %u\n"
+                    "exit_evidence %u\nexit_bored %u\nexit_afraid %u\n"
+                    "hunter_ticks %llu\nmoves %llu\npickups %llu\nevidence_dropped %llu\n"
+                    "casefile %s\nsolved %d\nghost_room %s\nghost_boredom %d\nghost_ticks %llu\n",
+                    s->pid, s->runs, s->running, s->elapsedMs, s->hunters, s->huntersActive,
+                    s->huntersExited[LR_EVIDENCE], s->huntersExited[LR_BORED], s->huntersExited[LR_AFRAID],
+                    (unsigned long long)s->hunterTicks, (unsigned long long)s->moves,
+                    (unsigned long long)s->pickups, (unsigned long long)s->evidenceDropped,
+                    casefile, s->solved, s->ghostRoom[0] ? s->ghostRoom : "-", s->ghostBoredom,
+                    (unsigned long long)s->ghostTicks);
+}
+
+// Answer each connection with one snapshot and close it
+static void* liveServerFunction(void* arg) {
+    (void)arg;
+    struct pollfd listener = { .fd = liveServer.listenFd, .events = POLLIN };
+    char text[1024];
+
+    while (!atomic_load(&liveServer.stop)) {
+        if (poll(&listener, 1, LIVE_POLL_MS) <= 0) continue;
+        int client = accept(liveServer.listenFd, NULL, NULL);
+        if (client < 0) continue;
+
+        struct LiveSnapshot snapshot;
+        liveSnapshot(liveServer.stats, &snapshot);
+        int length = snapshot_format(&snapshot, text, sizeof(text));
+        if (length > 0 && write(client, text, (size_t)length) < 0) {
+            // the client went away; nothing to do
+        }
+        close(client);
+    }
+    return NULL;
+}
+
+static bool live_socket_open(void) {
+    snprintf(liveServer.socketPath, sizeof(liveServer.socketPath), "%s%d.sock", LIVE_SOCKET_PREFIX, (int)getpid());
+    unlink(liveServer.socketPath); // left over from a crashed process with the same pid
+
+    liveServer.listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (liveServer.listenFd < 0) {
+        perror("live socket");
+        return false;
+    }
+
+    struct sockaddr_un address = { .sun_family = AF_UNIX };
+    memcpy(address.sun_path, liveServer.socketPath, sizeof(address.sun_path));
+    if (bind(liveServer.listenFd, (struct sockaddr*)&address, sizeof(address)) != 0 ||
+        listen(liveServer.listenFd, 16) != 0) {
+        perror(liveServer.socketPath);
+        close(liveServer.listenFd);
+        liveServer.listenFd = -1;
+        return false;
+    }
+
+    atomic_store(&liveServer.stop, false);
+    pthread_create(&liveServer.thread, NULL, liveServerFunction, NULL);
+    return true;
+}
+
+struct LiveStats* liveOpen(void) {
+    if (liveServer.stats) return liveServer.stats;
+
+    snprintf(liveServer.shmName, sizeof(liveServer.shmName), "%s%d", LIVE_SHM_PREFIX, (int)getpid());
+    int fd = shm_open(liveServer.shmName, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        perror(liveServer.shmName);
+        return NULL;
+    }
+    if (ftruncate(fd, sizeof(struct LiveStats)) != 0) {
+        perror(liveServer.shmName);
+        close(fd);
+        shm_unlink(liveServer.shmName);
+        return NULL;
+    }
+
+    struct LiveStats* live = mmap(NULL, sizeof(struct LiveStats), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (live == MAP_FAILED) {
+        perror(liveServer.shmName);
+        shm_unlink(liveServer.shmName);
+        return NULL;
+    }
+
+    // the segment starts zeroed; the magic goes last so a monitor never sees a half-made header
+    live->pid = (int32_t)getpid();
+    atomic_store_explicit(&live->ghostRoom, ROOM_NONE, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(live->magic, LIVE_MAGIC, sizeof(live->magic));
+    liveServer.stats = live;
+
+    if (!live_socket_open()) {
+        liveClose(live);
+        return NULL;
+    }
+
+    fprintf(stderr, "Live stats: shared memory %s, socket %s\n", liveServer.shmName, liveServer.socketPath);
+    return live;
+}
+
+void liveClose(struct LiveStats* live) {
+    if (live == NULL || live != liveServer.stats) return;
+
+    if (liveServer.listenFd >= 0) {
+        atomic_store(&liveServer.stop, true);
+        pthread_join(liveServer.thread, NULL);
+        close(liveServer.listenFd);
+        liveServer.listenFd = -1;
+        unlink(liveServer.socketPath);
+    }
+
+    munmap(live, sizeof(*live));
+    shm_unlink(liveServer.shmName);
+    liveServer.stats = NULL;
+}
+
+void liveBeginRun(struct LiveStats* live, const struct House* house) {
+    atomic_fetch_add_explicit(&live->generation, 1, memory_order_acq_rel);
+
+    atomic_store_explicit(&live->hunters, (uint32_t)house->hunterCount, memory_order_relaxed);
+    atomic_store_explicit(&live->running, 1, memory_order_relaxed);
+    atomic_store_explicit(&live->startedMs, realtime_ms(), memory_order_relaxed);
+    live->roomCount = house->layout->roomCount;
+    memcpy(live->roomNames, house->layout->names, sizeof(live->roomNames));
+
+    atomic_store_explicit(&live->hunterTicks, 0, memory_order_relaxed);
+    atomic_store_explicit(&live->moves, 0, memory_order_relaxed);
+    atomic_store_explicit(&live->pickups, 0, memory_order_relaxed);
+    atomic_store_explicit(&live->huntersActive, (uint32_t)house->hunterCount, memory_order_relaxed);
+    for (int r = 0; r < 3; r++) atomic_store_explicit(&live->huntersExited[r], 0, memory_order_relaxed);
+    atomic_store_explicit(&live->casefile, 0, memory_order_relaxed);
+    atomic_store_explicit(&live->solved, 0, memory_order_relaxed);
+
+    atomic_store_explicit(&live->ghostTicks, 0, memory_order_relaxed);
+    atomic_store_explicit(&live->evidenceDropped, 0, memory_order_relaxed);
+    atomic_store_explicit(&live->ghostBoredom, 0, memory_order_relaxed);
+    atomic_store_explicit(&live->ghostRoom, house->ghost.room, memory_order_relaxed);
+
+    atomic_fetch_add_explicit(&live->runs, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&live->generation, 1, memory_order_acq_rel);
+}
+
+void liveEndRun(struct LiveStats* live) {
+    atomic_store_explicit(&live->running, 0, memory_order_relaxed);
+}
+
+// ---- Monitor ----
+
+static void monitor_usage(void) {
+    fprintf(stderr,
+            "Usage: huntSimulation --monitor [--once] [--interval MS]\n"
+            "Prints the live counters of every run started with --live on this machine.\n"
+            "  --once          print one table and exit\n"
+            "  --interval MS   refresh period (default 1000)\n");
+}
+
+// Map one segment read-only; NULL if it isn't a live segment
+static const struct LiveStats* monitor_map(const char* name) {
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(struct LiveStats)) {
+        close(fd);
+        return NULL;
+    }
+    const struct LiveStats* live = mmap(NULL, sizeof(struct LiveStats), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (live == MAP_FAILED) return NULL;
+    if (memcmp(live->magic, LIVE_MAGIC, sizeof(live->magic)) != 0) {
+        munmap((void*)live, sizeof(*live));
+        return NULL;
+    }
+    return live;
+}
+
+static int monitor_print(void) {
+    DIR* dir = opendir(LIVE_SHM_DIR);
+    if (dir == NULL) {
+        perror(LIVE_SHM_DIR);
+        return -1;
+    }
+
+    printf("%8s %5s %8s %7s %6s %6s %6s %6s %10s %10s %8s %8s %-24s %-24s %5s\n",
+           "pid", "run", "state", "hunters", "active", "evid", "bored", "afraid",
+           "ticks", "moves", "pickups", "dropped", "casefile", "ghost room", "gbore");
+
+    int found = 0;
+    size_t prefixLength = strlen(LIVE_SHM_PREFIX) - 1; // without the leading slash
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strncmp(entry->d_name, LIVE_SHM_PREFIX + 1, prefixLength) != 0) continue;
+
+        char name[300];
+        snprintf(name, sizeof(name), "/%s", entry->d_name);
+        const struct LiveStats* live = monitor_map(name);
+        if (live == NULL) continue;
+
+        struct LiveSnapshot s;
+        liveSnapshot(live, &s);
+        munmap((void*)live, sizeof(*live));
+
+        const char* state = s.running ? "running" : s.runs ? "between" : "setup";
+        if (kill(s.pid, 0) != 0 && errno == ESRCH) state = "stale";
+
+        char casefile[96];
+        casefile_text(s.casefile, casefile, sizeof(casefile));
+        if (s.solved) strncat(casefile, " *", sizeof(casefile) - strlen(casefile) - 1);
+        printf("%8d %5u %8s %7u %6u %6u %6u %6u %10llu %10llu %8llu %8llu %-24s %-24s %5d\n",
+               s.pid, s.runs, state, s.hunters, s.huntersActive,
+               s.huntersExited[LR_EVIDENCE], s.huntersExited[LR_BORED], s.huntersExited[LR_AFRAID],
+               (unsigned long long)(s.hunterTicks + s.ghostTicks), (unsigned long long)s.moves,
+               (unsigned long long)s.pickups, (unsigned long long)s.evidenceDropped,
+               casefile, s.ghostRoom[0] ? s.ghostRoom : "-", s.ghostBoredom);
+        found++;
+    }
+    closedir(dir);
+
+    if (found == 0) printf("(no live runs; start one with --live)\n");
+    fflush(stdout);
+    return found;
+}
+
+int live_monitor_main(int argc, char* argv[]) {
+    bool once = false;
+    int interval = 1000;
+    for (int i = 1; i < argc; i++) {
+        bool ok = true;
+        if (strcmp(argv[i], "--once") == 0) once = true;
+        else if (i + 1 < argc && strcmp(argv[i], "--interval") == 0) ok = simulation_parse_positive(argv[++i], &interval);
+        else ok = false;
+
+        if (!ok) {
+            monitor_usage();
+            return 1;
+        }
+    }
+
+    while (true) {
+        if (monitor_print() < 0) return 1;
+        if (once) return 0;
+        struct timespec pause = { interval / 1000, (long)(interval % 1000) * 1000000L };
+        nanosleep(&pause, NULL);
+        printf("\n");
+    }
+}
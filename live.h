@@ -0,0 +1,122 @@
+#ifndef LIVE_H
+#define LIVE_H
+
+#include <stdatomic.h>
+#include "defs.h"
+
+/*
+    Live counters of a running House, published in a POSIX shared-memory segment named
+    LIVE_SHM_PREFIX<pid> so a monitor can watch any number of runs by mapping them read-only.
+
+    Entity threads update the counters with relaxed atomics and never take a lock for them. The
+    counters written by the hunters, by the ghost and by the main thread sit on separate cache lines.
+    A Unix-domain socket at LIVE_SOCKET_PREFIX<pid>.sock serves a text snapshot to every client that
+    connects, for tools that would rather not map the segment.
+*/
+
+#define LIVE_MAGIC "PHLIVE01"
+#define LIVE_SHM_PREFIX "/huntSimulation."
+#define LIVE_SHM_DIR "/dev/shm"
+#define LIVE_SOCKET_PREFIX "/tmp/huntSimulation."
+
+struct LiveStats {
+    char magic[8];
+    int32_t pid;
+    _Atomic uint32_t generation;        // odd while liveBeginRun rewrites the segment
+
+    // written by the main thread around each run
+    _Alignas(CACHE_LINE) _Atomic uint32_t runs;  // runs started by this process
+    _Atomic uint32_t hunters;           // hunters in the current run
+    _Atomic uint8_t running;
+    _Atomic int64_t startedMs;          // CLOCK_REALTIME when the current run started
+    int32_t roomCount;
+    char roomNames[MAX_ROOMS][MAX_ROOM_NAME];
+
+    // written by every hunter
+    _Alignas(CACHE_LINE) _Atomic uint64_t hunterTicks;
+    _Atomic uint64_t moves;
+    _Atomic uint64_t pickups;
+    _Atomic uint32_t huntersActive;
+    _Atomic uint32_t huntersExited[3];  // by enum LogReason
+    _Atomic uint8_t casefile;           // EvidenceByte
+    _Atomic uint8_t solved;
+
+    // written by the ghost
+    _Alignas(CACHE_LINE) _Atomic uint64_t ghostTicks;
+    _Atomic uint64_t evidenceDropped;
+    _Atomic int32_t ghostBoredom;
+    _Atomic uint8_t ghostRoom;          // ROOM_NONE once the ghost has left
+};
+
+// A consistent copy of a LiveStats segment
+struct LiveSnapshot {
+    int pid;
+    unsigned runs;
+    unsigned hunters;
+    bool running;
+    long long elapsedMs;
+    uint64_t hunterTicks;
+    uint64_t moves;
+    uint64_t pickups;
+    unsigned huntersActive;
+    unsigned huntersExited[3];
+    EvidenceByte casefile;
+    bool solved;
+    uint64_t ghostTicks;
+    uint64_t evidenceDropped;
+    int ghostBoredom;
+    char ghostRoom[MAX_ROOM_NAME];      // empty once the ghost has left
+};
+
+// Relaxed updates from the entity threads; a NULL segment (the default) makes them no-ops
+#define LIVE_ADD(live, field, n) \
+    do { if (live) atomic_fetch_add_explicit(&(live)->field, (n), memory_order_relaxed); } while (0)
+#define LIVE_SUB(live, field, n) \
+    do { if (live) atomic_fetch_sub_explicit(&(live)->field, (n), memory_order_relaxed); } while (0)
+#define LIVE_OR(live, field, bits) \
+    do { if (live) atomic_fetch_or_explicit(&(live)->field, (bits), memory_order_relaxed); } while (0)
+#define LIVE_SET(live, field, value) \
+    do { if (live) atomic_store_explicit(&(live)->field, (value), memory_order_relaxed); } while (0)
+
+/**
+ * @brief Create this process's shared-memory segment and start the snapshot socket.
+ *        Only one segment per process; the paths are printed to stderr.
+ * @return The segment, or NULL if it or the socket can't be created.
+ */
+struct LiveStats* liveOpen(void);
+
+/**
+ * @brief Stop the socket and remove the segment and the socket file.
+ * @param[in] live Segment from liveOpen, may be NULL.
+ */
+void liveClose(struct LiveStats* live);
+
+/**
+ * @brief Reset the per-run counters for a House about to run. Called by houseRun.
+ * @param[in,out] live Segment.
+ * @param[in] house House whose roster, layout and ghost are set up.
+ */
+void liveBeginRun(struct LiveStats* live, const struct House* house);
+
+/**
+ * @brief Mark the current run as finished. Called by houseRun.
+ * @param[in,out] live Segment.
+ */
+void liveEndRun(struct LiveStats* live);
+
+/**
+ * @brief Copy a segment, retrying while a run is being set up.
+ * @param[in] live Segment, usually mapped from another process.
+ * @param[out] snapshot Copy.
+ */
+void liveSnapshot(const struct LiveStats* live, struct LiveSnapshot* snapshot);
+
+/**
+ * @brief Entry point for `huntSimulation --monitor`: print every live run on this machine.
+ * @param[in] argc Argument count, argv[0] being "--monitor".
+ * @param[in] argv Arguments.
+ * @return Process exit status.
+ */
+int live_monitor_main(int argc, char* argv[]);
+
+#endif // LIVE_H
@@ -0,0 +1,335 @@
+#include "lockdebug.h"
+
+#ifdef LOCK_DEBUG
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <stdatomic.h>
+
+#define LOCK_DEBUG_MAX_THREADS 8192
+#define LOCK_DEBUG_MAX_HELD 8
+#define LOCK_WATCHDOG_POLL_MS 250
+
+static const char* lockClassNames[LC_COUNT] = { "hunter", "ghost", "room", "casefile", "control", "stats", "arena", "profile", "log" };
+
+struct LockSite {
+    const char* function;
+    int line;
+};
+
+struct HeldLock {
+    const void* lock;
+    enum LockClass lockClass;
+    int index;
+    struct LockSite site;
+};
+
+// What one thread holds and waits for; the mutex only keeps the watchdog's reads consistent
+struct LockThread {
+    atomic_bool inUse;
+    pthread_mutex_t mutex;
+    char name[32];
+    struct HeldLock held[LOCK_DEBUG_MAX_HELD];
+    int heldCount;
+    bool waiting;
+    struct HeldLock wanted;
+    struct timespec waitStart;
+};
+
+static struct LockThread lockThreads[LOCK_DEBUG_MAX_THREADS];
+static _Thread_local struct LockThread* self;
+static _Thread_local struct LockSite callerSite;
+static pthread_key_t threadKey;        // frees the thread's slot when it exits
+static pthread_once_t initOnce = PTHREAD_ONCE_INIT;
+
+// Order graph over lock classes
+static _Atomic uint32_t edges[LC_COUNT];              // bit j of edges[i]: class j was taken while holding class i
+static struct LockSite edgeSites[LC_COUNT][LC_COUNT]; // where each edge was first seen
+static pthread_mutex_t graphMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static atomic_ullong progress;         // acquisitions by every thread, watched by the watchdog
+
+static pthread_t watchdogThread;
+static atomic_bool watchdogStop;
+static int watchdogUsers;              // houses running; sweep workers run several at once
+static pthread_mutex_t watchdogMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void thread_release(void* arg) {
+    struct LockThread* thread = arg;
+    pthread_mutex_lock(&thread->mutex);
+    thread->heldCount = 0;
+    thread->waiting = false;
+    pthread_mutex_unlock(&thread->mutex);
+    atomic_store(&thread->inUse, false);
+}
+
+static void lock_debug_init(void) {
+    for (int i = 0; i < LOCK_DEBUG_MAX_THREADS; i++) {
+        pthread_mutex_init(&lockThreads[i].mutex, NULL);
+    }
+    pthread_key_create(&threadKey, thread_release);
+}
+
+// This thread's record, claimed on first use; NULL when every slot is taken
+static struct LockThread* thread_self(void) {
+    if (self) return self;
+    pthread_once(&initOnce, lock_debug_init);
+
+    for (int i = 0; i < LOCK_DEBUG_MAX_THREADS; i++) {
+        bool expected = false;
+        if (!atomic_compare_exchange_strong(&lockThreads[i].inUse, &expected, true)) continue;
+
+        self = &lockThreads[i];
+        pthread_mutex_lock(&self->mutex);
+        snprintf(self->name, sizeof(self->name), "thread %d", i);
+        self->heldCount = 0;
+        self->waiting = false;
+        pthread_mutex_unlock(&self->mutex);
+        pthread_setspecific(threadKey, self);
+        return self;
+    }
+    return NULL;
+}
+
+static void print_lock(const struct HeldLock* lock) {
+    fprintf(stderr, "%s", lockClassNames[lock->lockClass]);
+    if (lock->index >= 0) fprintf(stderr, " %d", lock->index);
+    fprintf(stderr, " (%p) at %s:%d", lock->lock, lock->site.function ? lock->site.function : "?", lock->site.line);
+}
+
+// Caller holds thread->mutex
+static void print_thread(const struct LockThread* thread) {
+    fprintf(stderr, "  %s holds %d lock(s)\n", thread->name, thread->heldCount);
+    for (int i = 0; i < thread->heldCount; i++) {
+        fprintf(stderr, "    held:    ");
+        print_lock(&thread->held[i]);
+        fprintf(stderr, "\n");
+    }
+    if (thread->waiting) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        long long ms = (long long)(now.tv_sec - thread->waitStart.tv_sec) * 1000 +
+                       (now.tv_nsec - thread->waitStart.tv_nsec) / 1000000;
+        fprintf(stderr, "    waiting: ");
+        print_lock(&thread->wanted);
+        fprintf(stderr, " for %lld ms\n", ms);
+    }
+}
+
+// Breadth-first path from one class to another through the recorded edges; returns its length, 0 if none
+static int find_path(enum LockClass from, enum LockClass to, enum LockClass* path) {
+    int parent[LC_COUNT];
+    for (int c = 0; c < LC_COUNT; c++) parent[c] = -1;
+    int queue[LC_COUNT];
+    int head = 0, tail = 0;
+    queue[tail++] = from;
+    parent[from] = from;
+
+    while (head < tail) {
+        int c = queue[head++];
+        if (c == (int)to) {
+            int length = 0;
+            for (int at = to; at != (int)from; at = parent[at]) path[length++] = (enum LockClass)at;
+            path[length++] = from;
+            // reverse into from ... to
+            for (int i = 0; i < length / 2; i++) {
+                enum LockClass swap = path[i];
+                path[i] = path[length - 1 - i];
+                path[length - 1 - i] = swap;
+            }
+            return length;
+        }
+        uint32_t next = atomic_load(&edges[c]);
+        for (int n = 0; n < LC_COUNT; n++) {
+            if ((next & (1u << n)) && parent[n] < 0) {
+                parent[n] = c;
+                queue[tail++] = n;
+            }
+        }
+    }
+    return 0;
+}
+
+static void add_edge(struct LockThread* thread, enum LockClass held, enum LockClass wanted, struct LockSite site) {
+    uint32_t bit = 1u << wanted;
+    if (atomic_load_explicit(&edges[held], memory_order_relaxed) & bit) return;
+
+    pthread_mutex_lock(&graphMutex);
+    if (!(atomic_load(&edges[held]) & bit)) {
+        edgeSites[held][wanted] = site;
+        atomic_fetch_or(&edges[held], bit);
+
+        enum LockClass path[LC_COUNT];
+        int length = find_path(wanted, held, path);
+        if (length > 0) {
+            fprintf(stderr, "LOCK ORDER: %s -> %s at %s:%d closes a cycle:\n",
+                    lockClassNames[held], lockClassNames[wanted], site.function ? site.function : "?", site.line);
+            for (int i = 0; i + 1 < length; i++) {
+                const struct LockSite* first = &edgeSites[path[i]][path[i + 1]];
+                fprintf(stderr, "  %s -> %s first at %s:%d\n", lockClassNames[path[i]], lockClassNames[path[i + 1]],
+                        first->function ? first->function : "?", first->line);
+            }
+            pthread_mutex_lock(&thread->mutex);
+            print_thread(thread);
+            pthread_mutex_unlock(&thread->mutex);
+        }
+    }
+    pthread_mutex_unlock(&graphMutex);
+}
+
+void lockDebugSite(const char* function, int line) {
+    callerSite = (struct LockSite){ function, line };
+}
+
+void lockDebugThreadName(const char* format, int id) {
+    struct LockThread* thread = thread_self();
+    if (thread == NULL) return;
+    pthread_mutex_lock(&thread->mutex);
+    snprintf(thread->name, sizeof(thread->name), format, id);
+    pthread_mutex_unlock(&thread->mutex);
+}
+
+void lockDebugWait(const void* lock, enum LockClass lockClass, int index, const char* function, int line) {
+    struct LockThread* thread = thread_self();
+    if (thread == NULL) return;
+    struct LockSite site = function ? (struct LockSite){ function, line } : callerSite;
+    struct HeldLock wanted = { lock, lockClass, index, site };
+
+    // the held list only changes on this thread, so it can be read without the mutex
+    for (int i = 0; i < thread->heldCount; i++) {
+        const struct HeldLock* held = &thread->held[i];
+        if (held->lockClass != lockClass) {
+            add_edge(thread, held->lockClass, lockClass, site);
+            continue;
+        }
+
+        // rooms nest only in ascending address order, as lockRooms takes them
+        if (lockClass == LC_ROOM && (uintptr_t)held->lock < (uintptr_t)lock) continue;
+
+        pthread_mutex_lock(&graphMutex);
+        fprintf(stderr, "LOCK ORDER: %s wants ", held->lock == lock ? "self-deadlock," : "same-class nesting,");
+        print_lock(&wanted);
+        fprintf(stderr, "\n");
+        pthread_mutex_lock(&thread->mutex);
+        print_thread(thread);
+        pthread_mutex_unlock(&thread->mutex);
+        pthread_mutex_unlock(&graphMutex);
+    }
+
+    pthread_mutex_lock(&thread->mutex);
+    thread->wanted = wanted;
+    thread->waiting = true;
+    clock_gettime(CLOCK_MONOTONIC, &thread->waitStart);
+    pthread_mutex_unlock(&thread->mutex);
+}
+
+void lockDebugAcquired(const void* lock) {
+    struct LockThread* thread = thread_self();
+    if (thread == NULL) return;
+
+    pthread_mutex_lock(&thread->mutex);
+    if (thread->waiting && thread->wanted.lock == lock) {
+        if (thread->heldCount < LOCK_DEBUG_MAX_HELD) {
+            thread->held[thread->heldCount++] = thread->wanted;
+        } else {
+            fprintf(stderr, "LOCK DEBUG: %s holds more than %d locks; not tracking the rest\n",
+                    thread->name, LOCK_DEBUG_MAX_HELD);
+        }
+        thread->waiting = false;
+    }
+    pthread_mutex_unlock(&thread->mutex);
+    atomic_fetch_add_explicit(&progress, 1, memory_order_relaxed);
+}
+
+void lockDebugRelease(const void* lock) {
+    struct LockThread* thread = thread_self();
+    if (thread == NULL) return;
+
+    pthread_mutex_lock(&thread->mutex);
+    for (int i = thread->heldCount - 1; i >= 0; i--) {
+        if (thread->held[i].lock != lock) continue;
+        memmove(&thread->held[i], &thread->held[i + 1], (size_t)(thread->heldCount - 1 - i) * sizeof(thread->held[0]));
+        thread->heldCount--;
+        break;
+    }
+    pthread_mutex_unlock(&thread->mutex);
+}
+
+static void watchdog_dump(double seconds) {
+    pthread_mutex_lock(&graphMutex);
+    fprintf(stderr, "LOCK WATCHDOG: no lock taken for %.1f s while a thread waits; held and awaited locks:\n", seconds);
+    for (int i = 0; i < LOCK_DEBUG_MAX_THREADS; i++) {
+        struct LockThread* thread = &lockThreads[i];
+        if (!atomic_load(&thread->inUse)) continue;
+        pthread_mutex_lock(&thread->mutex);
+        if (thread->heldCount > 0 || thread->waiting) print_thread(thread);
+        pthread_mutex_unlock(&thread->mutex);
+    }
+    pthread_mutex_unlock(&graphMutex);
+}
+
+static bool any_waiting(void) {
+    for (int i = 0; i < LOCK_DEBUG_MAX_THREADS; i++) {
+        struct LockThread* thread = &lockThreads[i];
+        if (!atomic_load(&thread->inUse)) continue;
+        pthread_mutex_lock(&thread->mutex);
+        bool waiting = thread->waiting;
+        pthread_mutex_unlock(&thread->mutex);
+        if (waiting) return true;
+    }
+    return false;
+}
+
+static void* watchdogFunction(void* arg) {
+    (void)arg;
+    unsigned long long seen = atomic_load(&progress);
+    struct timespec last;
+    clock_gettime(CLOCK_MONOTONIC, &last);
+    bool reported = false;
+
+    while (!atomic_load(&watchdogStop)) {
+        struct timespec pause = { 0, LOCK_WATCHDOG_POLL_MS * 1000000L };
+        nanosleep(&pause, NULL);
+
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        unsigned long long current = atomic_load(&progress);
+        if (current != seen) {
+            seen = current;
+            last = now;
+            reported = false;
+            continue;
+        }
+
+        double stalled = (double)(now.tv_sec - last.tv_sec) + (double)(now.tv_nsec - last.tv_nsec) / 1e9;
+        if (!reported && stalled >= LOCK_WATCHDOG_SECONDS && any_waiting()) {
+            watchdog_dump(stalled);
+            reported = true;
+        }
+    }
+    return NULL;
+}
+
+void lockDebugWatchdogStart(void) {
+    pthread_once(&initOnce, lock_debug_init);
+    pthread_mutex_lock(&watchdogMutex);
+    if (watchdogUsers++ == 0) {
+        atomic_store(&watchdogStop, false);
+        pthread_create(&watchdogThread, NULL, watchdogFunction, NULL);
+    }
+    pthread_mutex_unlock(&watchdogMutex);
+}
+
+void lockDebugWatchdogStop(void) {
+    pthread_mutex_lock(&watchdogMutex);
+    if (watchdogUsers > 0 && --watchdogUsers == 0) {
+        atomic_store(&watchdogStop, true);
+        pthread_join(watchdogThread, NULL);
+    }
+    pthread_mutex_unlock(&watchdogMutex);
+}
+
+#endif // LOCK_DEBUG
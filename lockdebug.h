@@ -0,0 +1,116 @@
+#ifndef LOCKDEBUG_H
+#define LOCKDEBUG_H
+
+#include <pthread.h>
+#include <semaphore.h>
+
+/*
+    Lock-order checker and deadlock watchdog, compiled in with `make LOCK_DEBUG=1` (-DLOCK_DEBUG).
+
+    Every lock belongs to a LockClass. Each time a thread waits for a lock while holding others, the
+    edge "held class -> wanted class" is added to a global graph, and a new edge that closes a cycle
+    is reported with the call sites of every edge on it. Two rooms may only be nested in ascending
+    address order, as lockRooms takes them. A watchdog thread started by houseRun dumps every thread's
+    held and awaited locks when some thread is waiting and no lock has been taken for
+    LOCK_WATCHDOG_SECONDS.
+
+    Without LOCK_DEBUG the LOCK_TRACE_* macros expand to nothing and MUTEX_LOCK and friends are the
+    bare pthread/semaphore calls.
+*/
+
+#define LOCK_WATCHDOG_SECONDS 5
+
+enum LockClass {
+    LC_HUNTER = 0,  // Hunter.mutex
+    LC_GHOST,       // Ghost.boredom_mutex
+    LC_ROOM,        // Room.mutex
+    LC_CASEFILE,    // CaseFile.mutex
+    LC_CONTROL,     // HouseControl.mutex
+    LC_STATS,       // House.statsMutex
+    LC_ARENA,       // Arena.mutex
+    LC_PROFILE,     // profile.c totals
+    LC_LOG,         // logseg.c compression queue
+    LC_COUNT
+};
+
+#ifdef LOCK_DEBUG
+
+/**
+ * @brief Record that this thread is about to wait for a lock, checking it against the locks it holds.
+ * @param[in] lock Address of the lock.
+ * @param[in] lockClass Class of the lock.
+ * @param[in] index Room or hunter id for the dump, -1 if none.
+ * @param[in] function Call site, NULL to use the one given to lockDebugSite.
+ * @param[in] line Call site line.
+ */
+void lockDebugWait(const void* lock, enum LockClass lockClass, int index, const char* function, int line);
+
+/**
+ * @brief Move the lock this thread waited for to its held locks.
+ * @param[in] lock Address of the lock.
+ */
+void lockDebugAcquired(const void* lock);
+
+/**
+ * @brief Drop a lock from this thread's held locks.
+ * @param[in] lock Address of the lock.
+ */
+void lockDebugRelease(const void* lock);
+
+/**
+ * @brief Set the call site reported by the next waits that don't name their own (roomLock, lockRooms).
+ * @param[in] function Caller.
+ * @param[in] line Caller line.
+ */
+void lockDebugSite(const char* function, int line);
+
+/**
+ * @brief Name this thread in reports, e.g. ("hunter %d", 3).
+ * @param[in] format printf format with one %d.
+ * @param[in] id Value for the %d.
+ */
+void lockDebugThreadName(const char* format, int id);
+
+/**
+ * @brief Start the watchdog thread, or count one more user if it is running.
+ */
+void lockDebugWatchdogStart(void);
+
+/**
+ * @brief Stop the watchdog thread once every lockDebugWatchdogStart has been matched.
+ */
+void lockDebugWatchdogStop(void);
+
+#define LOCK_TRACE_WAIT(lock, lockClass, index) lockDebugWait((lock), (lockClass), (index), __func__, __LINE__)
+#define LOCK_TRACE_WAIT_CALLER(lock, lockClass, index) lockDebugWait((lock), (lockClass), (index), NULL, 0)
+#define LOCK_TRACE_ACQUIRED(lock) lockDebugAcquired(lock)
+#define LOCK_TRACE_RELEASE(lock) lockDebugRelease(lock)
+#define LOCK_TRACE_SITE() lockDebugSite(__func__, __LINE__)
+#define LOCK_TRACE_THREAD(format, id) lockDebugThreadName((format), (id))
+#define LOCK_WATCHDOG_START() lockDebugWatchdogStart()
+#define LOCK_WATCHDOG_STOP() lockDebugWatchdogStop()
+
+#else
+
+#define LOCK_TRACE_WAIT(lock, lockClass, index) ((void)0)
+#define LOCK_TRACE_WAIT_CALLER(lock, lockClass, index) ((void)0)
+#define LOCK_TRACE_ACQUIRED(lock) ((void)0)
+#define LOCK_TRACE_RELEASE(lock) ((void)0)
+#define LOCK_TRACE_SITE() ((void)0)
+#define LOCK_TRACE_THREAD(format, id) ((void)0)
+#define LOCK_WATCHDOG_START() ((void)0)
+#define LOCK_WATCHDOG_STOP() ((void)0)
+
+#endif // LOCK_DEBUG
+
+// Lock and unlock with tracing; index is the room or hunter id shown in watchdog dumps, -1 if none
+#define MUTEX_LOCK(mutex, lockClass, index) \
+    do { LOCK_TRACE_WAIT(mutex, lockClass, index); pthread_mutex_lock(mutex); LOCK_TRACE_ACQUIRED(mutex); } while (0)
+#define MUTEX_UNLOCK(mutex) \
+    do { LOCK_TRACE_RELEASE(mutex); pthread_mutex_unlock(mutex); } while (0)
+#define SEM_LOCK(sem, lockClass, index) \
+    do { LOCK_TRACE_WAIT(sem, lockClass, index); sem_wait(sem); LOCK_TRACE_ACQUIRED(sem); } while (0)
+#define SEM_UNLOCK(sem) \
+    do { LOCK_TRACE_RELEASE(sem); sem_post(sem); } while (0)
+
+#endif // LOCKDEBUG_H
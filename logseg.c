@@ -0,0 +1,440 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <limits.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "logseg.h"
+#include "lockdebug.h"
+
+#define LZ_MIN_MATCH 4
+#define LZ_HASH_BITS 12
+#define LZ_BOUND(length) ((length) + (length) / 255 + 16) // packed size of incompressible input
+
+// segmentForEach helpers: the file doesn't exist (as opposed to -1, unreadable)
+#define SEGMENT_MISSING (-2)
+
+// ---- Codec ----
+
+static uint32_t lz_hash(const uint8_t* p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return (value * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+// Length bytes past a nibble of 15
+static uint8_t* lz_put_length(uint8_t* out, size_t extra) {
+    while (extra >= 255) {
+        *out++ = 255;
+        extra -= 255;
+    }
+    *out++ = (uint8_t)extra;
+    return out;
+}
+
+static bool lz_get_length(const uint8_t** in, const uint8_t* end, size_t* length) {
+    uint8_t byte;
+    do {
+        if (*in >= end) return false;
+        byte = *(*in)++;
+        *length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+// One sequence; matchLength 0 ends the block with literals only
+static uint8_t* lz_put_sequence(uint8_t* out, const uint8_t* literals, size_t literalCount, size_t offset, size_t matchLength) {
+    size_t matchCode = matchLength ? matchLength - LZ_MIN_MATCH : 0;
+    *out++ = (uint8_t)((literalCount < 15 ? literalCount : 15) << 4 | (matchCode < 15 ? matchCode : 15));
+    if (literalCount >= 15) out = lz_put_length(out, literalCount - 15);
+    memcpy(out, literals, literalCount);
+    out += literalCount;
+    if (matchLength) {
+        *out++ = (uint8_t)(offset & 0xFF);
+        *out++ = (uint8_t)(offset >> 8);
+        if (matchCode >= 15) out = lz_put_length(out, matchCode - 15);
+    }
+    return out;
+}
+
+// Greedy compression of one block of at most LOG_LZ_BLOCK bytes; out holds LZ_BOUND(length)
+static size_t lz_compress(const uint8_t* in, size_t length, uint8_t* out) {
+    uint32_t table[1 << LZ_HASH_BITS]; // last position + 1 with each hash, 0 = none
+    memset(table, 0, sizeof(table));
+
+    uint8_t* start = out;
+    size_t anchor = 0;
+    size_t pos = 0;
+    while (pos + LZ_MIN_MATCH <= length) {
+        uint32_t hash = lz_hash(in + pos);
+        size_t candidate = table[hash];
+        table[hash] = (uint32_t)pos + 1;
+        if (candidate == 0 || memcmp(in + candidate - 1, in + pos, LZ_MIN_MATCH) != 0) {
+            pos++;
+            continue;
+        }
+
+        size_t from = candidate - 1;
+        size_t matchLength = LZ_MIN_MATCH;
+        while (pos + matchLength < length && in[from + matchLength] == in[pos + matchLength]) matchLength++;
+        out = lz_put_sequence(out, in + anchor, pos - anchor, pos - from, matchLength);
+        pos += matchLength;
+        anchor = pos;
+    }
+    out = lz_put_sequence(out, in + anchor, length - anchor, 0, 0);
+    return (size_t)(out - start);
+}
+
+// Returns false unless the packed bytes decode to exactly length bytes
+static bool lz_decompress(const uint8_t* in, size_t packed, uint8_t* out, size_t length) {
+    const uint8_t* end = in + packed;
+    size_t pos = 0;
+    while (in < end) {
+        uint8_t token = *in++;
+
+        size_t literals = token >> 4;
+        if (literals == 15 && !lz_get_length(&in, end, &literals)) return false;
+        if (literals > (size_t)(end - in) || literals > length - pos) return false;
+        memcpy(out + pos, in, literals);
+        in += literals;
+        pos += literals;
+        if (in == end) break;
+
+        if (end - in < 2) return false;
+        size_t offset = (size_t)in[0] | (size_t)in[1] << 8;
+        in += 2;
+        size_t match = token & 15;
+        if (match == 15 && !lz_get_length(&in, end, &match)) return false;
+        match += LZ_MIN_MATCH;
+        if (offset == 0 || offset > pos || match > length - pos) return false;
+
+        // byte by byte: the match may overlap what it is copying
+        for (size_t i = 0; i < match; i++) out[pos + i] = out[pos - offset + i];
+        pos += match;
+    }
+    return pos == length;
+}
+
+static void put_u32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; i++) out[i] = (uint8_t)(value >> (8 * i));
+}
+
+static uint32_t get_u32(const uint8_t* in) {
+    return (uint32_t)in[0] | (uint32_t)in[1] << 8 | (uint32_t)in[2] << 16 | (uint32_t)in[3] << 24;
+}
+
+// ---- Compression thread ----
+
+// A sealed segment waiting to be compressed
+struct SealedSegment {
+    struct SealedSegment* next;
+    char path[];
+};
+
+static struct {
+    pthread_mutex_t mutex;               // guards everything below
+    pthread_cond_t wake;                 // a segment was queued or stop was requested
+    struct SealedSegment* head;
+    struct SealedSegment** tail;
+    pthread_t thread;
+    bool running;
+    bool stopping;
+} compressor = { .mutex = PTHREAD_MUTEX_INITIALIZER, .wake = PTHREAD_COND_INITIALIZER, .tail = &compressor.head };
+
+// log_3.2.csv -> log_3.2.lz; false if path doesn't end in .csv
+static bool packed_path(const char* path, char* packed, size_t size) {
+    size_t length = strlen(path);
+    if (length < 4 || strcmp(path + length - 4, ".csv") != 0) return false;
+    return snprintf(packed, size, "%.*s.lz", (int)(length - 4), path) < (int)size;
+}
+
+// Write path's blocks to a temporary file, move it into place and remove the plain segment
+static void compress_segment(const char* path) {
+    char packed[PATH_MAX];
+    char temporary[PATH_MAX];
+    if (!packed_path(path, packed, sizeof(packed)) ||
+        snprintf(temporary, sizeof(temporary), "%s.tmp", packed) >= (int)sizeof(temporary)) return;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return;
+    }
+    struct stat st;
+    fstat(fd, &st);
+    if (st.st_size == 0) {
+        close(fd);
+        return;
+    }
+    const uint8_t* map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror(path);
+        return;
+    }
+
+    FILE* out = fopen(temporary, "wb");
+    uint8_t* block = malloc(8 + LZ_BOUND(LOG_LZ_BLOCK));
+    bool ok = out && block && fwrite(LOG_LZ_MAGIC, 1, 8, out) == 8;
+    for (size_t offset = 0; ok && offset < (size_t)st.st_size; offset += LOG_LZ_BLOCK) {
+        size_t raw = (size_t)st.st_size - offset < LOG_LZ_BLOCK ? (size_t)st.st_size - offset : LOG_LZ_BLOCK;
+        size_t size = lz_compress(map + offset, raw, block + 8);
+        put_u32(block, (uint32_t)raw);
+        put_u32(block + 4, (uint32_t)size);
+        ok = fwrite(block, 1, 8 + size, out) == 8 + size;
+    }
+    if (out && fclose(out) != 0) ok = false;
+    free(block);
+    munmap((void*)map, (size_t)st.st_size);
+
+    // on failure the plain segment stays, and readers take it instead
+    if (!ok || rename(temporary, packed) != 0) {
+        perror(temporary);
+        unlink(temporary);
+        return;
+    }
+    unlink(path);
+}
+
+static void* compressorFunction(void* arg) {
+    (void)arg;
+    MUTEX_LOCK(&compressor.mutex, LC_LOG, -1);
+    while (true) {
+        while (compressor.head == NULL && !compressor.stopping) {
+            LOCK_TRACE_RELEASE(&compressor.mutex);
+            pthread_cond_wait(&compressor.wake, &compressor.mutex);
+            LOCK_TRACE_WAIT(&compressor.mutex, LC_LOG, -1);
+            LOCK_TRACE_ACQUIRED(&compressor.mutex);
+        }
+        struct SealedSegment* segment = compressor.head;
+        if (segment == NULL) break; // stopping with nothing left
+
+        compressor.head = segment->next;
+        if (compressor.head == NULL) compressor.tail = &compressor.head;
+        MUTEX_UNLOCK(&compressor.mutex);
+
+        compress_segment(segment->path);
+        free(segment);
+        MUTEX_LOCK(&compressor.mutex, LC_LOG, -1);
+    }
+    MUTEX_UNLOCK(&compressor.mutex);
+    return NULL;
+}
+
+static void compressor_enqueue(const char* path) {
+    size_t size = strlen(path) + 1;
+    struct SealedSegment* segment = malloc(sizeof(*segment) + size);
+    if (segment == NULL) return; // stays a plain segment
+    segment->next = NULL;
+    memcpy(segment->path, path, size);
+
+    MUTEX_LOCK(&compressor.mutex, LC_LOG, -1);
+    if (!compressor.running) {
+        compressor.stopping = false;
+        compressor.running = pthread_create(&compressor.thread, NULL, compressorFunction, NULL) == 0;
+    }
+    if (compressor.running) {
+        *compressor.tail = segment;
+        compressor.tail = &segment->next;
+        segment = NULL;
+        pthread_cond_signal(&compressor.wake);
+    }
+    MUTEX_UNLOCK(&compressor.mutex);
+    free(segment);
+}
+
+void segmentSeal(const char* path) {
+    size_t length = strlen(path);
+    if (length < 4 || strcmp(path + length - 4, ".csv") != 0) return;
+
+    // link fails on an existing name, so two threads sealing the same entity can't take the same number
+    char sealed[PATH_MAX];
+    for (int seq = 1; ; seq++) {
+        char packed[PATH_MAX];
+        snprintf(sealed, sizeof(sealed), "%.*s.%d.csv", (int)(length - 4), path, seq);
+        if (packed_path(sealed, packed, sizeof(packed)) && access(packed, F_OK) == 0) continue;
+        if (link(path, sealed) == 0) break;
+        if (errno == EEXIST) continue;
+        if (errno != ENOENT) perror(sealed); // ENOENT: another thread sealed it first
+        return;
+    }
+    unlink(path);
+    compressor_enqueue(sealed);
+}
+
+void segmentCompressorStop(void) {
+    MUTEX_LOCK(&compressor.mutex, LC_LOG, -1);
+    bool running = compressor.running;
+    compressor.stopping = true;
+    pthread_cond_signal(&compressor.wake);
+    MUTEX_UNLOCK(&compressor.mutex);
+    if (!running) return;
+
+    pthread_join(compressor.thread, NULL);
+    MUTEX_LOCK(&compressor.mutex, LC_LOG, -1);
+    compressor.running = false;
+    MUTEX_UNLOCK(&compressor.mutex);
+}
+
+// ---- Reading ----
+
+// Entity id of log_<id>.csv, log_<id>.<seq>.csv or log_<id>.<seq>.lz
+static bool log_name_id(const char* name, int* id) {
+    if (strncmp(name, "log_", 4) != 0) return false;
+    char* rest;
+    long value = strtol(name + 4, &rest, 10);
+    if (rest == name + 4) return false;
+    if (strcmp(rest, ".csv") != 0) {
+        if (rest[0] != '.' || rest[1] < '0' || rest[1] > '9') return false;
+        strtol(rest + 1, &rest, 10);
+        if (strcmp(rest, ".csv") != 0 && strcmp(rest, ".lz") != 0) return false;
+    }
+    *id = (int)value;
+    return true;
+}
+
+static int compare_ids(const void* a, const void* b) {
+    int left = *(const int*)a;
+    int right = *(const int*)b;
+    return (left > right) - (left < right);
+}
+
+int segmentListEntities(const char* dir, int** ids) {
+    DIR* handle = opendir(dir);
+    if (handle == NULL) {
+        perror(dir);
+        return -1;
+    }
+
+    int count = 0;
+    int capacity = 0;
+    *ids = NULL;
+    struct dirent* entry;
+    while ((entry = readdir(handle)) != NULL) {
+        int id;
+        if (!log_name_id(entry->d_name, &id)) continue;
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            *ids = realloc(*ids, (size_t)capacity * sizeof(**ids));
+        }
+        (*ids)[count++] = id;
+    }
+    closedir(handle);
+
+    // an entity with sealed segments shows up once per file
+    qsort(*ids, (size_t)count, sizeof(**ids), compare_ids);
+    int unique = 0;
+    for (int i = 0; i < count; i++) {
+        if (unique == 0 || (*ids)[unique - 1] != (*ids)[i]) (*ids)[unique++] = (*ids)[i];
+    }
+    return unique;
+}
+
+// Map a plain segment and visit it; 1 if visited, 0 if empty
+static int visit_plain(const char* path, SegmentVisitor visit, void* context) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        if (errno == ENOENT) return SEGMENT_MISSING;
+        perror(path);
+        return -1;
+    }
+    struct stat st;
+    fstat(fd, &st);
+    if (st.st_size == 0) {
+        close(fd);
+        return 0;
+    }
+
+    const char* map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror(path);
+        return -1;
+    }
+    madvise((void*)map, (size_t)st.st_size, MADV_SEQUENTIAL);
+    visit(context, map, (size_t)st.st_size);
+    munmap((void*)map, (size_t)st.st_size);
+    return 1;
+}
+
+// Decompress a packed segment into one buffer and visit it; 1 if visited, 0 if empty
+static int visit_packed(const char* path, SegmentVisitor visit, void* context) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        if (errno == ENOENT) return SEGMENT_MISSING;
+        perror(path);
+        return -1;
+    }
+    struct stat st;
+    fstat(fd, &st);
+    const uint8_t* map = st.st_size > 0 ? mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "%s: not a compressed log segment\n", path);
+        return -1;
+    }
+
+    // the block headers give the total size up front
+    const uint8_t* end = map + st.st_size;
+    size_t total = 0;
+    bool ok = st.st_size >= 8 && memcmp(map, LOG_LZ_MAGIC, 8) == 0;
+    for (const uint8_t* block = map + 8; ok && block < end; ) {
+        ok = end - block >= 8 && get_u32(block) <= LOG_LZ_BLOCK && get_u32(block + 4) <= (size_t)(end - block - 8);
+        if (!ok) break;
+        total += get_u32(block);
+        block += 8 + get_u32(block + 4);
+    }
+
+    char* text = ok ? malloc(total ? total : 1) : NULL;
+    size_t pos = 0;
+    for (const uint8_t* block = map + 8; text && block < end; block += 8 + get_u32(block + 4)) {
+        if (!lz_decompress(block + 8, get_u32(block + 4), (uint8_t*)text + pos, get_u32(block))) {
+            free(text);
+            text = NULL;
+            break;
+        }
+        pos += get_u32(block);
+    }
+    munmap((void*)map, (size_t)st.st_size);
+
+    if (text == NULL) {
+        fprintf(stderr, "%s: corrupt compressed log segment\n", path);
+        return -1;
+    }
+    if (total > 0) visit(context, text, total);
+    free(text);
+    return total > 0;
+}
+
+int segmentForEach(const char* dir, int id, SegmentVisitor visit, void* context) {
+    char path[PATH_MAX];
+    int visited = 0;
+    for (int seq = 1; ; seq++) {
+        // a segment being compressed goes from .csv to .lz, so look for .lz again if the .csv just vanished
+        snprintf(path, sizeof(path), "%s/log_%d.%d.lz", dir, id, seq);
+        int rc = visit_packed(path, visit, context);
+        if (rc == SEGMENT_MISSING) {
+            snprintf(path, sizeof(path), "%s/log_%d.%d.csv", dir, id, seq);
+            rc = visit_plain(path, visit, context);
+        }
+        if (rc == SEGMENT_MISSING) {
+            snprintf(path, sizeof(path), "%s/log_%d.%d.lz", dir, id, seq);
+            rc = visit_packed(path, visit, context);
+        }
+        if (rc == SEGMENT_MISSING) break;
+        if (rc < 0) return -1;
+        visited += rc;
+    }
+
+    snprintf(path, sizeof(path), "%s/log_%d.csv", dir, id);
+    int rc = visit_plain(path, visit, context);
+    if (rc == -1) return -1;
+    if (rc > 0) visited += rc;
+    return visited;
+}
@@ -0,0 +1,65 @@
+#ifndef LOGSEG_H
+#define LOGSEG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+    Segmented entity logs.
+
+    Each entity appends to log_<id>.csv. Once that file reaches LOG_SEGMENT_BYTES it is sealed as
+    log_<id>.<seq>.csv (seq counting up from 1), and a background thread compresses the sealed
+    segment to log_<id>.<seq>.lz and removes the .csv. Rotation happens between records, so every
+    segment holds whole lines and can be parsed on its own.
+
+    A .lz file is LOG_LZ_MAGIC followed by blocks of at most LOG_LZ_BLOCK bytes, each a little-endian
+    u32 raw size, a u32 packed size and the packed bytes. Packed data is a series of sequences: a token
+    (literal count << 4 | match length - 4, 15 meaning more length bytes follow), the literals, then a
+    little-endian u16 offset back into the block and the extra match length bytes. The last sequence
+    of a block has literals only.
+*/
+
+#define LOG_SEGMENT_BYTES (1024 * 1024) // seal log_<id>.csv once it grows past this
+#define LOG_LZ_MAGIC "PHLZ0001"
+#define LOG_LZ_BLOCK (64 * 1024)       // offsets are 16 bits, so matches never reach across blocks
+
+/**
+ * @brief Seal an active log file as the entity's next numbered segment and queue it for compression.
+ *        The compression thread is started on first use.
+ * @param[in] path Active log file, e.g. "log_3.csv".
+ */
+void segmentSeal(const char* path);
+
+/**
+ * @brief Wait for every queued segment to be compressed and stop the compression thread.
+ */
+void segmentCompressorStop(void);
+
+/**
+ * @brief List the entities with a log in a directory, sealed segments included.
+ * @param[in] dir Directory to scan.
+ * @param[out] ids Sorted entity ids, malloc'd; free when done.
+ * @return Number of entities, or -1 if the directory can't be read.
+ */
+int segmentListEntities(const char* dir, int** ids);
+
+/**
+ * @brief Called once per segment by segmentForEach with that segment's text.
+ * @param[in] context Value passed to segmentForEach.
+ * @param[in] data Segment contents, valid only during the call.
+ * @param[in] length Bytes in data.
+ */
+typedef void (*SegmentVisitor)(void* context, const char* data, size_t length);
+
+/**
+ * @brief Stream one entity's log: sealed segments oldest first, then the active file.
+ *        Plain segments are mapped, compressed ones decompressed into a temporary buffer.
+ * @param[in] dir Directory holding the logs.
+ * @param[in] id Entity id.
+ * @param[in] visit Called for every non-empty segment.
+ * @param[in] context Passed to visit.
+ * @return Segments visited, or -1 if a segment is unreadable or corrupt.
+ */
+int segmentForEach(const char* dir, int id, SegmentVisitor visit, void* context);
+
+#endif // LOGSEG_H
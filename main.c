@@ -2,13 +2,31 @@
 #include <stdlib.h>
 #include <string.h>
 #include <pthread.h>
+#include <time.h>
 #include "defs.h"
 #include "helpers.h"
+#include "simulation.h"
+#include "results.h"
+#include "live.h"
+#include "profile.h"
 #define RED     "\x1b[31m"
 #define GREEN   "\x1b[32m"
 #define RESET   "\x1b[0m"
 
-int main() {
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [--end-policy natural|solved|ghost-exit] [--time-scale <factor>|turbo] [--results FILE] [--live] [--profile]\n", prog);
+    fprintf(stderr, "       %*s [--log-level none|lifecycle|evidence|all] [--log-sinks csv,stdout|csv|stdout|none]\n", (int)strlen(prog), "");
+    fprintf(stderr, "       %s --stress [stress options, see --stress --help]\n", prog);
+    fprintf(stderr, "       %s --sweep [sweep options, see --sweep --help]\n", prog);
+    fprintf(stderr, "       %s --analytic [analytic options, see --analytic --help]\n", prog);
+    fprintf(stderr, "       %s --parallel [parallel options, see --parallel --help]\n", prog);
+    fprintf(stderr, "       %s --events [event options, see --events --help]\n", prog);
+    fprintf(stderr, "       %s --shards [shard options, see --shards --help]\n", prog);
+    fprintf(stderr, "       %s --results-summary FILE\n", prog);
+    fprintf(stderr, "       %s --monitor [--once] [--interval MS]\n", prog);
+}
+
+int main(int argc, char* argv[]) {
 
     /*
     1. Initialize a House structure.
@@ -23,34 +41,97 @@ int main() {
     7. Clean up all dynamically allocated resources and call sem_destroy() on all semaphores.
     */
 
+    // non-interactive modes
+    if (argc > 1 && strcmp(argv[1], "--stress") == 0) {
+        return stress_main(argc - 1, argv + 1);
+    }
+    if (argc > 1 && strcmp(argv[1], "--sweep") == 0) {
+        return sweep_main(argc - 1, argv + 1);
+    }
+    if (argc > 1 && strcmp(argv[1], "--analytic") == 0) {
+        return markov_main(argc - 1, argv + 1);
+    }
+    if (argc > 1 && strcmp(argv[1], "--parallel") == 0) {
+        return tick_main(argc - 1, argv + 1);
+    }
+    if (argc > 1 && strcmp(argv[1], "--events") == 0) {
+        return events_main(argc - 1, argv + 1);
+    }
+    if (argc > 1 && strcmp(argv[1], "--shards") == 0) {
+        return shard_main(argc - 1, argv + 1);
+    }
+    if (argc == 3 && strcmp(argv[1], "--results-summary") == 0) {
+        return results_summary(argv[2]);
+    }
+    if (argc > 1 && strcmp(argv[1], "--monitor") == 0) {
+        return live_monitor_main(argc - 1, argv + 1);
+    }
+
+    // command line options
+    enum EndPolicy policy = END_NATURAL;
+    double timeScale = 1.0;
+    const char* resultsPath = NULL;
+    bool live = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--end-policy") == 0 && i + 1 < argc) {
+            if (!end_policy_from_string(argv[++i], &policy)) {
+                usage(argv[0]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--time-scale") == 0 && i + 1 < argc) {
+            if (!time_scale_from_string(argv[++i], &timeScale)) {
+                usage(argv[0]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--results") == 0 && i + 1 < argc) {
+            resultsPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--live") == 0) {
+            live = true;
+        }
+        else if (strcmp(argv[i], "--profile") == 0) {
+            profile_set_enabled(true);
+        }
+        else if (strcmp(argv[i], "--log-level") == 0 && i + 1 < argc) {
+            int level;
+            if (!log_level_from_string(argv[++i], &level)) {
+                usage(argv[0]);
+                return 1;
+            }
+            log_set_level(level);
+        }
+        else if (strcmp(argv[i], "--log-sinks") == 0 && i + 1 < argc) {
+            unsigned sinks;
+            if (!log_sinks_from_string(argv[++i], &sinks)) {
+                usage(argv[0]);
+                return 1;
+            }
+            log_set_sinks(sinks);
+        }
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
     struct House house; // initialize house structure
+    arenaInit(&house.arena, HOUSE_ARENA_SIZE); // all dynamic memory for this run
     house_populate_rooms(&house); // populate rooms
-    house.casefile.collected = 0;
-    house.casefile.solved = false;
-    sem_init(&house.casefile.mutex, 0, 1);
+    houseInit(&house, policy); // case file, shared phase, hunter arrays
+    house.control.timeScale = timeScale;
+    log_set_time_scale(timeScale);
+    if (live && (house.live = liveOpen()) == NULL) return 1;
 
-    
-    // choose random ghost type
+    // choose random ghost type and create the ghost
     const enum GhostType* ghostTypes;
     int count = get_all_ghost_types(&ghostTypes);
-    int selected = ghostTypes[rand_int_threadsafe(0, count)];
-    house.ghost.type = selected;
-    
-    // create ghost
-    house.ghost.id = DEFAULT_GHOST_ID; 
-    house.ghost.room = &house.rooms[rand_int_threadsafe(0, house.roomCount)];
-    house.ghost.room->ghost = &house.ghost;
-    house.ghost.boredom = 0;
-    house.ghost.exited = false;
-    pthread_mutex_init(&house.ghost.boredom_mutex, NULL);
-    log_ghost_init(house.ghost.id, house.ghost.room->name, house.ghost.type); // initialize ghost data
-
-    // prepare hunter array
-    int huntersArrSize = 8;
-    house.hunters = calloc(huntersArrSize, sizeof(struct Hunter*));
-    house.hunterCount = 0;
+    enum GhostType selected = ghostTypes[rand_int_threadsafe(0, count)];
+    ghostInit(&house, selected, (RoomId)rand_int_threadsafe(0, house.layout->roomCount));
 
-    enum EvidenceType devices[] = {EV_EMF, EV_ORBS, EV_RADIO, EV_TEMPERATURE, EV_FINGERPRINTS, EV_WRITING, EV_INFRARED};
+    const enum EvidenceType* devices;
+    int deviceCount = get_all_evidence_types(&devices);
 
     // menu messages
     printf("==========================\nWillow House Investigation\n==========================\n");
@@ -108,73 +189,43 @@ int main() {
         int d;
         while ((d = getchar()) != '\n' && d != EOF) {}
         
-        // if hunter array is full, resize
-        if (house.hunterCount == huntersArrSize) {
-            huntersResize(&house, &huntersArrSize);
-        }
-        
-        // dynamically add space in the array
-        house.hunters[house.hunterCount] = malloc(sizeof(struct Hunter));
-
-        // initialize fields
-        strcpy(house.hunters[house.hunterCount]->name, hunterName); // name
-        house.hunters[house.hunterCount]->id = hunterID; // id
-        house.hunters[house.hunterCount]->room = house.starting_room; // room
-        house.hunters[house.hunterCount]->casefile = &house.casefile; // casefile
-        house.hunters[house.hunterCount]->device = devices[rand_int_threadsafe(0, 7)]; // device
-        house.hunters[house.hunterCount]->fear= 0; // fear
-        house.hunters[house.hunterCount]->boredom = 0; // boredom
-        house.hunters[house.hunterCount]->exited = false; // exited
-        house.hunters[house.hunterCount]->returning = false; // returning to van
-        stackInit(&house.hunters[house.hunterCount]->path); // room stack creation
-        pthread_mutex_init(&house.hunters[house.hunterCount]->mutex, NULL);
-
-        // log hunter initialization
-        log_hunter_init(hunterID, house.starting_room->name, hunterName, house.hunters[house.hunterCount]->device);
-        
-        // check if there's room in the starting room 
-        if (house.starting_room->numHunters < MAX_ROOM_OCCUPANCY) {
-            int index = house.starting_room->numHunters;
-            house.starting_room->hunters[index] = house.hunters[house.hunterCount];
-            house.starting_room->numHunters++; // increase # of hunters in starting room
-        }        
-        house.hunterCount++;
-    }
-
-    // create ghost thread
-    pthread_t ghostThread;
-    pthread_create(&ghostThread, NULL, ghostFunction, &house.ghost);
-
-    // create one thread for each hunter
-    pthread_t *hunterThreads = calloc(house.hunterCount, sizeof(pthread_t));
-    for (int i = 0; i < house.hunterCount; i++) {
-        pthread_create(&hunterThreads[i], NULL, hunterFunction, house.hunters[i]);
+        // create the hunter (the roster grows as needed)
+        hunterInit(&house, hunterName, hunterID, devices[rand_int_threadsafe(0, deviceCount)]);
     }
 
-    // join threads
-    pthread_join(ghostThread, NULL);
-    for (int i = 0; i < house.hunterCount; i++) {
-        pthread_join(hunterThreads[i], NULL);
-    }
-
-    for (int i = 0; i < house.hunterCount; i++) {
-        pthread_mutex_destroy(&house.hunters[i]->mutex);
+    // every hunter starts in the van
+    housePlaceHunters(&house);
+
+    // run the ghost and hunter threads to completion
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    houseRun(&house);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    // append this run to the results file
+    if (resultsPath) {
+        struct SimResult result;
+        struct ResultsWriter results;
+        double wall = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+        simulation_collect(&house, wall, &result);
+        if (resultsOpen(&results, resultsPath, SIM_MAX_OUTCOMES) == 0) {
+            resultsAppend(&results, &result);
+            resultsClose(&results);
+        }
     }
 
-    pthread_mutex_destroy(&house.ghost.boredom_mutex);
-
     printf("==========================\nInvestigation Results:\n==========================\n");
     
     for (int i = 0; i < house.hunterCount; i++) {
-        const char* reason = exit_reason_to_string(house.hunters[i]->exitReason);
+        const char* reason = exit_reason_to_string(house.hunters[i].exitReason);
 
         // if hunter left because of evidence add a check
-        if (house.hunters[i]->exitReason == LR_EVIDENCE) {
-            printf("[" GREEN "✔" RESET "] Hunter %s (ID %d) exited because of [%s] (bored=%d fear=%d)\n", house.hunters[i]->name, house.hunters[i]->id, reason, house.hunters[i]->boredom, house.hunters[i]->fear);
+        if (house.hunters[i].exitReason == LR_EVIDENCE) {
+            printf("[" GREEN "✔" RESET "] Hunter %s (ID %d) exited because of [%s] (bored=%d fear=%d)\n", house.hunterInfo[i].name, house.hunters[i].id, reason, house.hunters[i].boredom, house.hunters[i].fear);
         }
 
         else {
-            printf("[" RED "✖" RESET "] Hunter %s (ID %d) exited because of [%s] (bored=%d fear=%d)\n", house.hunters[i]->name, house.hunters[i]->id, reason, house.hunters[i]->boredom, house.hunters[i]->fear);
+            printf("[" RED "✖" RESET "] Hunter %s (ID %d) exited because of [%s] (bored=%d fear=%d)\n", house.hunterInfo[i].name, house.hunters[i].id, reason, house.hunters[i].boredom, house.hunters[i].fear);
         }
 
         
@@ -184,54 +235,15 @@ int main() {
     printf("\nShared Case File Checklist:\n");
     
     // case file checklist
-    if (house.casefile.collected & EV_EMF) {
-        num++;
-        printf("  - [" GREEN "✔" RESET "] emf\n");
-    }
-
-    else printf("  - [" RED "✖" RESET "] emf\n");
-
-    if (house.casefile.collected & EV_ORBS) {
-        num++;
-        printf("  - [" GREEN "✔" RESET "] orbs\n");
-    }
-
-    else printf("  - [" RED "✖" RESET "] orbs\n");
-
-    if (house.casefile.collected & EV_RADIO) {
-        num++;
-        printf("  - [" GREEN "✔" RESET "] radio\n");
-    }
-
-    else printf("  - [" RED "✖" RESET "] radio\n");
-
-    if (house.casefile.collected & EV_TEMPERATURE) {
-        num++;
-        printf("  - [" GREEN "✔" RESET "] temp\n");
-    }
-
-    else printf("  - [" RED "✖" RESET "] temp\n");
-
-    if (house.casefile.collected & EV_FINGERPRINTS) {
-        num++;
-        printf("  - [" GREEN "✔" RESET "] prints\n");
-    }
-
-    else printf("  - [" RED "✖" RESET "] prints\n");
-
-    if (house.casefile.collected & EV_WRITING) {
-        num++;
-        printf("  - [" GREEN "✔" RESET "] writing\n");
-    }
-
-    else printf("  - [" RED "✖" RESET "] writing\n");
+    for (int i = 0; i < deviceCount; i++) {
+        if (house.casefile.collected & devices[i]) {
+            num++;
+            printf("  - [" GREEN "✔" RESET "] %s\n", evidence_to_string(devices[i]));
+        }
 
-    if (house.casefile.collected & EV_INFRARED) {
-        num++;
-        printf("  - [" GREEN "✔" RESET "] infrared\n\n");
+        else printf("  - [" RED "✖" RESET "] %s\n", evidence_to_string(devices[i]));
     }
-
-    else printf("  - [" RED "✖" RESET "] infrared\n\n");
+    printf("\n");
 
     printf("Victory Results:\n--------------------------\n");
     printf("- Hunters exited after identifying the ghost: %d/%d\n", num, house.hunterCount);
@@ -252,9 +264,19 @@ int main() {
     else
         printf("Overall Result: " RED "Ghost Wins!\n" RESET);
 
+    printf("\nRoom Activity:\n--------------------------\n");
+    room_stats_print(&house, &house.roomStats);
+
+    if (profile_enabled) {
+        printf("\nAction Latency:\n--------------------------\n");
+        profile_print(stdout);
+    }
+
     // cleanup
+    log_close();
+    liveClose(house.live);
     houseCleanup(&house);
-    free(hunterThreads);
+    arenaDestroy(&house.arena);
     
     return 0;
 }
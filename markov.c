@@ -0,0 +1,509 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include "helpers.h"
+#include "simulation.h"
+
+/*
+    Analytic mode: win probability and expected length of an investigation without sampling.
+
+    The figures are exact for the chain below, not for the threaded simulation: the chain runs the
+    entities in lockstep and aggregates the house (see the end of this comment), and the threads
+    don't. --check N samples the threads and reports how far each figure is off.
+
+    The entity loops are turned into a Markov chain over synchronous ticks (the ghost acts, then the
+    hunter, both having seen where the other stood at the start of the tick). Per tick:
+
+      ghost   with a hunter in its room: boredom 0, idle or haunt; otherwise boredom + 1, idle, haunt
+              or move to a random neighbour. Haunting leaves one of its 3 evidence types.
+      hunter  ghost in its room: fear + 1, boredom 0; otherwise boredom + 1. Leaves when either passes
+              its limit. Returning hunters step towards the van; on arrival they win if the case file
+              is complete, otherwise swap to a different device. Then: pick up evidence matching the
+              device (and start returning unless in the van), and if not returning move to a random
+              neighbour.
+
+    State compression, which loses nothing relative to the chain:
+      - With one hunter, the ghost's and the hunter's boredom reset and grow on the same ticks, so one
+        counter serves both, and the ghost leaves of boredom on the tick the hunter does.
+      - Every tick either resets boredom and raises fear or raises boredom, so (fear, boredom) only
+        ever grows. The chain is a DAG over (fear, boredom) layers: probability mass is pushed forward
+        one layer at a time and only two layers plus the first layer of the next fear level are live.
+        The transition matrix is applied per layer without being stored.
+      - The ghost's three evidence types are interchangeable, so the case file is a count (0-3) and
+        the device is "uncollected ghost type", "collected ghost type" or "not a ghost type".
+
+    Aggregation, where the chain differs from the threads:
+      - Only evidence of the held device type is tracked, and only positionally for the hunter's and
+        the ghost's rooms; the other rooms are lumped into a count and assumed interchangeable. After a
+        swap, the new type is assumed to be laid out like the type just handed in.
+      - Returning hunters take the shortest path to the van instead of retracing their walk.
+      - Several hunters are treated as independent copies that each meet the ghost on their own; the
+        team wins when the union of their collected evidence is complete. This leaves out the ghost
+        staying longer when more hunters keep it company, so it underestimates larger teams.
+*/
+
+#define MARKOV_MAX_ROOMS 24 // layers grow with the cube of the room count
+#define MARKOV_CHECK_SIGMAS 3.0 // --check fails when a figure is further than this from the sampled one
+
+enum MarkovDevice {
+    MD_NEW = 0,   // a ghost evidence type not in the case file yet
+    MD_OLD,       // a ghost evidence type already in the case file
+    MD_NONE,      // not one of the ghost's types; never finds anything
+    MD_COUNT
+};
+
+struct MarkovState {
+    int ghost;        // room
+    int hunter;       // room
+    int returning;
+    int collected;    // ghost evidence types in the case file
+    int device;       // enum MarkovDevice
+    int hunterBit;    // held-type evidence in the hunter's room
+    int ghostBit;     // held-type evidence in the ghost's room, 0 while they share it
+    int others;       // held-type evidence in the remaining rooms
+};
+
+struct Markov {
+    const struct RoomLayout* layout;
+    int rooms;
+    int van;
+    int boredomMax;
+    int fearMax;
+    RoomId nextHop[MAX_ROOMS];  // towards the van
+
+    size_t layerSize;
+    double* current;            // layer (fear, boredom)
+    double* nextBoredom;        // layer (fear, boredom + 1)
+    double* nextFear;           // layer (fear + 1, 0)
+    double* target;             // where the state being expanded sends its mass
+
+    int boredom;                // of the tick being expanded, after the update
+    double win;                 // case file complete when the hunter left
+    double solved;              // hunter handed in a complete case file
+    double afraid;
+    double bored;
+    double ticks;               // expected investigation length
+    double collectedAtExit[4];  // distribution of the hunter's collected count
+};
+
+static size_t markov_index(const struct Markov* mk, const struct MarkovState* s) {
+    size_t i = (size_t)s->ghost;
+    i = i * mk->rooms + s->hunter;
+    i = i * 2 + s->returning;
+    i = i * 4 + s->collected;
+    i = i * MD_COUNT + s->device;
+    i = i * 2 + s->hunterBit;
+    i = i * 2 + s->ghostBit;
+    return i * mk->rooms + s->others;
+}
+
+static void markov_decode(const struct Markov* mk, size_t i, struct MarkovState* s) {
+    s->others = (int)(i % mk->rooms); i /= mk->rooms;
+    s->ghostBit = (int)(i % 2); i /= 2;
+    s->hunterBit = (int)(i % 2); i /= 2;
+    s->device = (int)(i % MD_COUNT); i /= MD_COUNT;
+    s->collected = (int)(i % 4); i /= 4;
+    s->returning = (int)(i % 2); i /= 2;
+    s->hunter = (int)(i % mk->rooms); i /= mk->rooms;
+    s->ghost = (int)i;
+}
+
+static void markov_emit(struct Markov* mk, const struct MarkovState* s, double p) {
+    if (p > 0) mk->target[markov_index(mk, s)] += p;
+}
+
+// The hunter steps to room n. Its old room goes back into the pool unless the ghost keeps it tracked,
+// and the new room's evidence is drawn from the pool of the R - 1 rooms other than the ghost's.
+static void markov_move_hunter(struct Markov* mk, struct MarkovState s, int n, double p) {
+    int pool = s.others;
+    if (s.hunter == s.ghost) {
+        s.ghostBit = s.hunterBit;
+    } else {
+        pool += s.hunterBit;
+    }
+    s.hunter = n;
+
+    if (n == s.ghost) {
+        s.hunterBit = s.ghostBit;
+        s.ghostBit = 0;
+        s.others = pool;
+        markov_emit(mk, &s, p);
+        return;
+    }
+
+    double hit = (double)pool / (mk->rooms - 1);
+    s.hunterBit = 1;
+    s.others = pool - 1;
+    markov_emit(mk, &s, p * hit);
+    s.hunterBit = 0;
+    s.others = pool;
+    markov_emit(mk, &s, p * (1 - hit));
+}
+
+// Pick up evidence, then wander unless heading back
+static void markov_gather_and_move(struct Markov* mk, struct MarkovState s, double p) {
+    if (s.device != MD_NONE && s.hunterBit) {
+        s.hunterBit = 0;
+        if (s.device == MD_NEW) {
+            s.collected++;
+            s.device = MD_OLD;
+        }
+        if (s.hunter != mk->van) s.returning = 1;
+    }
+
+    if (s.returning) {
+        markov_emit(mk, &s, p);
+        return;
+    }
+
+    int degree = mk->layout->numConnections[s.hunter];
+    for (int i = 0; i < degree; i++) {
+        markov_move_hunter(mk, s, mk->layout->connected[s.hunter][i], p / degree);
+    }
+}
+
+static void markov_hunter_step(struct Markov* mk, struct MarkovState s, double p) {
+    if (s.returning && s.hunter != mk->van) {
+        markov_move_hunter(mk, s, mk->nextHop[s.hunter], p);
+        return;
+    }
+
+    if (!s.returning) {
+        markov_gather_and_move(mk, s, p);
+        return;
+    }
+
+    // back in the van
+    if (s.collected == 3) {
+        mk->solved += p;
+        mk->win += p;
+        mk->collectedAtExit[3] += p;
+        mk->ticks += p * (mk->boredomMax + 1 - mk->boredom); // the ghost runs out its boredom alone
+        return;
+    }
+
+    // swap to one of the 6 other devices: the held type is collected, (3 - c) ghost types are not
+    s.returning = 0;
+    double share[MD_COUNT] = { (3 - s.collected) / 6.0, (s.collected - 1) / 6.0, 4 / 6.0 };
+    for (int d = 0; d < MD_COUNT; d++) {
+        struct MarkovState swapped = s;
+        swapped.device = d;
+        if (d == MD_NONE) {
+            swapped.hunterBit = swapped.ghostBit = swapped.others = 0;
+        }
+        markov_gather_and_move(mk, swapped, p * share[d]);
+    }
+}
+
+// One tick from state s: the ghost acts, then the hunter
+static void markov_expand(struct Markov* mk, const struct MarkovState* s, double p, bool together) {
+    bool haunts = s->device != MD_NONE;
+    int choices = together ? 2 : 3;
+    double each = p / choices;
+
+    // idle
+    markov_hunter_step(mk, *s, each);
+
+    // haunt: the held type one time in three
+    if (haunts) {
+        struct MarkovState left = *s;
+        if (together) left.hunterBit = 1;
+        else left.ghostBit = 1;
+        markov_hunter_step(mk, left, each / 3);
+        markov_hunter_step(mk, *s, each * 2 / 3);
+    } else {
+        markov_hunter_step(mk, *s, each);
+    }
+
+    // move: only when alone, so the old room always returns to the pool
+    if (!together) {
+        int degree = mk->layout->numConnections[s->ghost];
+        for (int i = 0; i < degree; i++) {
+            int n = mk->layout->connected[s->ghost][i];
+            double q = each / degree;
+            struct MarkovState moved = *s;
+            int pool = s->others + s->ghostBit;
+            moved.ghost = n;
+
+            if (n == s->hunter) {
+                moved.ghostBit = 0;
+                moved.others = pool;
+                markov_hunter_step(mk, moved, q);
+                continue;
+            }
+
+            double hit = (double)pool / (mk->rooms - 1);
+            moved.ghostBit = 1;
+            moved.others = pool - 1;
+            markov_hunter_step(mk, moved, q * hit);
+            moved.ghostBit = 0;
+            moved.others = pool;
+            markov_hunter_step(mk, moved, q * (1 - hit));
+        }
+    }
+}
+
+static void markov_exit(struct Markov* mk, const struct MarkovState* s, double p, bool afraid) {
+    if (afraid) mk->afraid += p;
+    else mk->bored += p;
+    if (s->collected == 3) mk->win += p;
+    mk->collectedAtExit[s->collected] += p;
+    if (afraid) mk->ticks += p * (mk->boredomMax + 1); // the ghost stays until it's bored
+}
+
+static void markov_solve(struct Markov* mk) {
+    size_t bytes = mk->layerSize * sizeof(double);
+    mk->current = calloc(mk->layerSize, sizeof(double));
+    mk->nextBoredom = calloc(mk->layerSize, sizeof(double));
+    mk->nextFear = calloc(mk->layerSize, sizeof(double));
+
+    // the hunter starts in the van with a random device, the ghost in a random room
+    for (int g = 0; g < mk->rooms; g++) {
+        struct MarkovState s = { .ghost = g, .hunter = mk->van, .device = MD_NEW };
+        mk->current[markov_index(mk, &s)] += 3.0 / 7.0 / mk->rooms;
+        s.device = MD_NONE;
+        mk->current[markov_index(mk, &s)] += 4.0 / 7.0 / mk->rooms;
+    }
+
+    for (int fear = 0; fear <= mk->fearMax; fear++) {
+        for (int boredom = 0; boredom <= mk->boredomMax; boredom++) {
+            for (size_t i = 0; i < mk->layerSize; i++) {
+                double p = mk->current[i];
+                if (p == 0) continue;
+
+                struct MarkovState s;
+                markov_decode(mk, i, &s);
+                bool together = s.ghost == s.hunter;
+                mk->ticks += p;
+
+                if (together && fear + 1 > mk->fearMax) {
+                    markov_exit(mk, &s, p, true);
+                } else if (!together && boredom + 1 > mk->boredomMax) {
+                    markov_exit(mk, &s, p, false);
+                } else {
+                    mk->target = together ? mk->nextFear : mk->nextBoredom;
+                    mk->boredom = together ? 0 : boredom + 1;
+                    markov_expand(mk, &s, p, together);
+                }
+            }
+
+            // (fear, boredom + 1) is next; the finished layer is reused for it
+            double* done = mk->current;
+            memset(done, 0, bytes);
+            mk->current = mk->nextBoredom;
+            mk->nextBoredom = done;
+        }
+
+        // nothing can be left past the boredom limit; the next fear level starts at boredom 0
+        double* done = mk->current;
+        memset(done, 0, bytes);
+        mk->current = mk->nextFear;
+        mk->nextFear = done;
+    }
+
+    free(mk->current);
+    free(mk->nextBoredom);
+    free(mk->nextFear);
+}
+
+// Breadth-first next hop from every room towards the van
+static void markov_routes(struct Markov* mk) {
+    int queue[MAX_ROOMS];
+    bool seen[MAX_ROOMS] = {false};
+    int head = 0, tail = 0;
+    queue[tail++] = mk->van;
+    seen[mk->van] = true;
+    mk->nextHop[mk->van] = (RoomId)mk->van;
+    while (head < tail) {
+        int room = queue[head++];
+        for (int i = 0; i < mk->layout->numConnections[room]; i++) {
+            int n = mk->layout->connected[room][i];
+            if (seen[n]) continue;
+            seen[n] = true;
+            mk->nextHop[n] = (RoomId)room;
+            queue[tail++] = n;
+        }
+    }
+}
+
+// Probability that one hunter's collected evidence misses every type of a given k-type set;
+// by symmetry a hunter holding c types holds each c-subset equally often
+static double markov_miss(const double* collected, int k) {
+    static const double choose[4][4] = { {1, 0, 0, 0}, {1, 1, 0, 0}, {1, 2, 1, 0}, {1, 3, 3, 1} };
+    double miss = 0;
+    for (int c = 0; c <= 3; c++) {
+        if (c <= 3 - k) miss += collected[c] * choose[3 - k][c] / choose[3][c];
+    }
+    return miss;
+}
+
+static double power(double x, int n) {
+    double result = 1;
+    while (n-- > 0) result *= x;
+    return result;
+}
+
+static void markov_usage(void) {
+    fprintf(stderr,
+            "Usage: huntSimulation --analytic [options]\n"
+            "  --hunters N     hunters (default 1; more than one uses the independent-hunter approximation)\n"
+            "  --boredom N     boredom limit (default %d)\n"
+            "  --fear N        fear limit (default %d)\n"
+            "  --rooms N       generated house with N rooms, at most %d (default: Willow House)\n"
+            "  --seed S        seed for the generated layout\n"
+            "  --check N       also run N simulations of Willow House, report how far each figure is from\n"
+            "                  the sampled one, and exit with status 1 past %.0f standard errors\n",
+            ENTITY_BOREDOM_MAX, HUNTER_FEAR_MAX, MARKOV_MAX_ROOMS, MARKOV_CHECK_SIGMAS);
+}
+
+// One figure compared with --check
+struct MarkovFigure {
+    const char* name;
+    double model;
+    double sum;       // of the sampled per-run values
+    double sumSquares;
+    bool proportion;  // a per-run 0/1 outcome; its standard error comes from the model's value
+};
+
+// Print how far the model is from the samples; returns false when it's past MARKOV_CHECK_SIGMAS
+static bool markov_compare(const struct MarkovFigure* figure, int runs) {
+    double sampled = figure->sum / runs;
+    double variance;
+    if (figure->proportion) {
+        // if the model were right, the sampled rate would spread by p(1 - p) / runs
+        variance = figure->model * (1 - figure->model);
+    } else {
+        variance = runs > 1 ? (figure->sumSquares - figure->sum * sampled) / (runs - 1) : 0;
+    }
+    double error = variance > 0 ? sqrt(variance / runs) : 0;
+    double deviation = figure->model - sampled;
+    bool within = error > 0 ? fabs(deviation) <= MARKOV_CHECK_SIGMAS * error : fabs(deviation) < 1e-9;
+
+    char sigmas[16] = "-";
+    if (error > 0) snprintf(sigmas, sizeof(sigmas), "%+.1f", deviation / error);
+    printf("  %-8s %10.4f %10.4f %+10.4f %9s  %s\n", figure->name, figure->model, sampled, deviation, sigmas,
+           within ? "ok" : "OUTSIDE");
+    return within;
+}
+
+// Sample the same parameters with the real threads; returns false if the model is off by more than sampling explains
+static bool markov_check(const struct Markov* mk, double teamWin, const struct SimConfig* base, int runs) {
+    static struct House house;
+    struct SimResult* result = malloc(sizeof(*result));
+    arenaInit(&house.arena, HOUSE_ARENA_SIZE);
+
+    // past one hunter the chain only predicts the team's win
+    bool single = base->hunterCount == 1;
+    struct MarkovFigure figures[] = {
+        { "win", single ? mk->win : teamWin, 0, 0, true },
+        { "solved", mk->solved, 0, 0, true },
+        { "afraid", mk->afraid, 0, 0, true },
+        { "bored", mk->bored, 0, 0, true },
+        { "ticks", mk->ticks, 0, 0, false },
+    };
+    int count = single ? (int)(sizeof(figures) / sizeof(figures[0])) : 1;
+
+    for (int r = 0; r < runs; r++) {
+        struct SimConfig config = *base;
+        config.seed = (unsigned)r + 1;
+        simulation_run(&house, &config, result);
+
+        double values[] = {
+            result->collected == (EvidenceByte)result->ghostType,
+            result->exitCounts[LR_EVIDENCE] > 0,
+            (double)result->exitCounts[LR_AFRAID] / result->hunterCount,
+            (double)result->exitCounts[LR_BORED] / result->hunterCount,
+            result->ticks,
+        };
+        for (int f = 0; f < count; f++) {
+            figures[f].sum += values[f];
+            figures[f].sumSquares += values[f] * values[f];
+        }
+    }
+
+    printf("Check against %d sampled run(s):\n  %-8s %10s %10s %10s %9s\n", runs, "", "model", "sampled", "model-samp", "std errs");
+    bool within = true;
+    for (int f = 0; f < count; f++) {
+        within &= markov_compare(&figures[f], runs);
+    }
+    if (!within) printf("The model is outside %.0f standard errors of the sampled simulation.\n", MARKOV_CHECK_SIGMAS);
+
+    arenaDestroy(&house.arena);
+    free(result);
+    return within;
+}
+
+int markov_main(int argc, char* argv[]) {
+    struct SimConfig config;
+    simulation_config_default(&config);
+    config.hunterCount = 1;
+    int checkRuns = 0;
+    unsigned layoutSeed = 1;
+
+    for (int i = 1; i < argc; i++) {
+        bool ok = i + 1 < argc;
+        if (ok && strcmp(argv[i], "--hunters") == 0) ok = simulation_parse_positive(argv[++i], &config.hunterCount);
+        else if (ok && strcmp(argv[i], "--boredom") == 0) ok = simulation_parse_positive(argv[++i], &config.boredomMax);
+        else if (ok && strcmp(argv[i], "--fear") == 0) ok = simulation_parse_positive(argv[++i], &config.fearMax);
+        else if (ok && strcmp(argv[i], "--rooms") == 0) ok = simulation_parse_positive(argv[++i], &config.roomCount);
+        else if (ok && strcmp(argv[i], "--seed") == 0) layoutSeed = (unsigned)strtoul(argv[++i], NULL, 10);
+        else if (ok && strcmp(argv[i], "--check") == 0) ok = simulation_parse_positive(argv[++i], &checkRuns);
+        else ok = false;
+
+        if (!ok || config.roomCount > MARKOV_MAX_ROOMS) {
+            markov_usage();
+            return 1;
+        }
+    }
+
+    static struct HouseTemplate layout;
+    rand_seed_threadsafe(layoutSeed);
+    house_template_init(&layout, config.roomCount);
+
+    static struct Markov mk;
+    mk.layout = &layout.layout;
+    mk.rooms = layout.layout.roomCount;
+    mk.van = layout.layout.start;
+    mk.boredomMax = config.boredomMax;
+    mk.fearMax = config.fearMax;
+    mk.layerSize = (size_t)mk.rooms * mk.rooms * 2 * 4 * MD_COUNT * 2 * 2 * mk.rooms;
+    markov_routes(&mk);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    markov_solve(&mk);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double ms = (double)(end.tv_sec - start.tv_sec) * 1000.0 + (double)(end.tv_nsec - start.tv_nsec) / 1e6;
+
+    printf("Markov model: %s (%d rooms), boredom %d, fear %d, %zu states per layer, %d layers, %.0f ms\n",
+           config.roomCount > 0 ? "generated house" : "Willow House", mk.rooms,
+           mk.boredomMax, mk.fearMax, mk.layerSize, (mk.fearMax + 1) * (mk.boredomMax + 1), ms);
+    printf("%-22s win %.4f, solved %.4f, afraid %.4f, bored %.4f, ticks %.2f\n",
+           "One hunter:", mk.win, mk.solved, mk.afraid, mk.bored, mk.ticks);
+
+    double team = mk.win;
+    if (config.hunterCount > 1) {
+        // inclusion-exclusion over the evidence types nobody found
+        int n = config.hunterCount;
+        team = 1 - 3 * power(markov_miss(mk.collectedAtExit, 1), n)
+                        + 3 * power(markov_miss(mk.collectedAtExit, 2), n)
+                        - power(markov_miss(mk.collectedAtExit, 3), n);
+        char label[32];
+        snprintf(label, sizeof(label), "%d independent hunters:", n);
+        printf("%-22s win %.4f\n", label, team);
+    }
+
+    if (checkRuns > 0) {
+        if (config.roomCount > 0) {
+            fprintf(stderr, "--check only samples Willow House\n");
+        } else {
+            log_set_sinks(0);
+            log_set_time_scale(0);
+            config.houseTemplate = &layout;
+            if (!markov_check(&mk, team, &config, checkRuns)) return 1;
+        }
+    }
+    return 0;
+}
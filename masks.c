@@ -0,0 +1,246 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "helpers.h"
+#include "masks.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MASKS_X86 1
+#endif
+
+static const char* const maskKernelNames[MK_COUNT] = { "scalar", "ssse3", "avx2" };
+
+// One bit per mask below EVIDENCE_MASKS: byte [mask & 15], bit [mask >> 4]
+struct MaskBitmap {
+    uint8_t rows[16];
+};
+
+static struct MaskBitmap validBitmap;  // mask is exactly a ghost's evidence
+static struct MaskBitmap namesBitmap;  // mask covers some ghost's evidence
+
+// Bit counts of 0..15
+static const uint8_t nibbleBits[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+// 1 << high nibble; valid masks never have bit 7, the names test ignores it
+static const uint8_t validHighBits[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 0, 0, 0, 0, 0, 0, 0, 0 };
+static const uint8_t namesHighBits[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+
+static enum MaskKernel kernel = MK_SCALAR;
+static pthread_once_t masksOnce = PTHREAD_ONCE_INIT;
+
+static bool bitmap_test(const struct MaskBitmap* bitmap, const uint8_t* highBits, EvidenceByte mask) {
+    return (bitmap->rows[mask & 15] & highBits[mask >> 4]) != 0;
+}
+
+static bool kernel_supported(enum MaskKernel wanted) {
+#ifdef MASKS_X86
+    __builtin_cpu_init();
+    if (wanted == MK_AVX2) return __builtin_cpu_supports("avx2");
+    if (wanted == MK_SSSE3) return __builtin_cpu_supports("ssse3");
+#endif
+    return wanted == MK_SCALAR;
+}
+
+static void masks_init(void) {
+    for (int mask = 0; mask < EVIDENCE_MASKS; mask++) {
+        if (evidence_is_valid_ghost((EvidenceByte)mask)) validBitmap.rows[mask & 15] |= validHighBits[mask >> 4];
+        if (evidence_names_ghost((EvidenceByte)mask)) namesBitmap.rows[mask & 15] |= namesHighBits[mask >> 4];
+    }
+
+    kernel = MK_SCALAR;
+    for (int k = MK_COUNT - 1; k > MK_SCALAR; k--) {
+        if (kernel_supported((enum MaskKernel)k)) {
+            kernel = (enum MaskKernel)k;
+            break;
+        }
+    }
+
+    const char* forced = getenv("HUNT_MASKS");
+    if (forced) {
+        int k = 0;
+        while (k < MK_COUNT && strcmp(forced, maskKernelNames[k]) != 0) k++;
+        if (k == MK_COUNT || !kernel_supported((enum MaskKernel)k)) {
+            fprintf(stderr, "HUNT_MASKS=%s: not available, using %s\n", forced, maskKernelNames[kernel]);
+        } else {
+            kernel = (enum MaskKernel)k;
+        }
+    }
+}
+
+bool masks_use_kernel(enum MaskKernel wanted) {
+    pthread_once(&masksOnce, masks_init);
+    if (wanted < 0 || wanted >= MK_COUNT || !kernel_supported(wanted)) return false;
+    kernel = wanted;
+    return true;
+}
+
+enum MaskKernel masks_kernel(void) {
+    pthread_once(&masksOnce, masks_init);
+    return kernel;
+}
+
+const char* masks_kernel_name(enum MaskKernel which) {
+    return which >= 0 && which < MK_COUNT ? maskKernelNames[which] : "?";
+}
+
+// ---- Kernels ----
+
+enum MaskOp {
+    MO_COUNT_BITS = 0,
+    MO_THREE_UNIQUE,
+    MO_VALID_GHOST,
+    MO_TO_GHOST,
+    MO_NAMES_GHOST
+};
+
+static uint8_t op_scalar(enum MaskOp op, EvidenceByte mask) {
+    uint8_t bits = (uint8_t)(nibbleBits[mask & 15] + nibbleBits[mask >> 4]);
+    switch (op) {
+        case MO_COUNT_BITS:   return bits;
+        case MO_THREE_UNIQUE: return bits >= 3;
+        case MO_VALID_GHOST:  return bitmap_test(&validBitmap, validHighBits, mask);
+        case MO_TO_GHOST:     return bitmap_test(&validBitmap, validHighBits, mask) ? mask : 0;
+        case MO_NAMES_GHOST:  return bitmap_test(&namesBitmap, namesHighBits, mask);
+    }
+    return 0;
+}
+
+static size_t op_scalar_run(enum MaskOp op, const EvidenceByte* masks, uint8_t* out, size_t from, size_t n) {
+    for (size_t i = from; i < n; i++) out[i] = op_scalar(op, masks[i]);
+    return n;
+}
+
+#ifdef MASKS_X86
+
+__attribute__((target("ssse3")))
+static size_t op_ssse3(enum MaskOp op, const EvidenceByte* masks, uint8_t* out, size_t n) {
+    const __m128i lowNibble = _mm_set1_epi8(0x0F);
+    const __m128i one = _mm_set1_epi8(1);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i counts = _mm_loadu_si128((const __m128i*)nibbleBits);
+    const bool names = op == MO_NAMES_GHOST;
+    const __m128i rows = _mm_loadu_si128((const __m128i*)(names ? namesBitmap.rows : validBitmap.rows));
+    const __m128i highBits = _mm_loadu_si128((const __m128i*)(names ? namesHighBits : validHighBits));
+
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(masks + i));
+        __m128i lo = _mm_and_si128(v, lowNibble);
+        __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), lowNibble);
+        __m128i result;
+        if (op == MO_COUNT_BITS || op == MO_THREE_UNIQUE) {
+            result = _mm_add_epi8(_mm_shuffle_epi8(counts, lo), _mm_shuffle_epi8(counts, hi));
+            if (op == MO_THREE_UNIQUE) result = _mm_and_si128(_mm_cmpgt_epi8(result, _mm_set1_epi8(2)), one);
+        } else {
+            __m128i hit = _mm_and_si128(_mm_shuffle_epi8(rows, lo), _mm_shuffle_epi8(highBits, hi));
+            __m128i miss = _mm_cmpeq_epi8(hit, zero);
+            result = _mm_andnot_si128(miss, op == MO_TO_GHOST ? v : one);
+        }
+        _mm_storeu_si128((__m128i*)(out + i), result);
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t op_avx2(enum MaskOp op, const EvidenceByte* masks, uint8_t* out, size_t n) {
+    const __m256i lowNibble = _mm256_set1_epi8(0x0F);
+    const __m256i one = _mm256_set1_epi8(1);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i counts = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)nibbleBits));
+    const bool names = op == MO_NAMES_GHOST;
+    const __m256i rows = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)(names ? namesBitmap.rows : validBitmap.rows)));
+    const __m256i highBits = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)(names ? namesHighBits : validHighBits)));
+
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(masks + i));
+        __m256i lo = _mm256_and_si256(v, lowNibble);
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), lowNibble);
+        __m256i result;
+        if (op == MO_COUNT_BITS || op == MO_THREE_UNIQUE) {
+            result = _mm256_add_epi8(_mm256_shuffle_epi8(counts, lo), _mm256_shuffle_epi8(counts, hi));
+            if (op == MO_THREE_UNIQUE) result = _mm256_and_si256(_mm256_cmpgt_epi8(result, _mm256_set1_epi8(2)), one);
+        } else {
+            __m256i hit = _mm256_and_si256(_mm256_shuffle_epi8(rows, lo), _mm256_shuffle_epi8(highBits, hi));
+            __m256i miss = _mm256_cmpeq_epi8(hit, zero);
+            result = _mm256_andnot_si256(miss, op == MO_TO_GHOST ? v : one);
+        }
+        _mm256_storeu_si256((__m256i*)(out + i), result);
+    }
+    return i;
+}
+
+__attribute__((target("ssse3")))
+static size_t contains_ssse3(const EvidenceByte* masks, const EvidenceByte* required, uint8_t* out, size_t n) {
+    const __m128i one = _mm_set1_epi8(1);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i m = _mm_loadu_si128((const __m128i*)(masks + i));
+        __m128i r = _mm_loadu_si128((const __m128i*)(required + i));
+        _mm_storeu_si128((__m128i*)(out + i), _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(m, r), r), one));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t contains_avx2(const EvidenceByte* masks, const EvidenceByte* required, uint8_t* out, size_t n) {
+    const __m256i one = _mm256_set1_epi8(1);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i m = _mm256_loadu_si256((const __m256i*)(masks + i));
+        __m256i r = _mm256_loadu_si256((const __m256i*)(required + i));
+        _mm256_storeu_si256((__m256i*)(out + i), _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_and_si256(m, r), r), one));
+    }
+    return i;
+}
+
+#endif // MASKS_X86
+
+// Vector body with the selected kernel, then the scalar tail
+static void op_run(enum MaskOp op, const EvidenceByte* masks, uint8_t* out, size_t n) {
+    size_t done = 0;
+#ifdef MASKS_X86
+    switch (masks_kernel()) {
+        case MK_AVX2:  done = op_avx2(op, masks, out, n); break;
+        case MK_SSSE3: done = op_ssse3(op, masks, out, n); break;
+        default: break;
+    }
+#else
+    masks_kernel();
+#endif
+    op_scalar_run(op, masks, out, done, n);
+}
+
+void masks_count_bits(const EvidenceByte* masks, uint8_t* out, size_t n) {
+    op_run(MO_COUNT_BITS, masks, out, n);
+}
+
+void masks_three_unique(const EvidenceByte* masks, uint8_t* out, size_t n) {
+    op_run(MO_THREE_UNIQUE, masks, out, n);
+}
+
+void masks_valid_ghost(const EvidenceByte* masks, uint8_t* out, size_t n) {
+    op_run(MO_VALID_GHOST, masks, out, n);
+}
+
+void masks_to_ghost(const EvidenceByte* masks, uint8_t* out, size_t n) {
+    op_run(MO_TO_GHOST, masks, out, n);
+}
+
+void masks_names_ghost(const EvidenceByte* masks, uint8_t* out, size_t n) {
+    op_run(MO_NAMES_GHOST, masks, out, n);
+}
+
+void masks_contains(const EvidenceByte* masks, const EvidenceByte* required, uint8_t* out, size_t n) {
+    size_t i = 0;
+#ifdef MASKS_X86
+    switch (masks_kernel()) {
+        case MK_AVX2:  i = contains_avx2(masks, required, out, n); break;
+        case MK_SSSE3: i = contains_ssse3(masks, required, out, n); break;
+        default: break;
+    }
+#endif
+    for (; i < n; i++) out[i] = (masks[i] & required[i]) == required[i];
+}
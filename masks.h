@@ -0,0 +1,97 @@
+#ifndef MASKS_H
+#define MASKS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "defs.h"
+
+/*
+    Batched evidence-mask kernels.
+
+    Array-in / array-out versions of the evidence helpers, for scoring many case files at once (results
+    files, sweeps, the batch engines). Each output byte is the answer for the mask at the same index;
+    the flag kernels write 0 or 1. Input and output may be the same array.
+
+    Both ghost tests are 128-entry bitmaps, looked up 16 or 32 masks at a time with byte shuffles: the
+    low nibble of a mask picks a byte of the bitmap, the high nibble picks the bit. Counts use a
+    shuffle over a nibble popcount table. The kernel is chosen on first use from the CPU (AVX2, then
+    SSSE3, then scalar table lookups); HUNT_MASKS=scalar|ssse3|avx2 in the environment overrides it.
+*/
+
+enum MaskKernel {
+    MK_SCALAR = 0,
+    MK_SSSE3,
+    MK_AVX2,
+    MK_COUNT
+};
+
+/**
+ * @brief Pick the kernel used by every masks_* call.
+ * @param[in] kernel Kernel to use.
+ * @return false, leaving the kernel unchanged, if this CPU or build can't run it.
+ */
+bool masks_use_kernel(enum MaskKernel kernel);
+
+/**
+ * @brief The kernel in use, selecting one first if needed.
+ * @return Kernel in use.
+ */
+enum MaskKernel masks_kernel(void);
+
+/**
+ * @brief Name of a kernel, e.g. "avx2".
+ * @param[in] kernel Kernel.
+ * @return Static string.
+ */
+const char* masks_kernel_name(enum MaskKernel kernel);
+
+/**
+ * @brief Count the evidence bits of each mask.
+ * @param[in] masks Masks.
+ * @param[out] out Bit counts.
+ * @param[in] n Number of masks.
+ */
+void masks_count_bits(const EvidenceByte* masks, uint8_t* out, size_t n);
+
+/**
+ * @brief Batched evidence_has_three_unique.
+ * @param[in] masks Masks.
+ * @param[out] out 1 where a mask has three or more bits set.
+ * @param[in] n Number of masks.
+ */
+void masks_three_unique(const EvidenceByte* masks, uint8_t* out, size_t n);
+
+/**
+ * @brief Batched evidence_is_valid_ghost.
+ * @param[in] masks Masks.
+ * @param[out] out 1 where a mask is exactly a ghost's evidence.
+ * @param[in] n Number of masks.
+ */
+void masks_valid_ghost(const EvidenceByte* masks, uint8_t* out, size_t n);
+
+/**
+ * @brief Batched mask_to_ghost.
+ * @param[in] masks Masks.
+ * @param[out] out The enum GhostType each mask names, 0 where it names none.
+ * @param[in] n Number of masks.
+ */
+void masks_to_ghost(const EvidenceByte* masks, uint8_t* out, size_t n);
+
+/**
+ * @brief Batched van-arrival check: does a case file hold all the evidence of some ghost.
+ * @param[in] masks Case files.
+ * @param[out] out 1 where some ghost's evidence is all present.
+ * @param[in] n Number of masks.
+ */
+void masks_names_ghost(const EvidenceByte* masks, uint8_t* out, size_t n);
+
+/**
+ * @brief Pairwise superset test, (masks[i] & required[i]) == required[i].
+ * @param[in] masks Masks, e.g. case files.
+ * @param[in] required Masks that must be covered, e.g. each run's ghost type.
+ * @param[out] out 1 where masks[i] covers required[i].
+ * @param[in] n Number of masks.
+ */
+void masks_contains(const EvidenceByte* masks, const EvidenceByte* required, uint8_t* out, size_t n);
+
+#endif // MASKS_H
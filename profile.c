@@ -0,0 +1,136 @@
+#include <stdlib.h>
+#include <math.h>
+#include <pthread.h>
+#include "profile.h"
+#include "lockdebug.h"
+
+bool profile_enabled = false;
+
+static const char* profileActionNames[PA_COUNT] = {
+#define X(name, text) text,
+    PROFILE_ACTIONS(X)
+#undef X
+};
+
+// One action's samples; counts are per bucket
+struct ProfileHistogram {
+    uint64_t count;
+    uint64_t total;
+    uint64_t max;
+    uint64_t buckets[PROFILE_BUCKETS];
+};
+
+// This thread's histograms, allocated on the first sample of each action and freed by profileFlush
+static _Thread_local struct ProfileHistogram* threadHistograms[PA_COUNT];
+
+// Every exited thread's samples
+static struct ProfileHistogram totals[PA_COUNT];
+static pthread_mutex_t totalsMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static double ticksPerNs = 1.0;
+
+static uint64_t monotonic_raw_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+void profile_set_enabled(bool enabled) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (enabled && !profile_enabled) {
+        uint64_t startNs = monotonic_raw_ns();
+        uint64_t startTicks = profileNow();
+        struct timespec pause = {0, 20 * 1000 * 1000};
+        nanosleep(&pause, NULL);
+        uint64_t ns = monotonic_raw_ns() - startNs;
+        uint64_t ticks = profileNow() - startTicks;
+        if (ns > 0 && ticks > 0) ticksPerNs = (double)ticks / (double)ns;
+    }
+#endif
+    profile_enabled = enabled;
+}
+
+// Values below 2 * PROFILE_SUB get a bucket each; above that, PROFILE_SUB buckets per power of two
+static int bucket_of(uint64_t value) {
+    if (value >= (1ull << PROFILE_MAX_BITS)) value = (1ull << PROFILE_MAX_BITS) - 1;
+    if (value < 2 * PROFILE_SUB) return (int)value;
+    int exponent = 63 - __builtin_clzll(value) - PROFILE_SUB_BITS;
+    return exponent * PROFILE_SUB + (int)(value >> exponent);
+}
+
+// Largest value that falls in a bucket
+static uint64_t bucket_upper(int bucket) {
+    if (bucket < 2 * PROFILE_SUB) return (uint64_t)bucket;
+    int exponent = bucket / PROFILE_SUB - 1;
+    uint64_t mantissa = (uint64_t)(bucket - exponent * PROFILE_SUB);
+    return ((mantissa + 1) << exponent) - 1;
+}
+
+void profileRecord(enum ProfileAction action, uint64_t ticks) {
+    struct ProfileHistogram* histogram = threadHistograms[action];
+    if (!histogram) {
+        histogram = calloc(1, sizeof(*histogram));
+        if (!histogram) return;
+        threadHistograms[action] = histogram;
+    }
+    histogram->count++;
+    histogram->total += ticks;
+    if (ticks > histogram->max) histogram->max = ticks;
+    histogram->buckets[bucket_of(ticks)]++;
+}
+
+void profileFlush(void) {
+    bool any = false;
+    for (int a = 0; a < PA_COUNT; a++) any |= threadHistograms[a] != NULL;
+    if (!any) return;
+
+    MUTEX_LOCK(&totalsMutex, LC_PROFILE, -1);
+    for (int a = 0; a < PA_COUNT; a++) {
+        const struct ProfileHistogram* from = threadHistograms[a];
+        if (!from) continue;
+        struct ProfileHistogram* to = &totals[a];
+        to->count += from->count;
+        to->total += from->total;
+        if (from->max > to->max) to->max = from->max;
+        for (int b = 0; b < PROFILE_BUCKETS; b++) to->buckets[b] += from->buckets[b];
+    }
+    MUTEX_UNLOCK(&totalsMutex);
+
+    for (int a = 0; a < PA_COUNT; a++) {
+        free(threadHistograms[a]);
+        threadHistograms[a] = NULL;
+    }
+}
+
+// Smallest bucket bound covering the given fraction of samples, capped at the largest sample
+static uint64_t histogram_percentile(const struct ProfileHistogram* histogram, double fraction) {
+    uint64_t rank = (uint64_t)ceil(fraction * (double)histogram->count);
+    if (rank < 1) rank = 1;
+    uint64_t seen = 0;
+    for (int b = 0; b < PROFILE_BUCKETS; b++) {
+        seen += histogram->buckets[b];
+        if (seen >= rank) {
+            uint64_t upper = bucket_upper(b);
+            return upper < histogram->max ? upper : histogram->max;
+        }
+    }
+    return histogram->max;
+}
+
+void profile_print(FILE* out) {
+    profileFlush(); // the calling thread's own samples, e.g. log_hunter_init
+    MUTEX_LOCK(&totalsMutex, LC_PROFILE, -1);
+    fprintf(out, "%-20s %12s %12s %12s %12s %12s\n", "action", "count", "mean ns", "p50 ns", "p99 ns", "max ns");
+    for (int a = 0; a < PA_COUNT; a++) {
+        const struct ProfileHistogram* histogram = &totals[a];
+        if (histogram->count == 0) continue;
+        fprintf(out, "%-20s %12llu %12.0f %12.0f %12.0f %12.0f\n",
+                profileActionNames[a],
+                (unsigned long long)histogram->count,
+                (double)histogram->total / (double)histogram->count / ticksPerNs,
+                (double)histogram_percentile(histogram, 0.50) / ticksPerNs,
+                (double)histogram_percentile(histogram, 0.99) / ticksPerNs,
+                (double)histogram->max / ticksPerNs);
+    }
+    MUTEX_UNLOCK(&totalsMutex);
+}
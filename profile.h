@@ -0,0 +1,99 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/*
+    Per-action latency profiler, turned on with --profile.
+
+    Each entity thread keeps one log-linear histogram per action (PROFILE_SUB_BITS significant bits,
+    so every bucket is within 1/16 of its value) and adds it to the process-wide histograms when it
+    exits. Times are read from the TSC on x86 and from CLOCK_MONOTONIC_RAW elsewhere; TSC ticks are
+    converted to nanoseconds with a rate measured when profiling is turned on.
+
+    While profiling is off each PROFILE_BEGIN/PROFILE_END pair costs one predictable branch.
+*/
+
+// X(NAME, text): every timed action; PA_<NAME> indexes the histograms
+#define PROFILE_ACTIONS(X) \
+    X(HUNTER_MOVE,          "hunterMove")          \
+    X(GHOST_HAUNT,          "ghostHaunt")          \
+    X(GHOST_MOVE,           "ghostMove")           \
+    X(GHOST_IDLE,           "ghostIdle")           \
+    X(PICKUP,               "evidence pickup")     \
+    X(VAN_CHECK,            "van arrival check")   \
+    X(LOCK_ROOMS,           "lockRooms")           \
+    X(ROOM_LOCK,            "roomLock")            \
+    X(LOG_MOVE,             "log_move")            \
+    X(LOG_EVIDENCE,         "log_evidence")        \
+    X(LOG_SWAP,             "log_swap")            \
+    X(LOG_EXIT,             "log_exit")            \
+    X(LOG_RETURN_TO_VAN,    "log_return_to_van")   \
+    X(LOG_HUNTER_INIT,      "log_hunter_init")     \
+    X(LOG_GHOST_INIT,       "log_ghost_init")      \
+    X(LOG_GHOST_MOVE,       "log_ghost_move")      \
+    X(LOG_GHOST_EVIDENCE,   "log_ghost_evidence")  \
+    X(LOG_GHOST_EXIT,       "log_ghost_exit")      \
+    X(LOG_GHOST_IDLE,       "log_ghost_idle")
+
+enum ProfileAction {
+#define X(name, text) PA_##name,
+    PROFILE_ACTIONS(X)
+#undef X
+    PA_COUNT
+};
+
+#define PROFILE_SUB_BITS 4
+#define PROFILE_SUB (1 << PROFILE_SUB_BITS)
+#define PROFILE_MAX_BITS 40 // longer samples (about 6 minutes of TSC ticks) land in the last bucket
+#define PROFILE_BUCKETS ((PROFILE_MAX_BITS - PROFILE_SUB_BITS + 1) * PROFILE_SUB)
+
+extern bool profile_enabled;
+
+// Timestamp in TSC ticks, or in nanoseconds where there is no TSC
+static inline uint64_t profileNow(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+// Time the code between the two; var names the start timestamp
+#define PROFILE_BEGIN(var) uint64_t var = profile_enabled ? profileNow() : 0
+#define PROFILE_END(var, action) \
+    do { if (profile_enabled) profileRecord((action), profileNow() - (var)); } while (0)
+
+/**
+ * @brief Turn profiling on or off; turning it on measures the TSC rate (about 20 ms).
+ * @param[in] enabled true to time actions.
+ */
+void profile_set_enabled(bool enabled);
+
+/**
+ * @brief Add one sample to this thread's histogram for an action.
+ * @param[in] action Action timed.
+ * @param[in] ticks Duration in profileNow units.
+ */
+void profileRecord(enum ProfileAction action, uint64_t ticks);
+
+/**
+ * @brief Add this thread's histograms to the process-wide ones and free them. Called when an entity thread exits.
+ */
+void profileFlush(void);
+
+/**
+ * @brief Print count, mean, p50, p99 and max in nanoseconds for every action that was sampled.
+ * @param[in] out Stream to print to.
+ */
+void profile_print(FILE* out);
+
+#endif // PROFILE_H
@@ -0,0 +1,618 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "defs.h"
+#include "logseg.h"
+
+/*
+    replayLogs: reconstruct the House at any moment of a run from its log_<id> files and segments.
+
+    Every row is parsed once into a small fixed-size event, and the events of all entities are merged
+    into one timeline ordered by timestamp. Rows in the same millisecond keep their file order within
+    an entity and put the ghost first, so evidence is left before it is picked up. The timeline is
+    then replayed once, storing the full state (room evidence, casefile and every entity's room,
+    device and status) before every N-th event.
+
+    A query binary searches the timeline for the last event at or before the requested time, copies
+    the nearest checkpoint at or before it and applies at most N - 1 events from there.
+
+    The logs are appended to across runs, so the directory should hold the logs of a single run.
+*/
+
+#define REPLAY_CHECKPOINT_EVENTS 1024
+#define ROOM_SLOTS 512 // open addressing table for room names, > 2 * MAX_ROOMS
+
+enum ReplayAction {
+    RA_INIT = 0,
+    RA_MOVE,
+    RA_EVIDENCE,
+    RA_SWAP,
+    RA_EXIT,
+    RA_RETURN_START,
+    RA_RETURN_COMPLETE,
+    RA_IDLE,
+    RA_OTHER,
+    RA_COUNT
+};
+
+static const char* actionNames[RA_COUNT] = {
+    "INIT", "MOVE", "EVIDENCE", "SWAP", "EXIT", "RETURN_START", "RETURN_COMPLETE", "IDLE", "?"
+};
+
+enum ReplayStatus {
+    RS_ABSENT = 0,   // no INIT row yet
+    RS_INVESTIGATING,
+    RS_RETURNING,
+    RS_LEFT
+};
+
+static const char* statusNames[] = { "not started", "investigating", "returning", "left" };
+
+static const struct { const char* text; EvidenceByte mask; } evidenceTexts[] = {
+#define EVIDENCE_TEXT(name, bit, text) { text, EV_##name },
+    EVIDENCE_TABLE(EVIDENCE_TEXT)
+#undef EVIDENCE_TEXT
+};
+
+static const struct { const char* text; EvidenceByte mask; } ghostTexts[] = {
+#define GHOST_TEXT(name, text, a, b, c) { text, GH_##name },
+    GHOST_TABLE(GHOST_TEXT)
+#undef GHOST_TEXT
+};
+
+// A slice of the mapped file
+struct Field {
+    const char* text;
+    int length;
+};
+
+// One log row, reduced to what changes the state
+struct ReplayEvent {
+    long long stamp;
+    uint32_t sequence;      // load order; keeps one entity's rows in file order
+    uint32_t entity;        // index into Replay.entities
+    uint8_t action;         // enum ReplayAction
+    bool ghost;
+    RoomId room;            // where the row happened
+    RoomId target;          // MOVE destination
+    EvidenceByte evidence;  // device for hunters, evidence left or ghost type for the ghost
+    bool solved;            // hunter EXIT with reason evidence
+};
+
+struct ReplayEntity {
+    bool ghost;
+    int id;
+};
+
+// Per-entity part of a state
+struct ReplayEntityState {
+    RoomId room;            // ROOM_NONE before INIT and after EXIT
+    EvidenceByte device;    // ghost type for the ghost
+    uint8_t status;         // enum ReplayStatus
+};
+
+struct ReplayState {
+    EvidenceByte collected;
+    bool solved;
+    EvidenceByte* evidence;            // per room
+    struct ReplayEntityState* entities;
+};
+
+struct Replay {
+    char roomNames[MAX_ROOMS][MAX_ROOM_NAME];
+    int roomCount;
+    int16_t roomSlots[ROOM_SLOTS];     // index into roomNames, -1 = empty
+
+    struct ReplayEntity* entities;
+    int entityCount;
+    int entityCapacity;
+
+    int* hunterOrder;                  // hunter entity indices sorted by id, for printing
+    int hunterCount;
+
+    struct ReplayEvent* events;
+    size_t eventCount;
+    size_t eventCapacity;
+    uint64_t badLines;
+
+    // checkpoint k is the state before event k * every
+    size_t every;
+    size_t checkpointCount;
+    struct ReplayState* checkpoints;
+};
+
+static uint32_t hash_field(struct Field field) {
+    uint32_t hash = 2166136261u; // FNV-1a
+    for (int i = 0; i < field.length; i++) {
+        hash = (hash ^ (uint8_t)field.text[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static bool field_equals(struct Field field, const char* text) {
+    size_t length = strlen(text);
+    return (size_t)field.length == length && memcmp(field.text, text, length) == 0;
+}
+
+static bool field_to_number(struct Field field, long long* value) {
+    if (field.length == 0) return false;
+    long long n = 0;
+    for (int i = 0; i < field.length; i++) {
+        if (field.text[i] < '0' || field.text[i] > '9') return false;
+        n = n * 10 + (field.text[i] - '0');
+    }
+    *value = n;
+    return true;
+}
+
+// Find or add a room by name; ROOM_NONE for an empty name or a full table
+static RoomId room_lookup(struct Replay* replay, struct Field name) {
+    if (name.length == 0) return ROOM_NONE;
+    if (name.length >= MAX_ROOM_NAME) name.length = MAX_ROOM_NAME - 1;
+
+    uint32_t slot = hash_field(name) % ROOM_SLOTS;
+    while (replay->roomSlots[slot] >= 0) {
+        const char* known = replay->roomNames[replay->roomSlots[slot]];
+        if (strncmp(known, name.text, (size_t)name.length) == 0 && known[name.length] == '\0') {
+            return (RoomId)replay->roomSlots[slot];
+        }
+        slot = (slot + 1) % ROOM_SLOTS;
+    }
+    if (replay->roomCount == MAX_ROOMS) return ROOM_NONE;
+
+    memcpy(replay->roomNames[replay->roomCount], name.text, (size_t)name.length);
+    replay->roomNames[replay->roomCount][name.length] = '\0';
+    replay->roomSlots[slot] = (int16_t)replay->roomCount;
+    return (RoomId)replay->roomCount++;
+}
+
+// A file normally holds one entity, so lookups only scan the entities it added
+static int entity_lookup(struct Replay* replay, int first, bool ghost, int id) {
+    for (int i = first; i < replay->entityCount; i++) {
+        if (replay->entities[i].ghost == ghost && replay->entities[i].id == id) return i;
+    }
+
+    if (replay->entityCount == replay->entityCapacity) {
+        int capacity = replay->entityCapacity ? replay->entityCapacity * 2 : 64;
+        struct ReplayEntity* grown = realloc(replay->entities, (size_t)capacity * sizeof(*grown));
+        if (grown == NULL) return -1;
+        replay->entities = grown;
+        replay->entityCapacity = capacity;
+    }
+
+    replay->entities[replay->entityCount] = (struct ReplayEntity){ .ghost = ghost, .id = id };
+    return replay->entityCount++;
+}
+
+static EvidenceByte evidence_from_field(struct Field field) {
+    for (size_t i = 0; i < sizeof(evidenceTexts) / sizeof(evidenceTexts[0]); i++) {
+        if (field_equals(field, evidenceTexts[i].text)) return evidenceTexts[i].mask;
+    }
+    return 0;
+}
+
+static EvidenceByte ghost_from_field(struct Field field) {
+    for (size_t i = 0; i < sizeof(ghostTexts) / sizeof(ghostTexts[0]); i++) {
+        if (field_equals(field, ghostTexts[i].text)) return ghostTexts[i].mask;
+    }
+    return 0;
+}
+
+static const char* ghost_name(EvidenceByte mask) {
+    for (size_t i = 0; i < sizeof(ghostTexts) / sizeof(ghostTexts[0]); i++) {
+        if (ghostTexts[i].mask == mask) return ghostTexts[i].text;
+    }
+    return "unknown";
+}
+
+static const char* evidence_name(EvidenceByte mask) {
+    for (size_t i = 0; i < sizeof(evidenceTexts) / sizeof(evidenceTexts[0]); i++) {
+        if (evidenceTexts[i].mask == mask) return evidenceTexts[i].text;
+    }
+    return "-";
+}
+
+// "emf, orbs" or "-"
+static void evidence_list(EvidenceByte mask, char* buffer, size_t size) {
+    size_t used = 0;
+    buffer[0] = '\0';
+    for (size_t i = 0; i < sizeof(evidenceTexts) / sizeof(evidenceTexts[0]); i++) {
+        if (!(mask & evidenceTexts[i].mask)) continue;
+        int written = snprintf(buffer + used, size - used, "%s%s", used ? ", " : "", evidenceTexts[i].text);
+        if (written < 0 || (size_t)written >= size - used) break;
+        used += (size_t)written;
+    }
+    if (used == 0) snprintf(buffer, size, "-");
+}
+
+static struct ReplayEvent* event_append(struct Replay* replay) {
+    if (replay->eventCount == replay->eventCapacity) {
+        size_t capacity = replay->eventCapacity ? replay->eventCapacity * 2 : 4096;
+        struct ReplayEvent* grown = realloc(replay->events, capacity * sizeof(*grown));
+        if (grown == NULL) return NULL;
+        replay->events = grown;
+        replay->eventCapacity = capacity;
+    }
+    return &replay->events[replay->eventCount++];
+}
+
+// timestamp,type,id,room,device,boredom,fear,action,extra - extra runs to the end of the line
+static void parse_line(struct Replay* replay, int firstEntity, const char* line, const char* end) {
+    struct Field fields[9];
+    int count = 0;
+    const char* start = line;
+    for (const char* p = line; p < end && count < 8; p++) {
+        if (*p == ',') {
+            fields[count++] = (struct Field){start, (int)(p - start)};
+            start = p + 1;
+        }
+    }
+    if (count < 8) {
+        replay->badLines++;
+        return;
+    }
+    fields[8] = (struct Field){start, (int)(end - start)};
+
+    long long stamp, id;
+    if (!field_to_number(fields[0], &stamp) || !field_to_number(fields[2], &id)) {
+        replay->badLines++;
+        return;
+    }
+
+    bool ghost = field_equals(fields[1], "ghost");
+    int entity = entity_lookup(replay, firstEntity, ghost, (int)id);
+    if (entity < 0) return;
+
+    enum ReplayAction action = RA_OTHER;
+    for (int a = 0; a < RA_OTHER; a++) {
+        if (field_equals(fields[7], actionNames[a])) action = (enum ReplayAction)a;
+    }
+
+    struct ReplayEvent* event = event_append(replay);
+    if (event == NULL) return;
+    *event = (struct ReplayEvent){
+        .stamp = stamp,
+        .sequence = (uint32_t)replay->eventCount,
+        .entity = (uint32_t)entity,
+        .action = (uint8_t)action,
+        .ghost = ghost,
+        .room = room_lookup(replay, fields[3]),
+        .target = ROOM_NONE
+    };
+
+    switch (action) {
+        case RA_INIT:
+            event->evidence = ghost ? ghost_from_field(fields[8]) : evidence_from_field(fields[4]);
+            break;
+        case RA_MOVE:
+            event->target = room_lookup(replay, fields[8]);
+            break;
+        case RA_EVIDENCE:
+            event->evidence = evidence_from_field(ghost ? fields[8] : fields[4]);
+            break;
+        case RA_SWAP:
+            event->evidence = evidence_from_field(fields[4]);
+            break;
+        case RA_EXIT:
+            event->solved = !ghost && field_equals(fields[8], "evidence");
+            break;
+        default:
+            break;
+    }
+}
+
+// One entity's log being parsed segment by segment
+struct LogParse {
+    struct Replay* replay;
+    int firstEntity;
+};
+
+static void parse_segment(void* context, const char* data, size_t length) {
+    struct LogParse* parse = context;
+    const char* end = data + length;
+    const char* line = data;
+    while (line < end) {
+        const char* newline = memchr(line, '\n', (size_t)(end - line));
+        const char* lineEnd = newline ? newline : end;
+        if (lineEnd > line) parse_line(parse->replay, parse->firstEntity, line, lineEnd);
+        line = lineEnd + 1;
+    }
+}
+
+// Parse every entity log in dir, segments in order; returns the number of logs, or -1 if the directory can't be read
+static int load_logs(struct Replay* replay, const char* dir) {
+    int* ids;
+    int count = segmentListEntities(dir, &ids);
+    for (int i = 0; i < count; i++) {
+        struct LogParse parse = { replay, replay->entityCount };
+        segmentForEach(dir, ids[i], parse_segment, &parse);
+    }
+    if (count >= 0) free(ids);
+    return count;
+}
+
+static int compare_events(const void* a, const void* b) {
+    const struct ReplayEvent* left = a;
+    const struct ReplayEvent* right = b;
+    if (left->stamp != right->stamp) return left->stamp < right->stamp ? -1 : 1;
+    if (left->ghost != right->ghost) return left->ghost ? -1 : 1;
+    return (left->sequence > right->sequence) - (left->sequence < right->sequence);
+}
+
+static const struct Replay* sortingReplay; // qsort has no context argument
+
+static int compare_hunters(const void* a, const void* b) {
+    int left = sortingReplay->entities[*(const int*)a].id;
+    int right = sortingReplay->entities[*(const int*)b].id;
+    return (left > right) - (left < right);
+}
+
+static void sort_hunters(struct Replay* replay) {
+    replay->hunterOrder = malloc((size_t)(replay->entityCount ? replay->entityCount : 1) * sizeof(int));
+    replay->hunterCount = 0;
+    for (int i = 0; i < replay->entityCount; i++) {
+        if (!replay->entities[i].ghost) replay->hunterOrder[replay->hunterCount++] = i;
+    }
+    sortingReplay = replay;
+    qsort(replay->hunterOrder, (size_t)replay->hunterCount, sizeof(int), compare_hunters);
+}
+
+static void state_alloc(const struct Replay* replay, struct ReplayState* state) {
+    state->collected = 0;
+    state->solved = false;
+    state->evidence = calloc((size_t)(replay->roomCount ? replay->roomCount : 1), sizeof(*state->evidence));
+    state->entities = calloc((size_t)(replay->entityCount ? replay->entityCount : 1), sizeof(*state->entities));
+    for (int i = 0; i < replay->entityCount; i++) state->entities[i].room = ROOM_NONE;
+}
+
+static void state_free(struct ReplayState* state) {
+    free(state->evidence);
+    free(state->entities);
+}
+
+static void state_copy(const struct Replay* replay, struct ReplayState* to, const struct ReplayState* from) {
+    to->collected = from->collected;
+    to->solved = from->solved;
+    memcpy(to->evidence, from->evidence, (size_t)replay->roomCount * sizeof(*to->evidence));
+    memcpy(to->entities, from->entities, (size_t)replay->entityCount * sizeof(*to->entities));
+}
+
+static void state_apply(struct ReplayState* state, const struct ReplayEvent* event) {
+    struct ReplayEntityState* entity = &state->entities[event->entity];
+    switch (event->action) {
+        case RA_INIT:
+            entity->room = event->room;
+            entity->device = event->evidence;
+            entity->status = RS_INVESTIGATING;
+            break;
+        case RA_MOVE:
+            entity->room = event->target;
+            break;
+        case RA_EVIDENCE:
+            if (event->room == ROOM_NONE) break;
+            if (event->ghost) {
+                state->evidence[event->room] |= event->evidence;
+            } else {
+                state->evidence[event->room] &= (EvidenceByte)~event->evidence;
+                state->collected |= event->evidence;
+            }
+            break;
+        case RA_SWAP:
+            entity->device = event->evidence;
+            break;
+        case RA_RETURN_START:
+            entity->status = RS_RETURNING;
+            break;
+        case RA_RETURN_COMPLETE:
+            entity->status = RS_INVESTIGATING;
+            break;
+        case RA_EXIT:
+            entity->room = ROOM_NONE;
+            entity->status = RS_LEFT;
+            if (event->solved) state->solved = true;
+            break;
+        default:
+            break;
+    }
+}
+
+// Replay the whole timeline once, keeping the state before every `every`-th event
+static bool build_checkpoints(struct Replay* replay) {
+    replay->checkpointCount = replay->eventCount / replay->every + 1;
+    replay->checkpoints = calloc(replay->checkpointCount, sizeof(*replay->checkpoints));
+    if (replay->checkpoints == NULL) return false;
+
+    struct ReplayState state;
+    state_alloc(replay, &state);
+    for (size_t i = 0; i <= replay->eventCount; i++) {
+        if (i % replay->every == 0) {
+            struct ReplayState* checkpoint = &replay->checkpoints[i / replay->every];
+            state_alloc(replay, checkpoint);
+            state_copy(replay, checkpoint, &state);
+        }
+        if (i < replay->eventCount) state_apply(&state, &replay->events[i]);
+    }
+    state_free(&state);
+    return true;
+}
+
+// Number of events at or before stamp
+static size_t events_until(const struct Replay* replay, long long stamp) {
+    size_t low = 0, high = replay->eventCount;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (replay->events[mid].stamp <= stamp) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+// Rebuild the state after the first `applied` events; returns the number of deltas applied
+static size_t seek(const struct Replay* replay, size_t applied, struct ReplayState* state) {
+    size_t checkpoint = applied / replay->every;
+    state_copy(replay, state, &replay->checkpoints[checkpoint]);
+    for (size_t i = checkpoint * replay->every; i < applied; i++) {
+        state_apply(state, &replay->events[i]);
+    }
+    return applied - checkpoint * replay->every;
+}
+
+static void print_state(const struct Replay* replay, const struct ReplayState* state) {
+    char list[128];
+    int ghost = -1;
+    for (int i = 0; i < replay->entityCount; i++) {
+        if (replay->entities[i].ghost) ghost = i;
+    }
+
+    if (ghost < 0) {
+        printf("Ghost: no log\n");
+    } else {
+        const struct ReplayEntityState* g = &state->entities[ghost];
+        if (g->status == RS_ABSENT) printf("Ghost: not in the house yet\n");
+        else if (g->status == RS_LEFT) printf("Ghost: %s, left\n", ghost_name(g->device));
+        else printf("Ghost: %s in %s\n", ghost_name(g->device), g->room == ROOM_NONE ? "?" : replay->roomNames[g->room]);
+    }
+
+    evidence_list(state->collected, list, sizeof(list));
+    printf("Case file: %s%s\n", list, state->solved ? " (solved)" : "");
+
+    int occupancy[MAX_ROOMS] = {0};
+    for (int i = 0; i < replay->entityCount; i++) {
+        if (!replay->entities[i].ghost && state->entities[i].room != ROOM_NONE) occupancy[state->entities[i].room]++;
+    }
+
+    printf("\n%-24s %8s %6s  %s\n", "Room", "Hunters", "Ghost", "Evidence");
+    for (int r = 0; r < replay->roomCount; r++) {
+        bool haunted = ghost >= 0 && state->entities[ghost].room == r;
+        evidence_list(state->evidence[r], list, sizeof(list));
+        printf("%-24s %8d %6s  %s\n", replay->roomNames[r], occupancy[r], haunted ? "*" : "", list);
+    }
+
+    printf("\n%-8s %-24s %-12s %s\n", "Hunter", "Room", "Device", "State");
+    for (int n = 0; n < replay->hunterCount; n++) {
+        int i = replay->hunterOrder[n];
+        const struct ReplayEntityState* h = &state->entities[i];
+        printf("%-8d %-24s %-12s %s\n", replay->entities[i].id,
+               h->room == ROOM_NONE ? "-" : replay->roomNames[h->room],
+               h->status == RS_ABSENT ? "-" : evidence_name(h->device), statusNames[h->status]);
+    }
+}
+
+// Absolute milliseconds, +ms from the first event, or "end"
+static bool parse_time(const struct Replay* replay, const char* text, long long* stamp) {
+    char* end;
+    if (strcmp(text, "end") == 0) {
+        *stamp = replay->events[replay->eventCount - 1].stamp;
+        return true;
+    }
+    long long value = strtoll(text, &end, 10);
+    if (end == text || *end != '\0') return false;
+    *stamp = text[0] == '+' ? replay->events[0].stamp + value : value;
+    return true;
+}
+
+static void query(const struct Replay* replay, struct ReplayState* state, const char* text) {
+    long long stamp;
+    if (!parse_time(replay, text, &stamp)) {
+        fprintf(stderr, "Bad time '%s': expected milliseconds, +ms from the start, or 'end'\n", text);
+        return;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    size_t applied = events_until(replay, stamp);
+    size_t deltas = seek(replay, applied, state);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double us = (double)(end.tv_sec - start.tv_sec) * 1e6 + (double)(end.tv_nsec - start.tv_nsec) / 1e3;
+
+    printf("\n== %lld (+%lld ms): %zu of %zu event(s), checkpoint %zu + %zu delta(s), %.1f us ==\n",
+           stamp, stamp - replay->events[0].stamp, applied, replay->eventCount,
+           applied / replay->every, deltas, us);
+    print_state(replay, state);
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [--every N] [--dir DIR] [TIME...]\n", prog);
+    fprintf(stderr, "Reconstructs the House from the log_<id> files and segments in DIR (default: current directory).\n");
+    fprintf(stderr, "TIME is a log timestamp in ms, +ms from the first event, or 'end'; without any, times are read\n");
+    fprintf(stderr, "from standard input, one per line. --every sets the events between checkpoints (default %d).\n",
+            REPLAY_CHECKPOINT_EVENTS);
+}
+
+int main(int argc, char* argv[]) {
+    static struct Replay replay;
+    const char* dir = ".";
+    long every = REPLAY_CHECKPOINT_EVENTS;
+    int firstTime = argc;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--every") == 0 && i + 1 < argc) {
+            every = strtol(argv[++i], NULL, 10);
+            if (every <= 0) {
+                usage(argv[0]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--dir") == 0 && i + 1 < argc) dir = argv[++i];
+        else if (argv[i][0] != '-' || argv[i][1] != '-') {
+            firstTime = i;
+            break;
+        }
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    replay.every = (size_t)every;
+    memset(replay.roomSlots, -1, sizeof(replay.roomSlots));
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int logs = load_logs(&replay, dir);
+    if (logs < 0) return 1;
+    if (replay.eventCount == 0) {
+        fprintf(stderr, "No events in the logs in %s\n", dir);
+        return 1;
+    }
+    qsort(replay.events, replay.eventCount, sizeof(replay.events[0]), compare_events);
+    sort_hunters(&replay);
+    if (!build_checkpoints(&replay)) {
+        fprintf(stderr, "replayLogs: out of memory\n");
+        return 1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double ms = (double)(end.tv_sec - start.tv_sec) * 1000.0 + (double)(end.tv_nsec - start.tv_nsec) / 1e6;
+
+    printf("Indexed %zu event(s) from %d log(s) in %.2f ms: %d room(s), %d entit%s, %zu checkpoint(s) every %zu event(s)",
+           replay.eventCount, logs, ms, replay.roomCount, replay.entityCount, replay.entityCount == 1 ? "y" : "ies",
+           replay.checkpointCount, replay.every);
+    if (replay.badLines) printf(", %llu malformed line(s)", (unsigned long long)replay.badLines);
+    printf("\nRun spans %lld to %lld (%lld ms)\n", replay.events[0].stamp, replay.events[replay.eventCount - 1].stamp,
+           replay.events[replay.eventCount - 1].stamp - replay.events[0].stamp);
+
+    struct ReplayState state;
+    state_alloc(&replay, &state);
+    if (firstTime < argc) {
+        for (int i = firstTime; i < argc; i++) query(&replay, &state, argv[i]);
+    } else {
+        char line[64];
+        while (fgets(line, sizeof(line), stdin) != NULL) {
+            line[strcspn(line, "\n")] = '\0';
+            if (line[0] == '\0') continue;
+            query(&replay, &state, line);
+            fflush(stdout);
+        }
+    }
+
+    state_free(&state);
+    for (size_t k = 0; k < replay.checkpointCount; k++) state_free(&replay.checkpoints[k]);
+    free(replay.checkpoints);
+    free(replay.events);
+    free(replay.hunterOrder);
+    free(replay.entities);
+    return 0;
+}
@@ -0,0 +1,295 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "helpers.h"
+#include "results.h"
+#include "masks.h"
+
+#define ALIGN_UP(n, a) (((n) + (a) - 1) / (a) * (a))
+
+// Bytes per value of each column
+static const uint32_t columnWidth[RC_COUNT] = {
+    [RC_SEED] = 4, [RC_GHOST] = 1, [RC_COLLECTED] = 1, [RC_HUNTERS] = 2,
+    [RC_EXIT_EVIDENCE] = 2, [RC_EXIT_BORED] = 2, [RC_EXIT_AFRAID] = 2,
+    [RC_TICKS] = 4, [RC_WALL_US] = 4,
+    [RC_HUNTER_EXIT] = 1, [RC_HUNTER_FEAR] = 4, [RC_HUNTER_BOREDOM] = 4,
+};
+
+static bool column_per_hunter(enum ResultsColumn column) {
+    return column >= RC_HUNTER_EXIT;
+}
+
+static uint64_t column_stride(const struct ResultsHeader* header, enum ResultsColumn column) {
+    return ALIGN_UP((uint64_t)header->blockRows * columnWidth[column], CACHE_LINE);
+}
+
+// Fill in the block geometry for a file with the given hunter slots
+static void header_layout(struct ResultsHeader* header, int hunterSlots) {
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, RESULTS_MAGIC, sizeof(header->magic));
+    header->blockRows = RESULTS_BLOCK_ROWS;
+    header->hunterSlots = (uint32_t)hunterSlots;
+
+    uint64_t offset = CACHE_LINE; // the row count gets a line of its own
+    for (int c = 0; c < RC_COUNT; c++) {
+        header->columnOffset[c] = offset;
+        offset += column_stride(header, c) * (column_per_hunter(c) ? header->hunterSlots : 1);
+    }
+    header->blockSize = offset;
+}
+
+static bool header_valid(const struct ResultsHeader* header) {
+    if (memcmp(header->magic, RESULTS_MAGIC, sizeof(header->magic)) != 0) return false;
+    if (header->hunterSlots > SIM_MAX_OUTCOMES || header->blockRows != RESULTS_BLOCK_ROWS) return false;
+
+    struct ResultsHeader expected;
+    header_layout(&expected, (int)header->hunterSlots);
+    return memcmp(&expected, header, sizeof(expected)) == 0;
+}
+
+static void* block_column(unsigned char* block, const struct ResultsHeader* header, enum ResultsColumn column, int slot) {
+    return block + header->columnOffset[column] + (uint64_t)slot * column_stride(header, column);
+}
+
+static off_t block_position(const struct ResultsHeader* header, uint64_t index) {
+    return (off_t)(sizeof(struct ResultsHeader) + index * header->blockSize);
+}
+
+static int write_block(struct ResultsWriter* writer) {
+    memcpy(writer->block, &writer->rows, sizeof(writer->rows));
+    size_t size = writer->header.blockSize;
+    off_t position = block_position(&writer->header, writer->blockIndex);
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = pwrite(writer->fd, writer->block + done, size - done, position + (off_t)done);
+        if (n < 0) {
+            perror("results: write");
+            return -1;
+        }
+        done += (size_t)n;
+    }
+    return 0;
+}
+
+int resultsOpen(struct ResultsWriter* writer, const char* path, int hunterSlots) {
+    memset(writer, 0, sizeof(*writer));
+    writer->fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (writer->fd < 0) {
+        perror(path);
+        return -1;
+    }
+
+    struct stat st;
+    fstat(writer->fd, &st);
+    if (st.st_size == 0) {
+        if (hunterSlots > SIM_MAX_OUTCOMES) hunterSlots = SIM_MAX_OUTCOMES;
+        header_layout(&writer->header, hunterSlots);
+        if (pwrite(writer->fd, &writer->header, sizeof(writer->header), 0) != (ssize_t)sizeof(writer->header)) {
+            perror("results: write");
+            close(writer->fd);
+            return -1;
+        }
+    }
+    else if (pread(writer->fd, &writer->header, sizeof(writer->header), 0) != (ssize_t)sizeof(writer->header)
+             || !header_valid(&writer->header)) {
+        fprintf(stderr, "%s: not a results file\n", path);
+        close(writer->fd);
+        return -1;
+    }
+
+    writer->block = aligned_alloc(CACHE_LINE, writer->header.blockSize);
+    if (writer->block == NULL) {
+        fprintf(stderr, "results: out of memory\n");
+        close(writer->fd);
+        return -1;
+    }
+    memset(writer->block, 0, writer->header.blockSize);
+
+    // keep filling the last block if an earlier session left it partial
+    uint64_t blocks = st.st_size > 0 ? ((uint64_t)st.st_size - sizeof(struct ResultsHeader)) / writer->header.blockSize : 0;
+    writer->blockIndex = blocks;
+    if (blocks > 0) {
+        ssize_t size = (ssize_t)writer->header.blockSize;
+        if (pread(writer->fd, writer->block, (size_t)size, block_position(&writer->header, blocks - 1)) == size) {
+            memcpy(&writer->rows, writer->block, sizeof(writer->rows));
+            if (writer->rows < writer->header.blockRows) {
+                writer->blockIndex = blocks - 1;
+            } else {
+                writer->rows = 0;
+                memset(writer->block, 0, writer->header.blockSize);
+            }
+        }
+    }
+    return 0;
+}
+
+int resultsAppend(struct ResultsWriter* writer, const struct SimResult* result) {
+    const struct ResultsHeader* header = &writer->header;
+    unsigned char* block = writer->block;
+    uint32_t row = writer->rows;
+
+    ((uint32_t*)block_column(block, header, RC_SEED, 0))[row] = result->seed;
+    ((uint8_t*)block_column(block, header, RC_GHOST, 0))[row] = (uint8_t)result->ghostType;
+    ((uint8_t*)block_column(block, header, RC_COLLECTED, 0))[row] = result->collected;
+    ((uint16_t*)block_column(block, header, RC_HUNTERS, 0))[row] = (uint16_t)result->hunterCount;
+    ((uint16_t*)block_column(block, header, RC_EXIT_EVIDENCE, 0))[row] = (uint16_t)result->exitCounts[LR_EVIDENCE];
+    ((uint16_t*)block_column(block, header, RC_EXIT_BORED, 0))[row] = (uint16_t)result->exitCounts[LR_BORED];
+    ((uint16_t*)block_column(block, header, RC_EXIT_AFRAID, 0))[row] = (uint16_t)result->exitCounts[LR_AFRAID];
+    ((uint32_t*)block_column(block, header, RC_TICKS, 0))[row] = result->ticks;
+    ((uint32_t*)block_column(block, header, RC_WALL_US, 0))[row] = (uint32_t)(result->wallSeconds * 1e6);
+
+    for (int slot = 0; slot < (int)header->hunterSlots; slot++) {
+        // slots beyond the run's hunters stay zero
+        struct HunterOutcome outcome = {0};
+        if (slot < result->hunterCount) outcome = result->hunters[slot];
+        ((uint8_t*)block_column(block, header, RC_HUNTER_EXIT, slot))[row] = outcome.exitReason;
+        ((uint32_t*)block_column(block, header, RC_HUNTER_FEAR, slot))[row] = outcome.fear;
+        ((uint32_t*)block_column(block, header, RC_HUNTER_BOREDOM, slot))[row] = outcome.boredom;
+    }
+
+    writer->rows++;
+    if (writer->rows == header->blockRows) {
+        if (write_block(writer) != 0) return -1;
+        writer->blockIndex++;
+        writer->rows = 0;
+        memset(writer->block, 0, header->blockSize);
+    }
+    return 0;
+}
+
+int resultsClose(struct ResultsWriter* writer) {
+    int status = 0;
+    if (writer->rows > 0) status = write_block(writer);
+    free(writer->block);
+    writer->block = NULL;
+    if (close(writer->fd) != 0) status = -1;
+    return status;
+}
+
+int resultsMap(struct ResultsFile* file, const char* path) {
+    memset(file, 0, sizeof(*file));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+
+    struct stat st;
+    fstat(fd, &st);
+    if ((size_t)st.st_size < sizeof(struct ResultsHeader)) {
+        fprintf(stderr, "%s: not a results file\n", path);
+        close(fd);
+        return -1;
+    }
+
+    void* map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror(path);
+        return -1;
+    }
+
+    file->map = map;
+    file->size = (size_t)st.st_size;
+    file->header = map;
+    if (!header_valid(file->header)) {
+        fprintf(stderr, "%s: not a results file\n", path);
+        resultsUnmap(file);
+        return -1;
+    }
+    file->blockCount = (file->size - sizeof(struct ResultsHeader)) / file->header->blockSize;
+    madvise(map, file->size, MADV_SEQUENTIAL);
+    return 0;
+}
+
+void resultsUnmap(struct ResultsFile* file) {
+    if (file->map) munmap((void*)file->map, file->size);
+    file->map = NULL;
+}
+
+uint32_t resultsBlockRows(const struct ResultsFile* file, uint64_t block) {
+    uint32_t rows;
+    memcpy(&rows, file->map + block_position(file->header, block), sizeof(rows));
+    return rows <= file->header->blockRows ? rows : 0;
+}
+
+const void* resultsColumn(const struct ResultsFile* file, uint64_t block, enum ResultsColumn column, int slot) {
+    return file->map + block_position(file->header, block) + file->header->columnOffset[column]
+           + (uint64_t)slot * column_stride(file->header, column);
+}
+
+int results_summary(const char* path) {
+    struct ResultsFile file;
+    if (resultsMap(&file, path) != 0) return 1;
+
+    uint64_t runs = 0, wins = 0, ticks = 0, wallUs = 0, hunters = 0;
+    uint64_t covered = 0, named = 0, threeTypes = 0;
+    uint64_t exits[3] = {0};
+    uint64_t ghosts[256] = {0};
+    static uint8_t flags[RESULTS_BLOCK_ROWS];
+
+    // only the columns needed are touched
+    for (uint64_t b = 0; b < file.blockCount; b++) {
+        uint32_t rows = resultsBlockRows(&file, b);
+        const uint8_t* ghost = resultsColumn(&file, b, RC_GHOST, 0);
+        const uint8_t* collected = resultsColumn(&file, b, RC_COLLECTED, 0);
+        const uint16_t* hunterCount = resultsColumn(&file, b, RC_HUNTERS, 0);
+        const uint16_t* exitEvidence = resultsColumn(&file, b, RC_EXIT_EVIDENCE, 0);
+        const uint16_t* exitBored = resultsColumn(&file, b, RC_EXIT_BORED, 0);
+        const uint16_t* exitAfraid = resultsColumn(&file, b, RC_EXIT_AFRAID, 0);
+        const uint32_t* tickCount = resultsColumn(&file, b, RC_TICKS, 0);
+        const uint32_t* wall = resultsColumn(&file, b, RC_WALL_US, 0);
+
+        for (uint32_t r = 0; r < rows; r++) {
+            wins += ghost[r] == collected[r];
+            ghosts[ghost[r]]++;
+            hunters += hunterCount[r];
+            exits[LR_EVIDENCE] += exitEvidence[r];
+            exits[LR_BORED] += exitBored[r];
+            exits[LR_AFRAID] += exitAfraid[r];
+            ticks += tickCount[r];
+            wallUs += wall[r];
+        }
+
+        // case file scoring, a block of masks at a time
+        masks_contains(collected, ghost, flags, rows);
+        for (uint32_t r = 0; r < rows; r++) covered += flags[r];
+        masks_names_ghost(collected, flags, rows);
+        for (uint32_t r = 0; r < rows; r++) named += flags[r];
+        masks_three_unique(collected, flags, rows);
+        for (uint32_t r = 0; r < rows; r++) threeTypes += flags[r];
+        runs += rows;
+    }
+
+    printf("%s: %llu run(s) in %llu block(s), %u hunter slot(s) per run\n", path,
+           (unsigned long long)runs, (unsigned long long)file.blockCount, file.header->hunterSlots);
+    if (runs > 0) {
+        printf("  hunters win:     %.1f%%\n", 100.0 * (double)wins / (double)runs);
+        printf("  ghost evidence:  %.1f%% (case file holds all three of the ghost's types)\n", 100.0 * (double)covered / (double)runs);
+        printf("  names a ghost:   %.1f%% (the van check passes)\n", 100.0 * (double)named / (double)runs);
+        printf("  3+ types:        %.1f%%\n", 100.0 * (double)threeTypes / (double)runs);
+        printf("  mean hunters:    %.1f\n", (double)hunters / (double)runs);
+        printf("  mean ticks:      %.1f\n", (double)ticks / (double)runs);
+        printf("  mean wall ms:    %.3f\n", (double)wallUs / (double)runs / 1000.0);
+        for (int reason = LR_EVIDENCE; reason <= LR_AFRAID; reason++) {
+            printf("  exit %-10s %.1f%%\n", exit_reason_to_string(reason),
+                   hunters ? 100.0 * (double)exits[reason] / (double)hunters : 0.0);
+        }
+
+        const enum GhostType* ghostTypes;
+        int ghostCount = get_all_ghost_types(&ghostTypes);
+        printf("  ghosts:\n");
+        for (int g = 0; g < ghostCount; g++) {
+            if (ghosts[ghostTypes[g]] == 0) continue;
+            printf("    %-14s %llu\n", ghost_to_string(ghostTypes[g]), (unsigned long long)ghosts[ghostTypes[g]]);
+        }
+    }
+
+    resultsUnmap(&file);
+    return 0;
+}
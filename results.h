@@ -0,0 +1,126 @@
+#ifndef RESULTS_H
+#define RESULTS_H
+
+#include "defs.h"
+#include "simulation.h"
+
+/*
+    Append-only columnar results file.
+
+    [ResultsHeader][block 0][block 1]...
+
+    Every block has the same size and holds up to RESULTS_BLOCK_ROWS runs. A block starts with a
+    CACHE_LINE-sized row count followed by one contiguous, cache-line aligned region per column, so a
+    scan over a few columns reads only those regions. Per-hunter columns hold one region per hunter
+    slot (slot 0 of every row, then slot 1, ...). Only the last block may be partially filled.
+*/
+
+#define RESULTS_MAGIC "PHRES001"
+#define RESULTS_BLOCK_ROWS 4096
+
+enum ResultsColumn {
+    RC_SEED = 0,        // uint32_t
+    RC_GHOST,           // uint8_t, the ghost type's evidence mask
+    RC_COLLECTED,       // uint8_t, casefile mask at the end of the run
+    RC_HUNTERS,         // uint16_t, hunters in the run
+    RC_EXIT_EVIDENCE,   // uint16_t, hunters that left with LR_EVIDENCE
+    RC_EXIT_BORED,      // uint16_t
+    RC_EXIT_AFRAID,     // uint16_t
+    RC_TICKS,           // uint32_t, longest-running entity's ticks
+    RC_WALL_US,         // uint32_t, wall time in microseconds
+    RC_HUNTER_EXIT,     // uint8_t per hunter slot, enum LogReason
+    RC_HUNTER_FEAR,     // uint32_t per hunter slot
+    RC_HUNTER_BOREDOM,  // uint32_t per hunter slot
+    RC_COUNT
+};
+
+struct ResultsHeader {
+    char     magic[8];
+    uint32_t blockRows;
+    uint32_t hunterSlots;   // per-hunter columns kept for each run (<= SIM_MAX_OUTCOMES)
+    uint64_t blockSize;     // bytes per block including its row count
+    uint64_t columnOffset[RC_COUNT]; // byte offset of each column inside a block
+    uint8_t  pad[CACHE_LINE - (8 + 4 + 4 + 8 + 8 * RC_COUNT) % CACHE_LINE];
+};
+
+// Appends rows; buffers one block in memory and writes it in place until it is full
+struct ResultsWriter {
+    int fd;
+    struct ResultsHeader header;
+    unsigned char* block;   // current block, header.blockSize bytes
+    uint64_t blockIndex;    // where the current block goes in the file
+    uint32_t rows;          // rows filled in the current block
+};
+
+// A results file mapped read-only
+struct ResultsFile {
+    const unsigned char* map;
+    size_t size;
+    const struct ResultsHeader* header;
+    uint64_t blockCount;
+};
+
+/**
+ * @brief Open a results file for appending, creating it if needed.
+ * @param[out] writer Writer state.
+ * @param[in] path File path.
+ * @param[in] hunterSlots Per-hunter columns for a new file; ignored when the file exists.
+ * @return 0 on success, -1 if the file can't be opened or isn't a results file.
+ */
+int resultsOpen(struct ResultsWriter* writer, const char* path, int hunterSlots);
+
+/**
+ * @brief Append one run. The block is written out whenever it fills.
+ * @param[in,out] writer Writer state.
+ * @param[in] result Run to record.
+ * @return 0 on success, -1 on a write error.
+ */
+int resultsAppend(struct ResultsWriter* writer, const struct SimResult* result);
+
+/**
+ * @brief Write the partially filled block and close the file.
+ * @param[in,out] writer Writer state.
+ * @return 0 on success, -1 on a write error.
+ */
+int resultsClose(struct ResultsWriter* writer);
+
+/**
+ * @brief Map a results file for reading.
+ * @param[out] file Mapped file.
+ * @param[in] path File path.
+ * @return 0 on success, -1 on error.
+ */
+int resultsMap(struct ResultsFile* file, const char* path);
+
+/**
+ * @brief Release a mapping made by resultsMap.
+ * @param[in,out] file Mapped file.
+ */
+void resultsUnmap(struct ResultsFile* file);
+
+/**
+ * @brief Number of valid rows in a block.
+ * @param[in] file Mapped file.
+ * @param[in] block Block index.
+ * @return Rows in the block.
+ */
+uint32_t resultsBlockRows(const struct ResultsFile* file, uint64_t block);
+
+/**
+ * @brief Pointer to one column of one block.
+ * @param[in] file Mapped file.
+ * @param[in] block Block index.
+ * @param[in] column Column.
+ * @param[in] slot Hunter slot for per-hunter columns, otherwise 0.
+ * @return Start of the column's values for that block.
+ */
+const void* resultsColumn(const struct ResultsFile* file, uint64_t block, enum ResultsColumn column, int slot);
+
+/**
+ * @brief Print aggregate statistics of a results file by scanning a few columns.
+ * @param[in] path File path.
+ * @return Process exit status.
+ */
+int results_summary(const char* path);
+
+#endif // RESULTS_H
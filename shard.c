@@ -0,0 +1,456 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "helpers.h"
+#include "simulation.h"
+#include "results.h"
+
+/*
+    Sharded runner: many investigations across worker processes, so a run that crashes takes down only
+    its own worker.
+
+    The supervisor maps one shared segment and forks the workers. Runs are numbered 0..runs-1 (run r
+    uses seed S + r). A worker claims the next range of runs from a shared counter and records in its
+    slot which run it is on. Finished runs go into the worker's own single-producer ring as compact
+    records. The supervisor drains every ring, appends the records to the results file and reaps the
+    workers.
+
+    When a worker dies, its slot still says which run it was on. The supervisor forks a replacement for
+    the same slot, which resumes the slot's range at that run. A run that keeps crashing is retried up
+    to --retries times and then quarantined, and the replacement skips it. A record is only published
+    once it is complete, so a crash never leaves half a record in a ring. A run published just before
+    a crash may be run twice; the supervisor keeps the first record.
+*/
+
+#define SHARD_MAX_WORKERS 64
+#define SHARD_RING_RECORDS 1024 // per worker, a power of two
+#define SHARD_NONE UINT64_MAX
+#define SHARD_MAX_LISTED 20     // quarantined seeds printed by name
+
+// One finished run, the fields a results file keeps
+struct ShardRecord {
+    uint64_t run;
+    uint64_t moves;
+    uint64_t pickups;
+    uint32_t seed;
+    uint32_t ticks;
+    uint32_t wallUs;
+    uint16_t hunterCount;
+    uint16_t exitCounts[3];
+    uint8_t ghostType;
+    uint8_t collected;
+    uint8_t solved;
+    struct HunterOutcome hunters[SIM_MAX_OUTCOMES];
+};
+
+// Written by one worker, read by the supervisor; a record is visible once tail passes it
+struct ShardRing {
+    _Alignas(CACHE_LINE) _Atomic uint64_t head; // next record the supervisor reads
+    _Alignas(CACHE_LINE) _Atomic uint64_t tail; // next record the worker writes
+    struct ShardRecord records[SHARD_RING_RECORDS];
+};
+
+// A worker's claimed range; outlives the process so a replacement can pick up where it died
+struct ShardSlot {
+    _Atomic uint64_t current; // run in progress, SHARD_NONE between runs
+    _Atomic uint64_t next;    // next run of the claimed range
+    _Atomic uint64_t end;     // end of the claimed range
+} __attribute__((aligned(CACHE_LINE)));
+
+struct ShardShared {
+    _Alignas(CACHE_LINE) _Atomic uint64_t nextRun; // first run nobody has claimed
+    struct ShardSlot slots[SHARD_MAX_WORKERS];
+    struct ShardRing rings[];                      // one per worker
+};
+
+// The supervisor's view of one slot
+struct ShardWorker {
+    pid_t pid;
+    bool finished;          // exited normally with nothing left to claim
+    uint64_t failingRun;    // run the last crash happened in
+    int failures;           // consecutive crashes in failingRun, or outside any run
+};
+
+struct Shard {
+    struct SimConfig config;
+    unsigned baseSeed;
+    uint64_t runs;
+    int chunk;
+    int retries;
+    long crashSeed;         // --inject-crash, -1 = none
+    int workerCount;
+    struct ShardShared* shared;
+    size_t sharedSize;
+    struct ShardWorker workers[SHARD_MAX_WORKERS];
+
+    uint8_t* done;          // bitmap of runs with a record
+    uint8_t* skipped;       // bitmap of quarantined runs; shares done's allocation
+    uint64_t completed;
+    uint64_t wins;
+    uint64_t solved;
+    uint64_t hunters;
+    uint64_t exits[3];
+    int restarts;
+    int retried;            // runs run again after a crash
+    uint64_t quarantined[SHARD_MAX_LISTED];
+    int quarantinedCount;
+    struct ResultsWriter* results;
+    bool resultsFailed;
+};
+
+// ---- Worker ----
+
+static void ring_push(struct ShardRing* ring, const struct ShardRecord* record) {
+    uint64_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    while (tail - atomic_load_explicit(&ring->head, memory_order_acquire) == SHARD_RING_RECORDS) {
+        struct timespec pause = {0, 100 * 1000};
+        nanosleep(&pause, NULL); // the supervisor is behind
+    }
+    ring->records[tail % SHARD_RING_RECORDS] = *record;
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+}
+
+static void shard_record(const struct SimResult* result, uint64_t run, struct ShardRecord* record) {
+    memset(record, 0, sizeof(*record));
+    record->run = run;
+    record->moves = result->moves;
+    record->pickups = result->pickups;
+    record->seed = result->seed;
+    record->ticks = result->ticks;
+    record->wallUs = (uint32_t)(result->wallSeconds * 1e6);
+    record->hunterCount = (uint16_t)result->hunterCount;
+    for (int e = 0; e < 3; e++) record->exitCounts[e] = (uint16_t)result->exitCounts[e];
+    record->ghostType = (uint8_t)result->ghostType;
+    record->collected = result->collected;
+    record->solved = result->solved;
+    memcpy(record->hunters, result->hunters, sizeof(record->hunters));
+}
+
+static void shardWorker(struct Shard* shard, int index) {
+    struct ShardSlot* slot = &shard->shared->slots[index];
+    struct ShardRing* ring = &shard->shared->rings[index];
+    struct SimConfig config = shard->config;
+
+    static struct House house;
+    arenaInit(&house.arena, HOUSE_ARENA_SIZE);
+    struct SimResult* result = malloc(sizeof(*result));
+    if (result == NULL) _exit(1);
+
+    while (true) {
+        uint64_t run = atomic_load_explicit(&slot->next, memory_order_relaxed);
+        if (run >= atomic_load_explicit(&slot->end, memory_order_acquire)) {
+            run = atomic_fetch_add(&shard->shared->nextRun, (uint64_t)shard->chunk);
+            if (run >= shard->runs) break;
+            uint64_t end = run + (uint64_t)shard->chunk;
+            // next first: the old end is <= run, so a crash between the stores leaves an empty range
+            // rather than one stretching from the old cursor over other workers' chunks
+            atomic_store_explicit(&slot->next, run, memory_order_relaxed);
+            atomic_store_explicit(&slot->end, end < shard->runs ? end : shard->runs, memory_order_release);
+        }
+
+        atomic_store_explicit(&slot->current, run, memory_order_release);
+        config.seed = shard->baseSeed + (unsigned)run;
+        if ((long)config.seed == shard->crashSeed) abort();
+        simulation_run(&house, &config, result);
+
+        struct ShardRecord record;
+        shard_record(result, run, &record);
+        ring_push(ring, &record);
+        atomic_store_explicit(&slot->next, run + 1, memory_order_relaxed);
+        atomic_store_explicit(&slot->current, SHARD_NONE, memory_order_release);
+    }
+
+    free(result);
+    arenaDestroy(&house.arena);
+    _exit(0); // the supervisor's stdio buffers and atexit handlers aren't ours
+}
+
+// ---- Supervisor ----
+
+static bool shard_spawn(struct Shard* shard, int index) {
+    fflush(NULL); // so the child doesn't inherit half-written output
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("shards: fork");
+        return false;
+    }
+    if (pid == 0) shardWorker(shard, index);
+    shard->workers[index].pid = pid;
+    return true;
+}
+
+static void shard_collect(struct Shard* shard, const struct ShardRecord* record) {
+    uint64_t run = record->run;
+    if (run >= shard->runs || (shard->done[run / 8] & (1u << (run % 8)))) return; // re-run after a late crash
+    shard->done[run / 8] |= (uint8_t)(1u << (run % 8));
+
+    shard->completed++;
+    shard->wins += record->collected == record->ghostType;
+    shard->solved += record->solved;
+    shard->hunters += record->hunterCount;
+    for (int e = 0; e < 3; e++) shard->exits[e] += record->exitCounts[e];
+
+    if (shard->results && !shard->resultsFailed) {
+        struct SimResult result;
+        memset(&result, 0, sizeof(result));
+        result.seed = record->seed;
+        result.ghostType = (enum GhostType)record->ghostType;
+        result.collected = record->collected;
+        result.solved = record->solved;
+        result.hunterCount = record->hunterCount;
+        for (int e = 0; e < 3; e++) result.exitCounts[e] = record->exitCounts[e];
+        memcpy(result.hunters, record->hunters, sizeof(result.hunters));
+        result.ticks = record->ticks;
+        result.moves = record->moves;
+        result.pickups = record->pickups;
+        result.wallSeconds = record->wallUs / 1e6;
+        shard->resultsFailed = resultsAppend(shard->results, &result) != 0;
+    }
+}
+
+static int shard_drain(struct Shard* shard) {
+    int drained = 0;
+    for (int w = 0; w < shard->workerCount; w++) {
+        struct ShardRing* ring = &shard->shared->rings[w];
+        uint64_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+        uint64_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+        for (; head < tail; head++, drained++) {
+            shard_collect(shard, &ring->records[head % SHARD_RING_RECORDS]);
+        }
+        atomic_store_explicit(&ring->head, head, memory_order_release);
+    }
+    return drained;
+}
+
+static void shard_quarantine(struct Shard* shard, uint64_t run) {
+    shard->skipped[run / 8] |= (uint8_t)(1u << (run % 8));
+    if (shard->quarantinedCount < SHARD_MAX_LISTED) shard->quarantined[shard->quarantinedCount] = run;
+    shard->quarantinedCount++;
+}
+
+// A worker died: retry or skip the run it was on, then start a replacement on the same slot
+static void shard_recover(struct Shard* shard, int index, int status) {
+    struct ShardWorker* worker = &shard->workers[index];
+    struct ShardSlot* slot = &shard->shared->slots[index];
+    uint64_t run = atomic_load_explicit(&slot->current, memory_order_acquire);
+
+    if (WIFSIGNALED(status)) {
+        fprintf(stderr, "shards: worker %d (pid %d) killed by signal %d", index, (int)worker->pid, WTERMSIG(status));
+    } else {
+        fprintf(stderr, "shards: worker %d (pid %d) exited with status %d", index, (int)worker->pid, WEXITSTATUS(status));
+    }
+    if (run != SHARD_NONE) fprintf(stderr, " in seed %u", shard->baseSeed + (unsigned)run);
+    fprintf(stderr, "\n");
+
+    if (worker->failingRun == run) {
+        worker->failures++;
+    } else {
+        worker->failingRun = run;
+        worker->failures = 1;
+    }
+
+    if (run == SHARD_NONE) {
+        // died outside a run; keep trying the slot a few times
+        if (worker->failures > shard->retries) {
+            fprintf(stderr, "shards: giving up on worker %d\n", index);
+            worker->finished = true;
+            return;
+        }
+    }
+    else if (worker->failures > shard->retries) {
+        shard_quarantine(shard, run);
+        atomic_store_explicit(&slot->next, run + 1, memory_order_relaxed);
+    }
+    else {
+        shard->retried++;
+        atomic_store_explicit(&slot->next, run, memory_order_relaxed);
+    }
+    atomic_store_explicit(&slot->current, SHARD_NONE, memory_order_relaxed);
+
+    shard->restarts++;
+    if (!shard_spawn(shard, index)) worker->finished = true;
+}
+
+static void shard_supervise(struct Shard* shard) {
+    int running = shard->workerCount;
+    while (running > 0) {
+        int drained = shard_drain(shard);
+
+        int status;
+        pid_t pid;
+        while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+            int index = 0;
+            while (index < shard->workerCount && shard->workers[index].pid != pid) index++;
+            if (index == shard->workerCount) continue;
+
+            if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+                shard->workers[index].finished = true;
+            } else {
+                shard_drain(shard); // keep whatever the worker finished
+                shard_recover(shard, index, status);
+            }
+            if (shard->workers[index].finished) running--;
+        }
+        if (pid < 0 && errno == ECHILD) break;
+
+        if (drained == 0) {
+            struct timespec pause = {0, 1000 * 1000};
+            nanosleep(&pause, NULL);
+        }
+    }
+    shard_drain(shard);
+}
+
+static void shard_usage(void) {
+    fprintf(stderr,
+            "Usage: huntSimulation --shards [options]\n"
+            "  --runs N            investigations to run (default 1000)\n"
+            "  --processes N       worker processes (default: one per core, at most %d)\n"
+            "  --chunk N           runs a worker claims at a time (default 64)\n"
+            "  --retries N         times a crashing seed is run again before it is quarantined (default 2)\n"
+            "  --hunters N         hunters per run (default 4)\n"
+            "  --rooms N           generated house with N rooms, one per seed (default: Willow House)\n"
+            "  --occupancy N       hunters allowed per room (default %d; the van is unlimited)\n"
+            "  --boredom N         boredom limit (default %d)\n"
+            "  --fear N            fear limit (default %d)\n"
+            "  --end-policy P      natural|solved|ghost-exit (default natural)\n"
+            "  --seed S            base seed; run r uses S + r (default: clock)\n"
+            "  --results FILE      append every run to a columnar results file\n"
+            "  --inject-crash S    abort the worker running seed S, to exercise recovery\n",
+            SHARD_MAX_WORKERS, MAX_ROOM_OCCUPANCY, ENTITY_BOREDOM_MAX, HUNTER_FEAR_MAX);
+}
+
+int shard_main(int argc, char* argv[]) {
+    static struct Shard shard;
+    simulation_config_default(&shard.config);
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    shard.workerCount = cores > 0 ? (int)cores : 1;
+    int runs = 1000;
+    shard.chunk = 64;
+    shard.retries = 2;
+    shard.crashSeed = -1;
+    const char* resultsPath = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        bool ok = i + 1 < argc;
+        if (ok && strcmp(argv[i], "--runs") == 0) ok = simulation_parse_positive(argv[++i], &runs);
+        else if (ok && strcmp(argv[i], "--processes") == 0) ok = simulation_parse_positive(argv[++i], &shard.workerCount);
+        else if (ok && strcmp(argv[i], "--chunk") == 0) ok = simulation_parse_positive(argv[++i], &shard.chunk);
+        else if (ok && strcmp(argv[i], "--retries") == 0) {
+            char* end;
+            long retries = strtol(argv[++i], &end, 10);
+            ok = *end == '\0' && retries >= 0 && retries <= 100;
+            shard.retries = (int)retries;
+        }
+        else if (ok && strcmp(argv[i], "--hunters") == 0) ok = simulation_parse_positive(argv[++i], &shard.config.hunterCount);
+        else if (ok && strcmp(argv[i], "--rooms") == 0) ok = simulation_parse_positive(argv[++i], &shard.config.roomCount);
+        else if (ok && strcmp(argv[i], "--occupancy") == 0) ok = simulation_parse_positive(argv[++i], &shard.config.maxOccupancy);
+        else if (ok && strcmp(argv[i], "--boredom") == 0) ok = simulation_parse_positive(argv[++i], &shard.config.boredomMax);
+        else if (ok && strcmp(argv[i], "--fear") == 0) ok = simulation_parse_positive(argv[++i], &shard.config.fearMax);
+        else if (ok && strcmp(argv[i], "--end-policy") == 0) ok = end_policy_from_string(argv[++i], &shard.config.policy);
+        else if (ok && strcmp(argv[i], "--seed") == 0) shard.baseSeed = (unsigned)strtoul(argv[++i], NULL, 10);
+        else if (ok && strcmp(argv[i], "--results") == 0) resultsPath = argv[++i];
+        else if (ok && strcmp(argv[i], "--inject-crash") == 0) shard.crashSeed = (long)strtoul(argv[++i], NULL, 10);
+        else ok = false;
+
+        if (!ok) {
+            shard_usage();
+            return 1;
+        }
+    }
+    if (shard.workerCount > SHARD_MAX_WORKERS) shard.workerCount = SHARD_MAX_WORKERS;
+    if (shard.workerCount > runs) shard.workerCount = runs;
+    if (shard.baseSeed == 0) shard.baseSeed = (unsigned)time(NULL);
+    shard.runs = (uint64_t)runs;
+
+    // per-event output would swamp the workers, and they share the working directory
+    log_set_sinks(0);
+    log_set_time_scale(0);
+
+    // built before the fork, so every worker reads the same pages
+    static struct HouseTemplate willow;
+    if (shard.config.roomCount == 0) {
+        house_template_init(&willow, 0);
+        shard.config.houseTemplate = &willow;
+    }
+
+    shard.sharedSize = sizeof(struct ShardShared) + (size_t)shard.workerCount * sizeof(struct ShardRing);
+    shard.shared = mmap(NULL, shard.sharedSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shard.shared == MAP_FAILED) {
+        perror("shards: mmap");
+        return 1;
+    }
+    shard.done = calloc(2 * (shard.runs / 8 + 1), 1);
+    if (shard.done == NULL) {
+        perror("shards");
+        munmap(shard.shared, shard.sharedSize);
+        return 1;
+    }
+    shard.skipped = shard.done + shard.runs / 8 + 1;
+    for (int w = 0; w < shard.workerCount; w++) {
+        atomic_init(&shard.shared->slots[w].current, SHARD_NONE);
+        shard.workers[w].failingRun = SHARD_NONE;
+    }
+
+    struct ResultsWriter results;
+    if (resultsPath) {
+        if (resultsOpen(&results, resultsPath, SIM_MAX_OUTCOMES) != 0) {
+            free(shard.done);
+            munmap(shard.shared, shard.sharedSize);
+            return 1;
+        }
+        shard.results = &results;
+    }
+
+    printf("Shards: %s, %d hunters, %llu run(s) from seed %u on %d worker process(es), ranges of %d\n",
+           shard.config.roomCount > 0 ? "generated house" : "Willow House", shard.config.hunterCount,
+           (unsigned long long)shard.runs, shard.baseSeed, shard.workerCount, shard.chunk);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int started = 0;
+    while (started < shard.workerCount && shard_spawn(&shard, started)) started++;
+    shard.workerCount = started;
+    shard_supervise(&shard);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double wall = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+
+    // a worker can publish a run and then crash on it, so the run is both completed and quarantined
+    uint64_t missing = 0;
+    for (uint64_t run = 0; run < shard.runs; run++) {
+        missing += !((shard.done[run / 8] | shard.skipped[run / 8]) & (1u << (run % 8)));
+    }
+    printf("  completed:       %llu run(s) in %.1f ms (%.0f runs/s)\n", (unsigned long long)shard.completed,
+           wall * 1000.0, (double)shard.completed / (wall > 0 ? wall : 1e-9));
+    if (shard.completed > 0) {
+        printf("  hunters win:     %.1f%%, solved %.1f%%\n",
+               100.0 * (double)shard.wins / (double)shard.completed, 100.0 * (double)shard.solved / (double)shard.completed);
+        for (int reason = LR_EVIDENCE; reason <= LR_AFRAID; reason++) {
+            printf("  exit %-10s %.1f%%\n", exit_reason_to_string(reason),
+                   shard.hunters ? 100.0 * (double)shard.exits[reason] / (double)shard.hunters : 0.0);
+        }
+    }
+    printf("  worker restarts: %d, runs retried: %d\n", shard.restarts, shard.retried);
+    if (shard.quarantinedCount > 0) {
+        printf("  quarantined:     %d seed(s):", shard.quarantinedCount);
+        for (int q = 0; q < shard.quarantinedCount && q < SHARD_MAX_LISTED; q++) {
+            printf(" %u", shard.baseSeed + (unsigned)shard.quarantined[q]);
+        }
+        printf("%s\n", shard.quarantinedCount > SHARD_MAX_LISTED ? " ..." : "");
+    }
+    if (missing > 0) printf("  not run:         %llu run(s) (a worker was given up on)\n", (unsigned long long)missing);
+
+    int status = shard.quarantinedCount > 0 || missing > 0 || shard.resultsFailed ? 1 : 0;
+    if (shard.results && resultsClose(shard.results) != 0) status = 1;
+    free(shard.done);
+    munmap(shard.shared, shard.sharedSize);
+    return status;
+}
@@ -0,0 +1,135 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include "helpers.h"
+#include "simulation.h"
+
+void simulation_config_default(struct SimConfig* config) {
+    config->hunterCount = 4;
+    config->roomCount = 0;
+    config->maxOccupancy = MAX_ROOM_OCCUPANCY;
+    config->boredomMax = ENTITY_BOREDOM_MAX;
+    config->fearMax = HUNTER_FEAR_MAX;
+    config->tickUsec = DEFAULT_TICK_USEC;
+    config->policy = END_NATURAL;
+    config->timeScale = 0;
+    config->seed = 0;
+    config->live = NULL;
+    config->houseTemplate = NULL;
+}
+
+// One list item in 1..limit; returns where the next item starts, or NULL on bad input
+static const char* parse_list_item(const char* p, long limit, long* value) {
+    char* end;
+    errno = 0;
+    *value = strtol(p, &end, 10);
+    if (end == p || errno == ERANGE || *value <= 0 || *value > limit) return NULL;
+    if (*end == ',') return end + 1;
+    return *end == '\0' ? end : NULL;
+}
+
+int simulation_parse_list(const char* text, int* values, int max) {
+    int n = 0;
+    for (const char* p = text; *p; ) {
+        long value;
+        if (n == max || (p = parse_list_item(p, 65535, &value)) == NULL) return -1;
+        values[n++] = (int)value;
+    }
+    return n;
+}
+
+int simulation_parse_long_list(const char* text, long* values, int max, long limit) {
+    int n = 0;
+    for (const char* p = text; *p; ) {
+        if (n == max || (p = parse_list_item(p, limit, &values[n])) == NULL) return -1;
+        n++;
+    }
+    return n;
+}
+
+bool simulation_parse_positive(const char* text, int* value) {
+    char* end;
+    long parsed = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || parsed <= 0 || parsed > 1000000000L) return false;
+    *value = (int)parsed;
+    return true;
+}
+
+static double seconds_since(const struct timespec* start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+void simulation_collect(const struct House* house, double wallSeconds, struct SimResult* result) {
+    memset(result, 0, sizeof(*result));
+    result->seed = house->seed;
+    result->ghostType = house->ghost.type;
+    result->collected = house->casefile.collected;
+    result->solved = house->casefile.solved;
+    result->hunterCount = house->hunterCount;
+    result->wallSeconds = wallSeconds;
+    result->ticks = (uint32_t)house->ghost.ticks;
+
+    for (int i = 0; i < house->hunterCount; i++) {
+        const struct Hunter* hunter = &house->hunters[i];
+        result->exitCounts[hunter->exitReason]++;
+        result->moves += hunter->moves;
+        result->pickups += hunter->pickups;
+        if ((uint32_t)hunter->ticks > result->ticks) result->ticks = (uint32_t)hunter->ticks;
+
+        if (i < SIM_MAX_OUTCOMES) {
+            result->hunters[i].exitReason = (uint8_t)hunter->exitReason;
+            result->hunters[i].fear = (uint32_t)hunter->fear;
+            result->hunters[i].boredom = (uint32_t)hunter->boredom;
+        }
+    }
+    result->lockStats = house->lockStats;
+    result->roomStats = house->roomStats;
+}
+
+void simulation_run(struct House* house, const struct SimConfig* config, struct SimResult* result) {
+    // the setup draws (layout, ghost, devices) come from this thread's generator
+    if (config->seed != 0) {
+        rand_seed_threadsafe(config->seed);
+    }
+
+    if (config->houseTemplate) {
+        houseClone(house, config->houseTemplate);
+    } else if (config->roomCount > 0) {
+        house_generate_rooms(house, config->roomCount);
+    } else {
+        house_populate_rooms(house);
+    }
+
+    houseInit(house, config->policy);
+    house->maxOccupancy = config->maxOccupancy;
+    house->boredomMax = config->boredomMax;
+    house->fearMax = config->fearMax;
+    house->control.tickUsec = config->tickUsec;
+    house->seed = config->seed;
+    house->control.timeScale = config->timeScale;
+    house->live = config->live;
+
+    const enum GhostType* ghostTypes;
+    int ghostCount = get_all_ghost_types(&ghostTypes);
+    ghostInit(house, ghostTypes[rand_int_threadsafe(0, ghostCount)], (RoomId)rand_int_threadsafe(0, house->layout->roomCount));
+
+    const enum EvidenceType* devices;
+    int deviceCount = get_all_evidence_types(&devices);
+    char name[MAX_HUNTER_NAME];
+    for (int i = 0; i < config->hunterCount; i++) {
+        snprintf(name, sizeof(name), "hunter %d", i + 1);
+        hunterInit(house, name, i + 1, devices[rand_int_threadsafe(0, deviceCount)]);
+    }
+    housePlaceHunters(house);
+
+    houseRun(house);
+    double wall = seconds_since(&house->started); // from the start gate, so thread creation isn't timed
+
+    simulation_collect(house, wall, result);
+
+    houseCleanup(house);
+}
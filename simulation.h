@@ -0,0 +1,154 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "defs.h"
+
+// Parameters of one non-interactive investigation
+struct SimConfig {
+    int hunterCount;
+    int roomCount;         // 0 = Willow House, otherwise a generated layout with this many rooms
+    int maxOccupancy;      // hunters allowed in a room at once
+    int boredomMax;        // House.boredomMax
+    int fearMax;           // House.fearMax
+    long tickUsec;         // real-time length of one tick before the time scale
+    enum EndPolicy policy;
+    double timeScale;      // 0 = turbo
+    unsigned seed;         // 0 = seeded from the clock
+    struct LiveStats* live; // segment to publish counters in, NULL = none
+    const struct HouseTemplate* houseTemplate; // prebuilt layout for every run, NULL = build it per run from roomCount
+};
+
+#define SIM_MAX_TICK_USEC (60L * 1000 * 1000) // longest tick a driver accepts, one minute
+
+#define SIM_MAX_OUTCOMES 16 // hunters whose individual outcome is kept in a SimResult
+
+// How one hunter's investigation ended
+struct HunterOutcome {
+    uint8_t exitReason;    // enum LogReason
+    uint32_t fear;
+    uint32_t boredom;
+};
+
+// Outcome and counters of one non-interactive investigation
+struct SimResult {
+    unsigned seed;
+    enum GhostType ghostType;
+    EvidenceByte collected;
+    bool solved;
+    int hunterCount;
+    int exitCounts[3];     // hunters that left for each LogReason
+    struct HunterOutcome hunters[SIM_MAX_OUTCOMES]; // the first SIM_MAX_OUTCOMES hunters
+    uint32_t ticks;        // longest-running entity's loop iterations
+    uint64_t moves;        // rooms entered by all hunters
+    uint64_t pickups;      // evidence collected by all hunters
+    double wallSeconds;    // time spent in houseRun
+    struct LockStats lockStats;
+    struct RoomStats roomStats;
+};
+
+/**
+ * @brief Fill a config with the defaults: Willow House, MAX_ROOM_OCCUPANCY, ENTITY_BOREDOM_MAX, HUNTER_FEAR_MAX,
+ *        DEFAULT_TICK_USEC, natural end, turbo, no template.
+ * @param[out] config Config to fill.
+ */
+void simulation_config_default(struct SimConfig* config);
+
+/**
+ * @brief Summarize a House whose threads have finished.
+ * @param[in] house House after houseRun.
+ * @param[in] wallSeconds Time spent in houseRun.
+ * @param[out] result Outcome and counters.
+ */
+void simulation_collect(const struct House* house, double wallSeconds, struct SimResult* result);
+
+/**
+ * @brief Build, run and tear down one House without any prompts.
+ *        The arena must be initialized; it is reset at the end so the next run reuses it.
+ * @param[in,out] house House storage; layout names stay readable after the run.
+ * @param[in] config Run parameters.
+ * @param[out] result Outcome and counters.
+ */
+void simulation_run(struct House* house, const struct SimConfig* config, struct SimResult* result);
+
+/**
+ * @brief Parse a comma separated list of counts such as "1,10,100", each 1..65535.
+ * @param[in] text List text.
+ * @param[out] values Parsed values.
+ * @param[in] max Capacity of values.
+ * @return Number of values parsed, or -1 on bad input or too many values.
+ */
+int simulation_parse_list(const char* text, int* values, int max);
+
+/**
+ * @brief Parse one positive integer.
+ * @param[in] text Number text.
+ * @param[out] value Parsed value.
+ * @return true on success.
+ */
+bool simulation_parse_positive(const char* text, int* value);
+
+/**
+ * @brief Parse a comma separated list of positive longs, each at most limit.
+ * @param[in] text List text.
+ * @param[out] values Parsed values.
+ * @param[in] max Capacity of values.
+ * @param[in] limit Largest value accepted.
+ * @return Number of values parsed, or -1 on bad input or too many values.
+ */
+int simulation_parse_long_list(const char* text, long* values, int max, long limit);
+
+/**
+ * @brief Entry point for `huntSimulation --stress`: sweep hunter counts and report throughput and lock contention.
+ * @param[in] argc Argument count, argv[0] being "--stress".
+ * @param[in] argv Arguments.
+ * @return Process exit status.
+ */
+int stress_main(int argc, char* argv[]);
+
+/**
+ * @brief Entry point for `huntSimulation --sweep`: run every combination of the given parameter lists
+ *        across worker threads and print one table.
+ * @param[in] argc Argument count, argv[0] being "--sweep".
+ * @param[in] argv Arguments.
+ * @return Process exit status.
+ */
+int sweep_main(int argc, char* argv[]);
+
+/**
+ * @brief Entry point for `huntSimulation --analytic`: solve a Markov-chain model of one hunter and the ghost
+ *        on a layout and print its win probability and expected length, without sampling. The chain
+ *        approximates the threaded simulation; --check measures how far off it is.
+ * @param[in] argc Argument count, argv[0] being "--analytic".
+ * @param[in] argv Arguments.
+ * @return Process exit status.
+ */
+int markov_main(int argc, char* argv[]);
+
+/**
+ * @brief Entry point for `huntSimulation --parallel`: run one investigation on the deterministic tick engine,
+ *        which splits rooms between worker threads, once per worker count, and check every run ends in the same state.
+ * @param[in] argc Argument count, argv[0] being "--parallel".
+ * @param[in] argv Arguments.
+ * @return Process exit status; 1 if two worker counts disagree.
+ */
+int tick_main(int argc, char* argv[]);
+
+/**
+ * @brief Entry point for `huntSimulation --events`: run investigations on a single-threaded discrete-event engine
+ *        where every action has its own simulated duration, and summarize them.
+ * @param[in] argc Argument count, argv[0] being "--events".
+ * @param[in] argv Arguments.
+ * @return Process exit status.
+ */
+int events_main(int argc, char* argv[]);
+
+/**
+ * @brief Entry point for `huntSimulation --shards`: run investigations in forked worker processes that pull ranges
+ *        of seeds from shared memory, restarting crashed workers and quarantining seeds that keep crashing.
+ * @param[in] argc Argument count, argv[0] being "--shards".
+ * @param[in] argv Arguments.
+ * @return Process exit status; 1 if any seed was quarantined or left unrun.
+ */
+int shard_main(int argc, char* argv[]);
+
+#endif // SIMULATION_H
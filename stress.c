@@ -0,0 +1,191 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "helpers.h"
+#include "simulation.h"
+#include "results.h"
+#include "live.h"
+#include "profile.h"
+
+#define STRESS_MAX_STEPS 32
+
+static void stress_usage(void) {
+    fprintf(stderr,
+            "Usage: huntSimulation --stress [options]\n"
+            "  --hunters N,N,...   hunter counts to sweep (default 1,2,4,...,1024)\n"
+            "  --rooms N           generated house with N rooms (default: Willow House)\n"
+            "  --occupancy N       hunters allowed per room (default %d; the van is unlimited)\n"
+            "  --repeats N         runs per hunter count (default 5)\n"
+            "  --time-scale X      speed-up factor or 'turbo' (default turbo)\n"
+            "  --end-policy P      natural|solved|ghost-exit (default natural)\n"
+            "  --seed S            base seed; run r of each step uses S + r (default: clock)\n"
+            "  --results FILE      append every run to a columnar results file\n"
+            "  --heatmap           print per-room activity after each step\n"
+            "  --live              publish live counters for --monitor\n"
+            "  --profile           print per-action latency percentiles at the end\n",
+            MAX_ROOM_OCCUPANCY);
+}
+
+// Running mean and variance (Welford) of one throughput figure across repeats
+struct Spread {
+    int n;
+    double mean;
+    double m2;
+};
+
+static void spread_add(struct Spread* spread, double x) {
+    spread->n++;
+    double delta = x - spread->mean;
+    spread->mean += delta / spread->n;
+    spread->m2 += delta * (x - spread->mean);
+}
+
+static double spread_stddev(const struct Spread* spread) {
+    return spread->n > 1 ? sqrt(spread->m2 / (spread->n - 1)) : 0.0;
+}
+
+int stress_main(int argc, char* argv[]) {
+    struct SimConfig config;
+    simulation_config_default(&config);
+
+    int counts[STRESS_MAX_STEPS];
+    int steps = 0;
+    for (int c = 1; c <= 1024 && steps < STRESS_MAX_STEPS; c *= 2) counts[steps++] = c;
+    int repeats = 5;
+    unsigned baseSeed = 0;
+    const char* resultsPath = NULL;
+    bool heatmap = false;
+    bool live = false;
+
+    for (int i = 1; i < argc; i++) {
+        bool ok = i + 1 < argc;
+        if (strcmp(argv[i], "--heatmap") == 0) {
+            heatmap = true;
+            ok = true;
+        }
+        else if (strcmp(argv[i], "--live") == 0) {
+            live = true;
+            ok = true;
+        }
+        else if (strcmp(argv[i], "--profile") == 0) {
+            profile_set_enabled(true);
+            ok = true;
+        }
+        else if (ok && strcmp(argv[i], "--hunters") == 0) {
+            steps = simulation_parse_list(argv[++i], counts, STRESS_MAX_STEPS);
+            ok = steps > 0;
+        }
+        else if (ok && strcmp(argv[i], "--rooms") == 0) ok = simulation_parse_positive(argv[++i], &config.roomCount);
+        else if (ok && strcmp(argv[i], "--occupancy") == 0) ok = simulation_parse_positive(argv[++i], &config.maxOccupancy);
+        else if (ok && strcmp(argv[i], "--repeats") == 0) ok = simulation_parse_positive(argv[++i], &repeats);
+        else if (ok && strcmp(argv[i], "--time-scale") == 0) ok = time_scale_from_string(argv[++i], &config.timeScale);
+        else if (ok && strcmp(argv[i], "--end-policy") == 0) ok = end_policy_from_string(argv[++i], &config.policy);
+        else if (ok && strcmp(argv[i], "--seed") == 0) baseSeed = (unsigned)strtoul(argv[++i], NULL, 10);
+        else if (ok && strcmp(argv[i], "--results") == 0) resultsPath = argv[++i];
+        else ok = false;
+
+        if (!ok) {
+            stress_usage();
+            return 1;
+        }
+    }
+
+    // per-event output would dominate the measurement
+    log_set_sinks(0);
+    lock_timing_set_enabled(true);
+    log_set_time_scale(config.timeScale);
+
+    struct ResultsWriter results;
+    if (resultsPath && resultsOpen(&results, resultsPath, SIM_MAX_OUTCOMES) != 0) return 1;
+
+    if (live && (config.live = liveOpen()) == NULL) return 1;
+
+    static struct House house; // too large to keep on the stack comfortably
+    arenaInit(&house.arena, HOUSE_ARENA_SIZE);
+
+    // Willow House is the same every run; generated houses come from each run's seed
+    static struct HouseTemplate willow;
+    if (config.roomCount == 0) {
+        house_template_init(&willow, 0);
+        config.houseTemplate = &willow;
+    }
+
+    printf("Stress: %s, occupancy %d, %d run(s) per step, time scale %s\n",
+           config.roomCount > 0 ? "generated house" : "Willow House",
+           config.maxOccupancy, repeats, config.timeScale > 0 ? "scaled" : "turbo");
+    printf("%8s %14s %8s %14s %10s %12s %10s %12s  %s\n",
+           "hunters", "moves/s", "+/-%", "pickups/s", "wall ms", "lock acq", "contended", "avg wait us", "hottest room");
+
+    struct SimResult result;
+    for (int step = 0; step < steps; step++) {
+        config.hunterCount = counts[step];
+
+        struct Spread moveRate = {0};
+        struct Spread pickupRate = {0};
+        struct Spread wall = {0};
+        struct LockStats total;
+        memset(&total, 0, sizeof(total));
+        static struct RoomStats rooms;
+        memset(&rooms, 0, sizeof(rooms));
+
+        for (int r = 0; r < repeats; r++) {
+            config.seed = baseSeed ? baseSeed + (unsigned)r : 0;
+            simulation_run(&house, &config, &result);
+            if (resultsPath && resultsAppend(&results, &result) != 0) {
+                resultsClose(&results);
+                arenaDestroy(&house.arena);
+                return 1;
+            }
+
+            double seconds = result.wallSeconds > 0 ? result.wallSeconds : 1e-9;
+            spread_add(&moveRate, (double)result.moves / seconds);
+            spread_add(&pickupRate, (double)result.pickups / seconds);
+            spread_add(&wall, result.wallSeconds * 1000.0);
+
+            total.acquires += result.lockStats.acquires;
+            total.contended += result.lockStats.contended;
+            total.waitNs += result.lockStats.waitNs;
+            for (int i = 0; i < house.layout->roomCount; i++) {
+                total.roomWaitNs[i] += result.lockStats.roomWaitNs[i];
+            }
+            room_stats_add(&rooms, &result.roomStats, house.layout->roomCount);
+        }
+
+        int hottest = 0;
+        for (int i = 1; i < house.layout->roomCount; i++) {
+            if (total.roomWaitNs[i] > total.roomWaitNs[hottest]) hottest = i;
+        }
+
+        double contended = total.acquires ? 100.0 * (double)total.contended / (double)total.acquires : 0.0;
+        double avgWaitUs = total.contended ? (double)total.waitNs / (double)total.contended / 1000.0 : 0.0;
+        double variation = moveRate.mean > 0 ? 100.0 * spread_stddev(&moveRate) / moveRate.mean : 0.0;
+
+        printf("%8d %14.0f %7.1f%% %14.0f %10.1f %12llu %9.2f%% %12.2f  %s\n",
+               config.hunterCount,
+               moveRate.mean,
+               variation,
+               pickupRate.mean,
+               wall.mean,
+               (unsigned long long)(total.acquires / (uint64_t)repeats),
+               contended,
+               avgWaitUs,
+               total.waitNs ? room_name(&house, (RoomId)hottest) : "-");
+        if (heatmap) {
+            printf("\n");
+            room_stats_print(&house, &rooms);
+            printf("\n");
+        }
+        fflush(stdout);
+    }
+
+    if (profile_enabled) {
+        printf("\nAction latency, all steps:\n");
+        profile_print(stdout);
+    }
+
+    arenaDestroy(&house.arena);
+    liveClose(config.live);
+    if (resultsPath && resultsClose(&results) != 0) return 1;
+    return 0;
+}
@@ -0,0 +1,229 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdatomic.h>
+#include "helpers.h"
+#include "simulation.h"
+
+#define SWEEP_MAX_VALUES 16
+#define SWEEP_MAX_WORKERS 256
+
+// One swept parameter and the values it takes
+enum SweepAxis {
+    AXIS_HUNTERS = 0,
+    AXIS_BOREDOM,
+    AXIS_FEAR,
+    AXIS_OCCUPANCY,
+    AXIS_TICK,
+    AXIS_COUNT
+};
+
+static const char* axisFlags[AXIS_COUNT] = { "--hunters", "--boredom", "--fear", "--occupancy", "--tick-us" };
+
+// Counts and thresholds stay small; ticks are microseconds and start at DEFAULT_TICK_USEC
+static const long axisLimits[AXIS_COUNT] = { 65535, 65535, 65535, 65535, SIM_MAX_TICK_USEC };
+
+struct SweepAxisValues {
+    long values[SWEEP_MAX_VALUES];
+    int count;
+};
+
+// What the table needs from one run
+struct SweepOutcome {
+    bool won;              // collected evidence matches the ghost
+    bool solved;
+    int hunters;
+    int exitCounts[3];
+    uint32_t ticks;
+    double wallSeconds;
+};
+
+// Shared by the workers; every job writes only its own outcome
+struct Sweep {
+    struct SimConfig base;
+    struct SweepAxisValues axes[AXIS_COUNT];
+    int combinations;
+    int replicates;
+    unsigned baseSeed;
+    struct SweepOutcome* outcomes; // combinations * replicates
+    atomic_int nextJob;
+};
+
+static void sweep_usage(void) {
+    fprintf(stderr,
+            "Usage: huntSimulation --sweep [options]\n"
+            "Every combination of the lists below is run --replicates times across worker threads.\n"
+            "  --hunters N,N,...     hunter counts (default 4)\n"
+            "  --boredom N,N,...     boredom limits (default %d)\n"
+            "  --fear N,N,...        fear limits (default %d)\n"
+            "  --occupancy N,N,...   hunters allowed per room (default %d)\n"
+            "  --tick-us N,N,...     tick length in microseconds before the time scale, up to %ld (default %d)\n"
+            "  --replicates N        runs per combination (default 10)\n"
+            "  --jobs N              worker threads (default: one per core)\n"
+            "  --rooms N             generated house with N rooms (default: Willow House)\n"
+            "  --time-scale X        speed-up factor or 'turbo' (default turbo)\n"
+            "  --end-policy P        natural|solved|ghost-exit (default natural)\n"
+            "  --seed S              base seed; job j uses S + j (default: clock)\n",
+            ENTITY_BOREDOM_MAX, HUNTER_FEAR_MAX, MAX_ROOM_OCCUPANCY, SIM_MAX_TICK_USEC, DEFAULT_TICK_USEC);
+}
+
+// Decode a combination index into one config, the first axis varying slowest
+static void sweep_config(const struct Sweep* sweep, int combination, struct SimConfig* config) {
+    long value[AXIS_COUNT];
+    for (int a = AXIS_COUNT - 1; a >= 0; a--) {
+        value[a] = sweep->axes[a].values[combination % sweep->axes[a].count];
+        combination /= sweep->axes[a].count;
+    }
+
+    *config = sweep->base;
+    config->hunterCount = (int)value[AXIS_HUNTERS];
+    config->boredomMax = (int)value[AXIS_BOREDOM];
+    config->fearMax = (int)value[AXIS_FEAR];
+    config->maxOccupancy = (int)value[AXIS_OCCUPANCY];
+    config->tickUsec = value[AXIS_TICK];
+}
+
+static void* sweepWorker(void* arg) {
+    struct Sweep* sweep = arg;
+    int jobs = sweep->combinations * sweep->replicates;
+
+    // each worker runs its houses one after another in its own arena
+    struct House* house = aligned_alloc(_Alignof(struct House), sizeof(struct House));
+    arenaInit(&house->arena, HOUSE_ARENA_SIZE);
+    struct SimResult* result = malloc(sizeof(*result));
+
+    int job;
+    while ((job = atomic_fetch_add(&sweep->nextJob, 1)) < jobs) {
+        struct SimConfig config;
+        sweep_config(sweep, job / sweep->replicates, &config);
+        config.seed = sweep->baseSeed ? sweep->baseSeed + (unsigned)job : 0;
+
+        simulation_run(house, &config, result);
+
+        struct SweepOutcome* outcome = &sweep->outcomes[job];
+        outcome->won = result->collected == (EvidenceByte)result->ghostType;
+        outcome->solved = result->solved;
+        outcome->hunters = result->hunterCount;
+        memcpy(outcome->exitCounts, result->exitCounts, sizeof(outcome->exitCounts));
+        outcome->ticks = result->ticks;
+        outcome->wallSeconds = result->wallSeconds;
+    }
+
+    free(result);
+    arenaDestroy(&house->arena);
+    free(house);
+    return NULL;
+}
+
+static void sweep_print(const struct Sweep* sweep) {
+    printf("%8s %8s %6s %9s %8s | %6s %7s %7s %7s %7s %8s %9s %9s\n",
+           "hunters", "boredom", "fear", "occupancy", "tick us",
+           "runs", "win", "solved", "evid", "bored", "afraid", "ticks", "wall ms");
+
+    for (int c = 0; c < sweep->combinations; c++) {
+        struct SimConfig config;
+        sweep_config(sweep, c, &config);
+
+        int wins = 0, solved = 0, hunters = 0;
+        int exits[3] = {0};
+        double ticks = 0, wall = 0;
+        for (int r = 0; r < sweep->replicates; r++) {
+            const struct SweepOutcome* outcome = &sweep->outcomes[c * sweep->replicates + r];
+            wins += outcome->won;
+            solved += outcome->solved;
+            hunters += outcome->hunters;
+            for (int e = 0; e < 3; e++) exits[e] += outcome->exitCounts[e];
+            ticks += outcome->ticks;
+            wall += outcome->wallSeconds;
+        }
+
+        double runs = sweep->replicates;
+        double people = hunters > 0 ? hunters : 1;
+        printf("%8d %8d %6d %9d %8ld | %6d %6.1f%% %6.1f%% %6.1f%% %6.1f%% %7.1f%% %9.1f %9.2f\n",
+               config.hunterCount, config.boredomMax, config.fearMax, config.maxOccupancy, config.tickUsec,
+               sweep->replicates,
+               100.0 * wins / runs, 100.0 * solved / runs,
+               100.0 * exits[LR_EVIDENCE] / people, 100.0 * exits[LR_BORED] / people, 100.0 * exits[LR_AFRAID] / people,
+               ticks / runs, 1000.0 * wall / runs);
+    }
+}
+
+int sweep_main(int argc, char* argv[]) {
+    static struct Sweep sweep;
+    simulation_config_default(&sweep.base);
+
+    long defaults[AXIS_COUNT] = { 4, ENTITY_BOREDOM_MAX, HUNTER_FEAR_MAX, MAX_ROOM_OCCUPANCY, DEFAULT_TICK_USEC };
+    for (int a = 0; a < AXIS_COUNT; a++) {
+        sweep.axes[a].values[0] = defaults[a];
+        sweep.axes[a].count = 1;
+    }
+    sweep.replicates = 10;
+    int workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+    for (int i = 1; i < argc; i++) {
+        bool ok = i + 1 < argc;
+        int axis = -1;
+        for (int a = 0; a < AXIS_COUNT; a++) {
+            if (strcmp(argv[i], axisFlags[a]) == 0) axis = a;
+        }
+
+        if (ok && axis >= 0) {
+            sweep.axes[axis].count = simulation_parse_long_list(argv[++i], sweep.axes[axis].values, SWEEP_MAX_VALUES, axisLimits[axis]);
+            ok = sweep.axes[axis].count > 0;
+        }
+        else if (ok && strcmp(argv[i], "--replicates") == 0) ok = simulation_parse_positive(argv[++i], &sweep.replicates);
+        else if (ok && strcmp(argv[i], "--jobs") == 0) ok = simulation_parse_positive(argv[++i], &workers);
+        else if (ok && strcmp(argv[i], "--rooms") == 0) ok = simulation_parse_positive(argv[++i], &sweep.base.roomCount);
+        else if (ok && strcmp(argv[i], "--time-scale") == 0) ok = time_scale_from_string(argv[++i], &sweep.base.timeScale);
+        else if (ok && strcmp(argv[i], "--end-policy") == 0) ok = end_policy_from_string(argv[++i], &sweep.base.policy);
+        else if (ok && strcmp(argv[i], "--seed") == 0) sweep.baseSeed = (unsigned)strtoul(argv[++i], NULL, 10);
+        else ok = false;
+
+        if (!ok) {
+            sweep_usage();
+            return 1;
+        }
+    }
+
+    sweep.combinations = 1;
+    for (int a = 0; a < AXIS_COUNT; a++) sweep.combinations *= sweep.axes[a].count;
+    int jobs = sweep.combinations * sweep.replicates;
+    if (workers > SWEEP_MAX_WORKERS) workers = SWEEP_MAX_WORKERS;
+    if (workers > jobs) workers = jobs;
+
+    sweep.outcomes = calloc((size_t)jobs, sizeof(*sweep.outcomes));
+    if (sweep.outcomes == NULL) {
+        fprintf(stderr, "sweep: out of memory\n");
+        return 1;
+    }
+
+    // Willow House is built once and shared read-only by every worker; generated houses come from each run's seed
+    static struct HouseTemplate willow;
+    if (sweep.base.roomCount == 0) {
+        house_template_init(&willow, 0);
+        sweep.base.houseTemplate = &willow;
+    }
+
+    // per-event output would swamp the table
+    log_set_sinks(0);
+    log_set_time_scale(sweep.base.timeScale);
+
+    printf("Sweep: %d combination(s) x %d replicate(s) on %d worker(s), %s, time scale %s\n",
+           sweep.combinations, sweep.replicates, workers,
+           sweep.base.roomCount > 0 ? "generated house" : "Willow House",
+           sweep.base.timeScale > 0 ? "scaled" : "turbo");
+    fflush(stdout);
+
+    pthread_t threads[SWEEP_MAX_WORKERS];
+    for (int w = 0; w < workers; w++) {
+        pthread_create(&threads[w], NULL, sweepWorker, &sweep);
+    }
+    for (int w = 0; w < workers; w++) {
+        pthread_join(threads[w], NULL);
+    }
+
+    sweep_print(&sweep);
+    free(sweep.outcomes);
+    return 0;
+}
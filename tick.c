@@ -0,0 +1,743 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "helpers.h"
+#include "simulation.h"
+
+/*
+    Parallel tick engine: a lock-free, deterministic alternative to houseRun for large rosters.
+
+    Every entity acts once per tick on the state at the start of the tick. Rooms are split into
+    contiguous ranges, one per worker, and a worker owns every entity standing in its rooms. A tick has
+    three phases separated by barriers:
+
+      intent  each worker runs its entities' rules and records what they want: a pickup, a haunt, or a
+              move, which goes into the mailbox from this worker to the one owning the target room.
+      commit  each worker settles the claims on its own rooms: pickups in priority order (the first
+              hunter to claim a piece of evidence gets it), then the ghost's haunt; moves into its rooms
+              are admitted in priority order until the occupancy cap, counting from the occupancy at
+              the start of the tick.
+      settle  each worker takes admitted hunters out of its rooms and adds the ones it admitted;
+              worker 0 then folds the per-worker case file bits, exits and phase changes into the
+              House-wide state.
+
+    Random draws are a hash of (seed, entity, tick, purpose) rather than a per-thread stream, and
+    every conflict is settled by a priority drawn the same way, so the outcome is bit-identical for any
+    number of workers.
+
+    Differences from the threaded rules: the ghost and the hunters see each other's tick-start
+    positions; a pickup takes the hunter's whole tick; a hunter that loses a pickup or is turned away
+    from a full room tries again next tick instead of queueing; nothing is logged.
+*/
+
+#define TICK_MAX_THREADS 64
+#define TICK_MAX_STEPS 16
+#define TICK_MAX_HUNTERS 1000000
+#define TICK_GHOST_ENTITY 0xFFFFFFFFu // entity number of the ghost in draws
+
+enum TickDraw {
+    DRAW_GHOST_TYPE = 0,
+    DRAW_GHOST_ROOM,
+    DRAW_DEVICE,
+    DRAW_ACTION,
+    DRAW_TARGET,
+    DRAW_EVIDENCE,
+    DRAW_SWAP,
+    DRAW_PRIORITY
+};
+
+enum TickIntent {
+    TI_NONE = 0,
+    TI_MOVE,
+    TI_PICKUP,
+    TI_HAUNT,  // ghost only
+    TI_LEAVE   // ghost only
+};
+
+struct TickHunter {
+    RoomId room;
+    RoomId target;          // room of a TI_MOVE intent
+    uint8_t intent;         // enum TickIntent, written in the intent phase
+    bool admitted;          // set by the target room's owner during commit
+    bool exited;
+    bool returning;
+    uint8_t exitReason;     // enum LogReason
+    EvidenceByte device;
+    int fear;
+    int boredom;
+    int moves;
+    int pickups;
+    int ticks;
+    RoomId* path;           // rooms to retrace to the van, last entered on top
+    int pathCount;
+    int pathCapacity;
+} __attribute__((aligned(CACHE_LINE)));
+
+struct TickGhost {
+    enum GhostType type;
+    RoomId room;
+    RoomId target;          // room of a TI_MOVE intent
+    uint8_t intent;
+    EvidenceByte haunt;     // evidence of a TI_HAUNT intent
+    bool exited;
+    int boredom;
+    int ticks;
+};
+
+struct TickRoom {
+    uint32_t numHunters;    // at the start of the tick
+    uint32_t arrivals;      // admitted during commit, added in settle
+    EvidenceByte evidence;
+    bool hasGhost;
+};
+
+// A move or pickup waiting to be settled; lower keys win
+struct TickClaim {
+    uint64_t key;
+    uint32_t hunter;
+};
+
+// Claims from one worker to another: written by the sender in the intent phase, emptied by the receiver in commit
+struct TickMailbox {
+    struct TickClaim* claims;
+    int count;
+    int capacity;
+} __attribute__((aligned(CACHE_LINE)));
+
+struct TickEngine;
+
+struct TickWorker {
+    struct TickEngine* engine;
+    int index;
+    pthread_t thread;
+    uint32_t* members;      // hunters in this worker's rooms
+    int memberCount;
+    int memberCapacity;
+    uint32_t* next;         // members being rebuilt during settle
+    int nextCapacity;
+    struct TickMailbox pickups;  // claims on this worker's rooms
+    struct TickMailbox arrivals; // admitted moves into this worker's rooms
+
+    // this tick's contribution, folded by worker 0
+    EvidenceByte collected;
+    int exits;
+    bool solved;
+    bool ghostLeft;
+} __attribute__((aligned(CACHE_LINE)));
+
+struct TickEngine {
+    const struct RoomLayout* layout;
+    int maxOccupancy;
+    int boredomMax;
+    int fearMax;
+    enum EndPolicy policy;
+    unsigned seed;
+
+    struct TickRoom rooms[MAX_ROOMS];
+    int owner[MAX_ROOMS];   // worker of each room
+    struct TickHunter* hunters;
+    int hunterCount;
+    struct TickGhost ghost;
+
+    // changed only by worker 0 between ticks
+    EvidenceByte casefile;
+    bool solved;
+    enum HousePhase phase;
+    uint32_t tick;
+    int active;             // hunters still in the House
+    bool done;
+
+    int workerCount;
+    struct TickWorker* workers;
+    struct TickMailbox* mailboxes; // [sender * workerCount + receiver]
+    pthread_barrier_t barrier;
+};
+
+// ---- Draws ----
+
+static uint64_t splitmix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+static uint64_t tick_hash(const struct TickEngine* engine, uint32_t entity, enum TickDraw draw) {
+    uint64_t x = splitmix64(engine->seed);
+    x = splitmix64(x ^ entity);
+    return splitmix64(x ^ ((uint64_t)engine->tick << 8 | (uint64_t)draw));
+}
+
+// Uniform-enough integer in [0, n)
+static int tick_draw(const struct TickEngine* engine, uint32_t entity, enum TickDraw draw, int n) {
+    return (int)(tick_hash(engine, entity, draw) % (uint64_t)n);
+}
+
+static void mailbox_push(struct TickMailbox* mailbox, uint64_t key, uint32_t hunter) {
+    if (mailbox->count == mailbox->capacity) {
+        mailbox->capacity = mailbox->capacity ? mailbox->capacity * 2 : 64;
+        mailbox->claims = realloc(mailbox->claims, (size_t)mailbox->capacity * sizeof(*mailbox->claims));
+        if (mailbox->claims == NULL) {
+            perror("tick engine");
+            exit(1);
+        }
+    }
+    mailbox->claims[mailbox->count++] = (struct TickClaim){ key, hunter };
+}
+
+static int compare_claims(const void* a, const void* b) {
+    const struct TickClaim* left = a;
+    const struct TickClaim* right = b;
+    if (left->key != right->key) return left->key < right->key ? -1 : 1;
+    return (left->hunter > right->hunter) - (left->hunter < right->hunter);
+}
+
+// ---- Intent ----
+
+static void hunter_exit(struct TickWorker* worker, struct TickHunter* hunter, enum LogReason reason) {
+    hunter->exited = true;
+    hunter->exitReason = (uint8_t)reason;
+    worker->exits++;
+}
+
+// One hunter's turn, mirroring hunterLoop on the tick-start state
+static void hunter_intent(struct TickWorker* worker, uint32_t index) {
+    struct TickEngine* engine = worker->engine;
+    const struct RoomLayout* layout = engine->layout;
+    struct TickHunter* hunter = &engine->hunters[index];
+    const struct TickRoom* room = &engine->rooms[hunter->room];
+
+    hunter->ticks++;
+    hunter->intent = TI_NONE;
+    hunter->admitted = false;
+
+    if (room->hasGhost) {
+        hunter->fear++;
+        hunter->boredom = 0;
+    } else {
+        hunter->boredom++;
+    }
+    if (hunter->boredom > engine->boredomMax) {
+        hunter_exit(worker, hunter, LR_BORED);
+        return;
+    }
+    if (hunter->fear > engine->fearMax) {
+        hunter_exit(worker, hunter, LR_AFRAID);
+        return;
+    }
+
+    if (engine->phase == PHASE_ENDED) {
+        hunter_exit(worker, hunter, engine->solved ? LR_EVIDENCE : LR_BORED);
+        return;
+    }
+    if (engine->phase == PHASE_RETURNING) hunter->returning = true;
+
+    if (hunter->returning && hunter->pathCount > 0) {
+        hunter->intent = TI_MOVE;
+        hunter->target = hunter->path[hunter->pathCount - 1];
+        mailbox_push(&engine->mailboxes[worker->index * engine->workerCount + engine->owner[hunter->target]],
+                     tick_hash(engine, index, DRAW_PRIORITY), index);
+        return;
+    }
+
+    // van arrival: hand in the case file or swap devices
+    if (layout->isExit[hunter->room] && hunter->returning) {
+        hunter->returning = false;
+        hunter->pathCount = 0;
+        if (evidence_names_ghost(engine->casefile)) {
+            hunter_exit(worker, hunter, LR_EVIDENCE);
+            worker->solved = true;
+            return;
+        }
+        if (engine->phase == PHASE_RETURNING) {
+            hunter_exit(worker, hunter, LR_BORED);
+            return;
+        }
+
+        const enum EvidenceType* devices;
+        int deviceCount = get_all_evidence_types(&devices);
+        int pick = tick_draw(engine, index, DRAW_SWAP, deviceCount - 1);
+        if (devices[pick] == hunter->device) pick = deviceCount - 1; // skip the current device
+        hunter->device = (EvidenceByte)devices[pick];
+    }
+
+    if (room->evidence & hunter->device) {
+        hunter->intent = TI_PICKUP;
+        mailbox_push(&worker->pickups, tick_hash(engine, index, DRAW_PRIORITY), index);
+        return;
+    }
+
+    if (!hunter->returning) {
+        int connections = layout->numConnections[hunter->room];
+        hunter->intent = TI_MOVE;
+        hunter->target = layout->connected[hunter->room][tick_draw(engine, index, DRAW_TARGET, connections)];
+        mailbox_push(&engine->mailboxes[worker->index * engine->workerCount + engine->owner[hunter->target]],
+                     tick_hash(engine, index, DRAW_PRIORITY), index);
+    }
+}
+
+// The ghost's turn, mirroring ghostLoop; run by the owner of its room
+static void ghost_intent(struct TickWorker* worker) {
+    struct TickEngine* engine = worker->engine;
+    struct TickGhost* ghost = &engine->ghost;
+
+    ghost->ticks++;
+    ghost->intent = TI_NONE;
+    if (engine->phase == PHASE_ENDED) {
+        ghost->intent = TI_LEAVE;
+        return;
+    }
+
+    int choice;
+    if (engine->rooms[ghost->room].numHunters > 0) {
+        ghost->boredom = 0;
+        choice = 1 + tick_draw(engine, TICK_GHOST_ENTITY, DRAW_ACTION, 2);
+    } else {
+        ghost->boredom++;
+        choice = 1 + tick_draw(engine, TICK_GHOST_ENTITY, DRAW_ACTION, 3);
+    }
+    if (ghost->boredom > engine->boredomMax) {
+        ghost->intent = TI_LEAVE;
+        return;
+    }
+
+    if (choice == 2) {
+        // the k-th of the ghost's three evidence bits
+        int k = tick_draw(engine, TICK_GHOST_ENTITY, DRAW_EVIDENCE, 3);
+        EvidenceByte bits = (EvidenceByte)ghost->type;
+        while (k-- > 0) bits &= (EvidenceByte)(bits - 1);
+        ghost->intent = TI_HAUNT;
+        ghost->haunt = bits & (EvidenceByte)-bits;
+    }
+    else if (choice == 3 && engine->layout->numConnections[ghost->room] > 0) {
+        int connections = engine->layout->numConnections[ghost->room];
+        ghost->intent = TI_MOVE;
+        ghost->target = engine->layout->connected[ghost->room][tick_draw(engine, TICK_GHOST_ENTITY, DRAW_TARGET, connections)];
+    }
+}
+
+// ---- Commit ----
+
+static void worker_commit(struct TickWorker* worker) {
+    struct TickEngine* engine = worker->engine;
+    const struct RoomLayout* layout = engine->layout;
+    struct TickGhost* ghost = &engine->ghost;
+
+    // pickups before the haunt, so evidence left this tick is found from the next one
+    if (worker->pickups.count > 1) qsort(worker->pickups.claims, (size_t)worker->pickups.count, sizeof(struct TickClaim), compare_claims);
+    for (int i = 0; i < worker->pickups.count; i++) {
+        struct TickHunter* hunter = &engine->hunters[worker->pickups.claims[i].hunter];
+        struct TickRoom* room = &engine->rooms[hunter->room];
+        if (!(room->evidence & hunter->device)) continue; // taken by a hunter with a lower key
+        room->evidence &= (EvidenceByte)~hunter->device;
+        hunter->pickups++;
+        worker->collected |= hunter->device;
+        if (!layout->isExit[hunter->room]) hunter->returning = true;
+    }
+    worker->pickups.count = 0;
+
+    if (!ghost->exited) {
+        if (engine->owner[ghost->room] == worker->index) {
+            if (ghost->intent == TI_HAUNT) engine->rooms[ghost->room].evidence |= ghost->haunt;
+            if (ghost->intent == TI_MOVE || ghost->intent == TI_LEAVE) engine->rooms[ghost->room].hasGhost = false;
+        }
+        if (ghost->intent == TI_MOVE && engine->owner[ghost->target] == worker->index) {
+            engine->rooms[ghost->target].hasGhost = true;
+        }
+    }
+
+    // moves into this worker's rooms, from every worker, in key order
+    struct TickMailbox* arrivals = &worker->arrivals;
+    for (int sender = 0; sender < engine->workerCount; sender++) {
+        struct TickMailbox* mailbox = &engine->mailboxes[sender * engine->workerCount + worker->index];
+        for (int i = 0; i < mailbox->count; i++) {
+            mailbox_push(arrivals, mailbox->claims[i].key, mailbox->claims[i].hunter);
+        }
+        mailbox->count = 0;
+    }
+    if (arrivals->count > 1) qsort(arrivals->claims, (size_t)arrivals->count, sizeof(struct TickClaim), compare_claims);
+
+    int admitted = 0;
+    for (int i = 0; i < arrivals->count; i++) {
+        struct TickHunter* hunter = &engine->hunters[arrivals->claims[i].hunter];
+        struct TickRoom* target = &engine->rooms[hunter->target];
+        if (!layout->isExit[hunter->target] && target->numHunters + target->arrivals >= (uint32_t)engine->maxOccupancy) continue;
+        target->arrivals++;
+        hunter->admitted = true;
+        arrivals->claims[admitted++] = arrivals->claims[i];
+    }
+    arrivals->count = admitted;
+}
+
+// ---- Settle ----
+
+static void worker_settle(struct TickWorker* worker) {
+    struct TickEngine* engine = worker->engine;
+    struct TickGhost* ghost = &engine->ghost;
+
+    int needed = worker->memberCount + worker->arrivals.count;
+    if (needed > worker->nextCapacity) {
+        worker->nextCapacity = needed * 2;
+        worker->next = realloc(worker->next, (size_t)worker->nextCapacity * sizeof(*worker->next));
+        if (worker->next == NULL) {
+            perror("tick engine");
+            exit(1);
+        }
+    }
+
+    int kept = 0;
+    for (int i = 0; i < worker->memberCount; i++) {
+        uint32_t index = worker->members[i];
+        struct TickHunter* hunter = &engine->hunters[index];
+
+        if (hunter->exited) {
+            engine->rooms[hunter->room].numHunters--;
+            continue;
+        }
+        if (hunter->intent != TI_MOVE || !hunter->admitted) {
+            worker->next[kept++] = index;
+            continue;
+        }
+
+        // the target's owner lists the hunter from now on
+        engine->rooms[hunter->room].numHunters--;
+        if (hunter->returning) {
+            hunter->pathCount--;
+        } else {
+            if (hunter->pathCount == hunter->pathCapacity) {
+                hunter->pathCapacity = hunter->pathCapacity ? hunter->pathCapacity * 2 : 16;
+                hunter->path = realloc(hunter->path, (size_t)hunter->pathCapacity);
+                if (hunter->path == NULL) {
+                    perror("tick engine");
+                    exit(1);
+                }
+            }
+            hunter->path[hunter->pathCount++] = hunter->room;
+        }
+        hunter->room = hunter->target;
+        hunter->moves++;
+    }
+
+    for (int i = 0; i < worker->arrivals.count; i++) {
+        worker->next[kept++] = worker->arrivals.claims[i].hunter;
+    }
+    worker->arrivals.count = 0;
+    for (int r = 0; r < engine->layout->roomCount; r++) {
+        if (engine->owner[r] != worker->index) continue;
+        engine->rooms[r].numHunters += engine->rooms[r].arrivals;
+        engine->rooms[r].arrivals = 0;
+    }
+
+    uint32_t* swap = worker->members;
+    int swapCapacity = worker->memberCapacity;
+    worker->members = worker->next;
+    worker->memberCapacity = worker->nextCapacity;
+    worker->memberCount = kept;
+    worker->next = swap;
+    worker->nextCapacity = swapCapacity;
+
+    if (!ghost->exited && engine->owner[ghost->room] == worker->index) {
+        if (ghost->intent == TI_LEAVE) {
+            ghost->exited = true;
+            worker->ghostLeft = true;
+        }
+        else if (ghost->intent == TI_MOVE) {
+            ghost->room = ghost->target;
+        }
+    }
+}
+
+// Worker 0, between ticks: fold every worker's contribution into the House-wide state
+static void engine_fold(struct TickEngine* engine) {
+    bool solved = false;
+    bool ghostLeft = false;
+    for (int w = 0; w < engine->workerCount; w++) {
+        struct TickWorker* worker = &engine->workers[w];
+        engine->casefile |= worker->collected;
+        engine->active -= worker->exits;
+        solved |= worker->solved;
+        ghostLeft |= worker->ghostLeft;
+        worker->collected = 0;
+        worker->exits = 0;
+        worker->solved = false;
+        worker->ghostLeft = false;
+    }
+
+    if (solved) {
+        engine->solved = true;
+        if (engine->policy == END_WHEN_SOLVED) engine->phase = PHASE_ENDED;
+    }
+    if (ghostLeft && engine->policy == END_WHEN_GHOST_EXITS && engine->phase == PHASE_INVESTIGATING) {
+        engine->phase = PHASE_RETURNING;
+    }
+    engine->tick++;
+    engine->done = engine->active == 0 && engine->ghost.exited;
+}
+
+static void* tickWorkerFunction(void* arg) {
+    struct TickWorker* worker = arg;
+    struct TickEngine* engine = worker->engine;
+
+    while (!engine->done) {
+        for (int i = 0; i < worker->memberCount; i++) {
+            hunter_intent(worker, worker->members[i]);
+        }
+        if (!engine->ghost.exited && engine->owner[engine->ghost.room] == worker->index) {
+            ghost_intent(worker);
+        }
+        pthread_barrier_wait(&engine->barrier);
+
+        worker_commit(worker);
+        pthread_barrier_wait(&engine->barrier);
+
+        worker_settle(worker);
+        pthread_barrier_wait(&engine->barrier);
+
+        if (worker->index == 0) engine_fold(engine);
+        pthread_barrier_wait(&engine->barrier);
+    }
+    return NULL;
+}
+
+// ---- Runs ----
+
+// Place every entity from the seed alone, so the start doesn't depend on the worker count either
+static void engine_init(struct TickEngine* engine, const struct RoomLayout* layout, const struct SimConfig* config, int workers) {
+    engine->layout = layout;
+    engine->maxOccupancy = config->maxOccupancy;
+    engine->boredomMax = config->boredomMax;
+    engine->fearMax = config->fearMax;
+    engine->policy = config->policy;
+    engine->seed = config->seed;
+    engine->casefile = 0;
+    engine->solved = false;
+    engine->phase = PHASE_INVESTIGATING;
+    engine->tick = 0;
+    engine->done = false;
+
+    if (workers > layout->roomCount) workers = layout->roomCount;
+    engine->workerCount = workers;
+    for (int r = 0; r < layout->roomCount; r++) {
+        engine->owner[r] = r * workers / layout->roomCount;
+        engine->rooms[r] = (struct TickRoom){ 0 };
+    }
+
+    const enum GhostType* ghostTypes;
+    int ghostCount = get_all_ghost_types(&ghostTypes);
+    engine->ghost = (struct TickGhost){
+        .type = ghostTypes[tick_draw(engine, TICK_GHOST_ENTITY, DRAW_GHOST_TYPE, ghostCount)],
+        .room = (RoomId)tick_draw(engine, TICK_GHOST_ENTITY, DRAW_GHOST_ROOM, layout->roomCount),
+    };
+    engine->rooms[engine->ghost.room].hasGhost = true;
+
+    const enum EvidenceType* devices;
+    int deviceCount = get_all_evidence_types(&devices);
+    engine->hunterCount = config->hunterCount;
+    engine->active = config->hunterCount;
+    engine->hunters = aligned_alloc(CACHE_LINE, (size_t)config->hunterCount * sizeof(struct TickHunter));
+    engine->workers = aligned_alloc(CACHE_LINE, (size_t)workers * sizeof(struct TickWorker));
+    engine->mailboxes = aligned_alloc(CACHE_LINE, (size_t)workers * (size_t)workers * sizeof(struct TickMailbox));
+    if (!engine->hunters || !engine->workers || !engine->mailboxes) {
+        perror("tick engine");
+        exit(1);
+    }
+    memset(engine->workers, 0, (size_t)workers * sizeof(struct TickWorker));
+    memset(engine->mailboxes, 0, (size_t)workers * (size_t)workers * sizeof(struct TickMailbox));
+
+    struct TickWorker* van = &engine->workers[engine->owner[layout->start]];
+    van->memberCapacity = config->hunterCount;
+    van->members = malloc((size_t)config->hunterCount * sizeof(*van->members));
+    if (van->members == NULL) {
+        perror("tick engine");
+        exit(1);
+    }
+    for (int i = 0; i < config->hunterCount; i++) {
+        engine->hunters[i] = (struct TickHunter){
+            .room = layout->start,
+            .device = (EvidenceByte)devices[tick_draw(engine, (uint32_t)i, DRAW_DEVICE, deviceCount)],
+            .exitReason = LR_BORED,
+        };
+        van->members[van->memberCount++] = (uint32_t)i;
+    }
+    engine->rooms[layout->start].numHunters = (uint32_t)config->hunterCount;
+
+    for (int w = 0; w < workers; w++) {
+        engine->workers[w].engine = engine;
+        engine->workers[w].index = w;
+    }
+    pthread_barrier_init(&engine->barrier, NULL, (unsigned)workers);
+}
+
+static void engine_destroy(struct TickEngine* engine) {
+    pthread_barrier_destroy(&engine->barrier);
+    for (int i = 0; i < engine->hunterCount; i++) free(engine->hunters[i].path);
+    for (int w = 0; w < engine->workerCount; w++) {
+        struct TickWorker* worker = &engine->workers[w];
+        free(worker->members);
+        free(worker->next);
+        free(worker->pickups.claims);
+        free(worker->arrivals.claims);
+    }
+    for (int m = 0; m < engine->workerCount * engine->workerCount; m++) free(engine->mailboxes[m].claims);
+    free(engine->mailboxes);
+    free(engine->workers);
+    free(engine->hunters);
+}
+
+// FNV-1a over everything the run decided, to compare runs with different worker counts
+static uint64_t engine_fingerprint(const struct TickEngine* engine) {
+    uint64_t hash = 1469598103934665603ull;
+#define MIX(value) do { uint64_t v_ = (uint64_t)(value); for (int b_ = 0; b_ < 8; b_++) { hash = (hash ^ (v_ & 0xFF)) * 1099511628211ull; v_ >>= 8; } } while (0)
+    MIX(engine->tick);
+    MIX(engine->casefile);
+    MIX(engine->solved);
+    MIX(engine->ghost.room);
+    MIX(engine->ghost.boredom);
+    MIX(engine->ghost.ticks);
+    for (int r = 0; r < engine->layout->roomCount; r++) MIX(engine->rooms[r].evidence);
+    for (int i = 0; i < engine->hunterCount; i++) {
+        const struct TickHunter* hunter = &engine->hunters[i];
+        MIX(hunter->room);
+        MIX(hunter->exitReason);
+        MIX(hunter->device);
+        MIX(hunter->fear);
+        MIX(hunter->boredom);
+        MIX(hunter->moves);
+        MIX(hunter->pickups);
+        MIX(hunter->ticks);
+    }
+#undef MIX
+    return hash;
+}
+
+static void engine_collect(const struct TickEngine* engine, double wallSeconds, struct SimResult* result) {
+    memset(result, 0, sizeof(*result));
+    result->seed = engine->seed;
+    result->ghostType = engine->ghost.type;
+    result->collected = engine->casefile;
+    result->solved = engine->solved;
+    result->hunterCount = engine->hunterCount;
+    result->ticks = engine->tick;
+    result->wallSeconds = wallSeconds;
+    for (int i = 0; i < engine->hunterCount; i++) {
+        const struct TickHunter* hunter = &engine->hunters[i];
+        result->exitCounts[hunter->exitReason]++;
+        result->moves += (uint64_t)hunter->moves;
+        result->pickups += (uint64_t)hunter->pickups;
+        if (i < SIM_MAX_OUTCOMES) {
+            result->hunters[i].exitReason = hunter->exitReason;
+            result->hunters[i].fear = (uint32_t)hunter->fear;
+            result->hunters[i].boredom = (uint32_t)hunter->boredom;
+        }
+    }
+}
+
+// Run one investigation on the given worker count; returns the state fingerprint
+static uint64_t tick_run(const struct RoomLayout* layout, const struct SimConfig* config, int workers,
+                         struct SimResult* result, uint64_t* hunterTicks) {
+    static struct TickEngine engine;
+    engine_init(&engine, layout, config, workers);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int w = 1; w < engine.workerCount; w++) {
+        pthread_create(&engine.workers[w].thread, NULL, tickWorkerFunction, &engine.workers[w]);
+    }
+    tickWorkerFunction(&engine.workers[0]);
+    for (int w = 1; w < engine.workerCount; w++) {
+        pthread_join(engine.workers[w].thread, NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double wall = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+
+    engine_collect(&engine, wall, result);
+    *hunterTicks = 0;
+    for (int i = 0; i < engine.hunterCount; i++) *hunterTicks += (uint64_t)engine.hunters[i].ticks;
+    uint64_t fingerprint = engine_fingerprint(&engine);
+    engine_destroy(&engine);
+    return fingerprint;
+}
+
+static void tick_usage(void) {
+    fprintf(stderr,
+            "Usage: huntSimulation --parallel [options]\n"
+            "  --hunters N         hunters (default 10000, at most %d)\n"
+            "  --rooms N           generated house with N rooms, at most %d (default: Willow House)\n"
+            "  --threads N,N,...   worker counts to run the same investigation on (default 1,2,4,... up to the cores)\n"
+            "  --occupancy N       hunters allowed per room (default %d; the van is unlimited)\n"
+            "  --boredom N         boredom limit (default %d)\n"
+            "  --fear N            fear limit (default %d)\n"
+            "  --end-policy P      natural|solved|ghost-exit (default natural)\n"
+            "  --seed S            seed for the layout and every draw (default 1)\n",
+            TICK_MAX_HUNTERS, MAX_ROOMS, MAX_ROOM_OCCUPANCY, ENTITY_BOREDOM_MAX, HUNTER_FEAR_MAX);
+}
+
+int tick_main(int argc, char* argv[]) {
+    struct SimConfig config;
+    simulation_config_default(&config);
+    config.hunterCount = 10000;
+    config.seed = 1;
+
+    int threads[TICK_MAX_STEPS];
+    int steps = 0;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    for (int t = 1; t <= cores && t <= TICK_MAX_THREADS && steps < TICK_MAX_STEPS; t *= 2) threads[steps++] = t;
+
+    for (int i = 1; i < argc; i++) {
+        bool ok = i + 1 < argc;
+        if (ok && strcmp(argv[i], "--hunters") == 0) ok = simulation_parse_positive(argv[++i], &config.hunterCount);
+        else if (ok && strcmp(argv[i], "--rooms") == 0) ok = simulation_parse_positive(argv[++i], &config.roomCount);
+        else if (ok && strcmp(argv[i], "--threads") == 0) {
+            steps = simulation_parse_list(argv[++i], threads, TICK_MAX_STEPS);
+            ok = steps > 0;
+            for (int s = 0; ok && s < steps; s++) ok = threads[s] <= TICK_MAX_THREADS;
+        }
+        else if (ok && strcmp(argv[i], "--occupancy") == 0) ok = simulation_parse_positive(argv[++i], &config.maxOccupancy);
+        else if (ok && strcmp(argv[i], "--boredom") == 0) ok = simulation_parse_positive(argv[++i], &config.boredomMax);
+        else if (ok && strcmp(argv[i], "--fear") == 0) ok = simulation_parse_positive(argv[++i], &config.fearMax);
+        else if (ok && strcmp(argv[i], "--end-policy") == 0) ok = end_policy_from_string(argv[++i], &config.policy);
+        else if (ok && strcmp(argv[i], "--seed") == 0) config.seed = (unsigned)strtoul(argv[++i], NULL, 10);
+        else ok = false;
+
+        if (!ok || config.hunterCount > TICK_MAX_HUNTERS || config.roomCount > MAX_ROOMS) {
+            tick_usage();
+            return 1;
+        }
+    }
+
+    static struct HouseTemplate layout;
+    rand_seed_threadsafe(config.seed);
+    house_template_init(&layout, config.roomCount);
+
+    printf("Parallel tick engine: %s (%d rooms), %d hunters, occupancy %d, seed %u\n",
+           config.roomCount > 0 ? "generated house" : "Willow House", layout.layout.roomCount,
+           config.hunterCount, config.maxOccupancy, config.seed);
+    printf("%8s %8s %12s %10s %8s %8s %8s %10s %16s  %s\n",
+           "threads", "ticks", "moves", "pickups", "evidence", "afraid", "bored", "wall ms", "hunter-ticks/s", "state");
+
+    uint64_t first = 0;
+    bool identical = true;
+    struct SimResult result = {0};
+    for (int s = 0; s < steps; s++) {
+        uint64_t hunterTicks;
+        uint64_t fingerprint = tick_run(&layout.layout, &config, threads[s], &result, &hunterTicks);
+        if (s == 0) first = fingerprint;
+
+        char state[32];
+        if (s == 0) snprintf(state, sizeof(state), "%016llx", (unsigned long long)fingerprint);
+        else snprintf(state, sizeof(state), "%s", fingerprint == first ? "identical" : "DIFFERENT");
+        identical &= fingerprint == first;
+
+        double seconds = result.wallSeconds > 0 ? result.wallSeconds : 1e-9;
+        printf("%8d %8u %12llu %10llu %8d %8d %8d %10.1f %16.0f  %s\n",
+               threads[s], result.ticks, (unsigned long long)result.moves, (unsigned long long)result.pickups,
+               result.exitCounts[LR_EVIDENCE], result.exitCounts[LR_AFRAID], result.exitCounts[LR_BORED],
+               result.wallSeconds * 1000.0, (double)hunterTicks / seconds, state);
+        fflush(stdout);
+    }
+    printf("Ghost: %s, case file %s\n", ghost_to_string(result.ghostType),
+           result.collected == (EvidenceByte)result.ghostType ? "complete" : "incomplete");
+    return identical ? 0 : 1;
+}